@@ -0,0 +1,74 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Bench {
+  using Clock = std::chrono::steady_clock;
+
+  // Runs fn repeatedly for at least minSeconds (and at least minRuns times) and
+  // returns the fastest single run in seconds.
+  template <typename Fn>
+  auto measure(Fn&& fn, const double minSeconds = 0.2, const int minRuns = 3) -> double {
+    double best = 1e30;
+    double total = 0;
+
+    for (int run = 0; run < minRuns || total < minSeconds; run++) {
+      auto start = Clock::now();
+      fn();
+      auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+      best = elapsed < best ? elapsed : best;
+      total += elapsed;
+    }
+
+    return best;
+  }
+
+  inline auto randomBytes(const size_t count, const uint32_t seed) -> std::vector<uint8_t> {
+    std::mt19937_64 rng(seed);
+    std::vector<uint8_t> bytes(count);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      auto value = rng();
+      for (int j = 0; j < 8; j++) bytes[i + j] = static_cast<uint8_t>(value >> (8 * j));
+    }
+    for (; i < count; i++) bytes[i] = static_cast<uint8_t>(rng());
+
+    return bytes;
+  }
+
+  inline auto megabytesPerSecond(const uint64_t bytes, const double seconds) -> double {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds;
+  }
+
+  enum class OutputFormat { Table, Json };
+
+  // One measured case. Throughput is payload bytes per second; ns/bit is per payload bit.
+  struct Result {
+    std::string suite;
+    std::string name;
+    std::string format;
+    size_t threads = 1;
+    uint64_t carrierBytes = 0;
+    uint64_t payloadBytes = 0;
+    double seconds = 0;
+    // The same case on one thread, for the speedup column; 0 when it was not measured.
+    double singleThreadSeconds = 0;
+  };
+
+  // Table rows for people, or one JSON object per line for comparing runs across commits.
+  auto printHeader(OutputFormat output) -> void;
+  auto printResult(const Result& result, OutputFormat output) -> void;
+
+  // Synthetic 24-bit carriers with random pixel data.
+  auto writeBmp(const std::string& path, int width, int height, uint32_t seed) -> void;
+  auto writePpm(const std::string& path, int width, int height, uint32_t seed) -> void;
+
+  auto runParallelScaling(size_t carrierMegabytes, OutputFormat output) -> void;
+  auto runHotPaths(size_t maxCarrierMegabytes, OutputFormat output) -> void;
+}
@@ -0,0 +1,68 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+  constexpr size_t WriteChunkBytes = 4 * 1024 * 1024;
+
+  auto putLittleEndian(std::string& out, const uint32_t value, const int bytes) -> void {
+    for (int i = 0; i < bytes; i++) out += static_cast<char>(value >> (8 * i));
+  }
+
+  // Writes count random bytes in chunks, so very large carriers never sit in memory.
+  auto writeRandom(std::ofstream& out, const uint64_t count, const uint32_t seed) -> void {
+    auto chunk = Bench::randomBytes(static_cast<size_t>(std::min<uint64_t>(count, WriteChunkBytes)), seed);
+    for (uint64_t written = 0; written < count;) {
+      auto n = static_cast<size_t>(std::min<uint64_t>(chunk.size(), count - written));
+      out.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(n));
+      written += n;
+    }
+  }
+
+  auto openOutput(const std::string& path) -> std::ofstream {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      throw std::runtime_error("Cannot create benchmark carrier: " + path);
+    }
+    return out;
+  }
+}
+
+namespace Bench {
+  auto writeBmp(const std::string& path, const int width, const int height, const uint32_t seed) -> void {
+    auto rowBytes = (static_cast<uint64_t>(width) * 3 + 3) & ~uint64_t{3};
+    auto pixelBytes = rowBytes * static_cast<uint64_t>(height);
+
+    std::string header = "BM";
+    putLittleEndian(header, static_cast<uint32_t>(54 + pixelBytes), 4);
+    putLittleEndian(header, 0, 4);
+    putLittleEndian(header, 54, 4);
+    putLittleEndian(header, 40, 4);
+    putLittleEndian(header, static_cast<uint32_t>(width), 4);
+    putLittleEndian(header, static_cast<uint32_t>(height), 4);
+    putLittleEndian(header, 1, 2);
+    putLittleEndian(header, 24, 2);
+    putLittleEndian(header, 0, 4);
+    putLittleEndian(header, static_cast<uint32_t>(pixelBytes), 4);
+    putLittleEndian(header, 2835, 4);
+    putLittleEndian(header, 2835, 4);
+    putLittleEndian(header, 0, 4);
+    putLittleEndian(header, 0, 4);
+
+    auto out = openOutput(path);
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    writeRandom(out, pixelBytes, seed);
+  }
+
+  auto writePpm(const std::string& path, const int width, const int height, const uint32_t seed) -> void {
+    auto header = "P6\n# ImageStegBench\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+
+    auto out = openOutput(path);
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    writeRandom(out, static_cast<uint64_t>(width) * height * 3, seed);
+  }
+}
@@ -0,0 +1,281 @@
+#include "Benchmark.h"
+
+#include "steganography/Utils.h"
+#include "steganography/bmp/BmpSteganographer.h"
+#include "steganography/compress/PayloadFrame.h"
+#include "steganography/crypto/PayloadCipher.h"
+#include "steganography/crypto/Sha256.h"
+#include "steganography/fec/ReedSolomon.h"
+#include "steganography/lsb/Samples.h"
+#include "steganography/ppm/PpmSteganographer.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+
+namespace {
+  // Opens up the protected LSB paths so they can be timed without the public wrappers.
+  template <typename Base>
+  class Exposed : public Base {
+  public:
+    using ISteganographer::decodeLSB;
+    using ISteganographer::encodeLSB;
+    using ISteganographer::encodeLSBInPlace;
+    using ISteganographer::readPayloadHeader;
+  };
+
+  struct CarrierSize {
+    const char* name;
+    int width;
+    int height;
+  };
+
+  constexpr CarrierSize CarrierSizes[] = {
+    {"small", 64, 64},
+    {"medium", 512, 512},
+    {"large", 2048, 2048},
+    {"huge", 8192, 8192},
+  };
+
+  constexpr uint64_t PayloadSizes[] = {16, 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024};
+
+  // The bit-string helpers spend a byte of memory per payload bit, so they stop here.
+  constexpr uint64_t MaxBitStringPayload = 1024 * 1024;
+
+  const std::string Key = "benchmark-key";
+
+  auto randomText(const uint64_t count, const uint32_t seed) -> std::string {
+    auto bytes = Bench::randomBytes(static_cast<size_t>(count), seed);
+    return {bytes.begin(), bytes.end()};
+  }
+
+  // Log-like text, so the compression cases see realistic redundancy rather than noise.
+  auto logText(const uint64_t count, const uint32_t seed) -> std::vector<std::byte> {
+    std::mt19937_64 rng(seed);
+    std::string text;
+    while (text.size() < count) {
+      text += "{\"ts\":" + std::to_string(1700000000 + text.size()) + ",\"level\":\"" + (rng() % 4 ? "info" : "warn") +
+          "\",\"path\":\"/api/v" + std::to_string(rng() % 3) + "/items\",\"ms\":" + std::to_string(rng() % 500) + "}\n";
+    }
+    auto bytes = std::as_bytes(std::span(text.data(), static_cast<size_t>(count)));
+    return {bytes.begin(), bytes.end()};
+  }
+
+  auto runBitStrings(const Bench::OutputFormat output) -> void {
+    for (auto payloadBytes : PayloadSizes) {
+      if (payloadBytes > MaxBitStringPayload) break;
+
+      auto text = randomText(payloadBytes, 3);
+      auto bits = Utils::textToBitString(text);
+
+      Bench::Result result{"hotpaths", "", "-", 1, 0, payloadBytes, 0};
+
+      result.name = "textToBitString";
+      result.seconds = Bench::measure([&] { Utils::textToBitString(text); }, 0.1);
+      Bench::printResult(result, output);
+
+      result.name = "xorString";
+      result.seconds = Bench::measure([&] { Utils::xorString(bits, Key); }, 0.1);
+      Bench::printResult(result, output);
+
+      result.name = "bitStringToText";
+      result.seconds = Bench::measure([&] { Utils::bitStringToText(bits); }, 0.1);
+      Bench::printResult(result, output);
+    }
+  }
+
+  auto runCiphers(const Bench::OutputFormat output) -> void {
+    const Crypto::PayloadCipher repeating(Key);
+    const Crypto::PayloadCipher chacha(Key, Crypto::Salt{});
+
+    for (auto payloadBytes : PayloadSizes) {
+      auto payload = Bench::randomBytes(static_cast<size_t>(payloadBytes), 5);
+      Bench::Result result{"hotpaths", "", "-", 1, 0, payloadBytes, 0};
+
+      result.name = "repeatingKey";
+      result.seconds = Bench::measure([&] { repeating.apply(payload.data(), payload.size(), 0); }, 0.1);
+      Bench::printResult(result, output);
+
+      result.name = "chacha20";
+      result.seconds = Bench::measure([&] { chacha.apply(payload.data(), payload.size(), 0); }, 0.1);
+      Bench::printResult(result, output);
+    }
+
+    // The per-payload key derivation cost that ChaCha20 encodes and decodes pay once.
+    Bench::Result result{"hotpaths", "pbkdf2", "-", 1, 0, Crypto::ChaCha20::KeyBytes, 0};
+    result.seconds = Bench::measure([&] { [[maybe_unused]] Crypto::PayloadCipher cipher(Key, Crypto::Salt{}); }, 0.1);
+    Bench::printResult(result, output);
+  }
+
+  auto runCompression(const Bench::OutputFormat output) -> void {
+    for (auto payloadBytes : PayloadSizes) {
+      auto payload = logText(payloadBytes, 6);
+      auto frame = Compress::compressFrame(payload);
+      Bench::Result result{"hotpaths", "", "-", 1, 0, payloadBytes, 0};
+
+      result.name = "compressFrame";
+      result.seconds = Bench::measure([&] { Compress::compressFrame(payload); }, 0.1);
+      Bench::printResult(result, output);
+
+      result.name = "decompressFrame";
+      result.seconds = Bench::measure([&] {
+        Compress::FrameDecoder decoder;
+        decoder.feed(frame, [](std::span<const std::byte>) {});
+      }, 0.1);
+      Bench::printResult(result, output);
+    }
+  }
+
+  // Reed-Solomon coding at two redundancies: encoding, checking an undamaged payload and
+  // repairing one with a damaged byte in every DamageStride coded bytes, about four per
+  // codeword. The stride is odd, so the damage spreads over every codeword of a group.
+  auto runErrorCorrection(const Bench::OutputFormat output) -> void {
+    constexpr size_t DamageStride = 67;
+
+    for (auto parity : {16, 32}) {
+      for (auto payloadBytes : PayloadSizes) {
+        auto payload = Bench::randomBytes(static_cast<size_t>(payloadBytes), 7);
+        auto coded = Fec::encode(std::as_bytes(std::span(payload)), parity);
+        auto damaged = coded;
+        for (size_t i = 0; i < damaged.size(); i += DamageStride) damaged[i] ^= std::byte{0x5A};
+
+        auto suffix = std::to_string(parity);
+        Bench::Result result{"hotpaths", "", "-", 1, 0, payloadBytes, 0};
+
+        result.name = "rsEncode" + suffix;
+        result.seconds = Bench::measure([&] { Fec::encode(std::as_bytes(std::span(payload)), parity); }, 0.1);
+        Bench::printResult(result, output);
+
+        result.name = "rsCheck" + suffix;
+        result.seconds = Bench::measure([&] {
+          Fec::Decoder decoder(coded.size(), parity);
+          decoder.feed(coded, [](std::span<const std::byte>) {});
+        }, 0.1);
+        Bench::printResult(result, output);
+
+        result.name = "rsRepair" + suffix;
+        result.seconds = Bench::measure([&] {
+          Fec::Decoder decoder(damaged.size(), parity);
+          decoder.feed(damaged, [](std::span<const std::byte>) {});
+        }, 0.1);
+        Bench::printResult(result, output);
+      }
+    }
+  }
+
+  // Plain PPM rasters: decimal text to samples and back. Payload bytes count samples.
+  auto runPlainSamples(const Bench::OutputFormat output) -> void {
+    for (auto sampleCount : PayloadSizes) {
+      auto random = Bench::randomBytes(static_cast<size_t>(sampleCount), 7);
+      std::vector<uint16_t> samples(random.begin(), random.end());
+      std::string text;
+      Lsb::appendDecimalSamples(samples, text);
+
+      Bench::Result result{"hotpaths", "", "ppm", 1, 0, sampleCount, 0};
+
+      result.name = "parseDecimalSamples";
+      result.seconds = Bench::measure([&] { Lsb::parseDecimalSamples(text, samples); }, 0.1);
+      Bench::printResult(result, output);
+
+      result.name = "appendDecimalSamples";
+      result.seconds = Bench::measure([&] {
+        std::string out;
+        Lsb::appendDecimalSamples(samples, out);
+      }, 0.1);
+      Bench::printResult(result, output);
+    }
+  }
+
+  template <typename Steganographer>
+  auto runCarrier(const std::string& path, const char* format, const uint64_t carrierBytes,
+      const Bench::OutputFormat output) -> void {
+    Exposed<Steganographer> steganographer;
+
+    for (auto payloadBytes : PayloadSizes) {
+      auto payload = Bench::randomBytes(static_cast<size_t>(payloadBytes), 4);
+      auto bytes = std::as_bytes(std::span(payload));
+      auto text = std::string(reinterpret_cast<const char*>(payload.data()), payload.size());
+
+      auto image = steganographer.open(path, File::Mode::ReadWrite);
+      if (!steganographer.canEncode(image, payloadBytes, EncodeOptions{})) break;
+
+      Bench::Result result{"hotpaths", "", format, 1, carrierBytes, payloadBytes, 0};
+
+      // Flushing is left to the OS so the LSB cases time the embedding, not the disk, and
+      // the repeating key keeps key derivation out of them; the ciphers are timed above.
+      EncodeOptions rewrite{WriteMode::Rewrite, FlushPolicy::None, 1, Crypto::Cipher::RepeatingKey};
+      result.name = "encodeLSB";
+      result.seconds = Bench::measure([&] { steganographer.encodeLSB(image, bytes, Key, rewrite); }, 0.1);
+      Bench::printResult(result, output);
+
+      EncodeOptions inPlace{WriteMode::InPlace, FlushPolicy::None, 1, Crypto::Cipher::RepeatingKey};
+      result.name = "encodeLSBInPlace";
+      result.seconds = Bench::measure([&] { steganographer.encodeLSBInPlace(image, bytes, Key, inPlace); }, 0.1);
+      Bench::printResult(result, output);
+
+      std::vector<std::byte> decoded(payload.size());
+      result.name = "decodeLSB";
+      result.seconds = Bench::measure([&] {
+        CarrierSource carrier(image, image.getLayout(), Key, false);
+        steganographer.decodeLSB(carrier, steganographer.readPayloadHeader(carrier), Crypto::PayloadCipher(Key), 0,
+            decoded, ParallelOptions{});
+      }, 0.1);
+      Bench::printResult(result, output);
+
+      EncodeOptions scattered = inPlace;
+      scattered.scatter = true;
+      result.name = "encodeLSBInPlace/scatter";
+      result.seconds = Bench::measure([&] { steganographer.encodeLSBInPlace(image, bytes, Key, scattered); }, 0.1);
+      Bench::printResult(result, output);
+
+      result.name = "decodeLSB/scatter";
+      result.seconds = Bench::measure([&] {
+        CarrierSource carrier(image, image.getLayout(), Key, true);
+        steganographer.decodeLSB(carrier, steganographer.readPayloadHeader(carrier), Crypto::PayloadCipher(Key), 0,
+            decoded, ParallelOptions{});
+      }, 0.1);
+      Bench::printResult(result, output);
+
+      result.name = "encode";
+      result.seconds = Bench::measure([&] { steganographer.encode(path, text, Key); }, 0.1);
+      Bench::printResult(result, output);
+
+      result.name = "decode";
+      result.seconds = Bench::measure([&] { steganographer.decode(path, Key); }, 0.1);
+      Bench::printResult(result, output);
+    }
+  }
+}
+
+namespace Bench {
+  // Bit-string helpers, the LSB paths on an open image and full path-based
+  // encode/decode, over synthetic BMP and PPM carriers of growing size.
+  auto runHotPaths(const size_t maxCarrierMegabytes, const OutputFormat output) -> void {
+    auto directory = std::filesystem::temp_directory_path() / "imagesteg-bench";
+    std::filesystem::create_directories(directory);
+
+    runBitStrings(output);
+    runCiphers(output);
+    runCompression(output);
+    runErrorCorrection(output);
+    runPlainSamples(output);
+
+    for (const auto& size : CarrierSizes) {
+      auto carrierBytes = static_cast<uint64_t>(size.width) * size.height * 3;
+      if (carrierBytes > maxCarrierMegabytes * 1024 * 1024) break;
+
+      auto bmp = (directory / (std::string(size.name) + ".bmp")).string();
+      writeBmp(bmp, size.width, size.height, 5);
+      runCarrier<BmpSteganographer>(bmp, "bmp", carrierBytes, output);
+      std::filesystem::remove(bmp);
+
+      auto ppm = (directory / (std::string(size.name) + ".ppm")).string();
+      writePpm(ppm, size.width, size.height, 6);
+      runCarrier<PpmSteganographer>(ppm, "ppm", carrierBytes, output);
+      std::filesystem::remove(ppm);
+    }
+
+    std::filesystem::remove(directory);
+  }
+}
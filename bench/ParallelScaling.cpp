@@ -0,0 +1,45 @@
+#include "Benchmark.h"
+
+#include "steganography/concurrency/ThreadPool.h"
+#include "steganography/crypto/PayloadCipher.h"
+#include "steganography/lsb/LsbEngine.h"
+
+namespace Bench {
+  // Embed/extract throughput of one large carrier as the thread cap grows, with the
+  // speedup over the one-thread run of the same case.
+  auto runParallelScaling(const size_t carrierMegabytes, const OutputFormat output) -> void {
+    auto carrier = randomBytes(carrierMegabytes * 1024 * 1024, 1);
+    auto payload = randomBytes(carrier.size() / Lsb::CarrierBytesPerByte, 2);
+    std::vector<uint8_t> extracted(payload.size());
+    const Crypto::PayloadCipher cipher("benchmark-key", Crypto::Salt{});
+
+    auto hardware = ThreadPool::defaultThreadCount();
+    std::vector<size_t> threadCounts;
+    for (size_t t = 1; t < hardware; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(hardware);
+
+    // threadCounts starts at one thread, so each case has its reference before it is needed.
+    double embedSingleThread = 0;
+    double extractSingleThread = 0;
+    for (auto threads : threadCounts) {
+      ParallelOptions options{threads, 0};
+      Result result{"scaling", "", "-", threads, carrier.size(), payload.size(), 0};
+
+      result.name = "embedWithKey";
+      result.seconds = measure([&] {
+        Lsb::embedWithKey(carrier.data(), payload.data(), payload.size(), cipher, options);
+      });
+      if (threads == 1) embedSingleThread = result.seconds;
+      result.singleThreadSeconds = embedSingleThread;
+      printResult(result, output);
+
+      result.name = "extractWithKey";
+      result.seconds = measure([&] {
+        Lsb::extractWithKey(carrier.data(), extracted.data(), extracted.size(), cipher, options);
+      });
+      if (threads == 1) extractSingleThread = result.seconds;
+      result.singleThreadSeconds = extractSingleThread;
+      printResult(result, output);
+    }
+  }
+}
@@ -0,0 +1,35 @@
+#include "Benchmark.h"
+
+#include "steganography/lsb/LsbEngine.h"
+
+#include <fmt/core.h>
+
+namespace Bench {
+  auto printHeader(const OutputFormat output) -> void {
+    if (output == OutputFormat::Json) return;
+
+    fmt::println("kernel {}", Lsb::getKernelName(Lsb::activeKernel()));
+    fmt::println("{:<12} {:<24} {:<6} {:>7} {:>14} {:>12} {:>12} {:>10} {:>8}", "suite", "case", "format", "threads",
+        "carrier bytes", "payload", "MB/s", "ns/bit", "speedup");
+  }
+
+  auto printResult(const Result& result, const OutputFormat output) -> void {
+    auto mbPerSecond = megabytesPerSecond(result.payloadBytes, result.seconds);
+    auto nsPerBit = result.seconds * 1e9 / (static_cast<double>(result.payloadBytes) * 8);
+    auto speedup = result.singleThreadSeconds > 0 ? result.singleThreadSeconds / result.seconds : 0.0;
+
+    if (output == OutputFormat::Json) {
+      fmt::println("{{\"suite\":\"{}\",\"case\":\"{}\",\"format\":\"{}\",\"kernel\":\"{}\",\"threads\":{},"
+          "\"carrier_bytes\":{},\"payload_bytes\":{},\"seconds\":{:.9f},\"mb_per_s\":{:.3f},\"ns_per_bit\":{:.4f},"
+          "\"speedup\":{}}}",
+          result.suite, result.name, result.format, Lsb::getKernelName(Lsb::activeKernel()), result.threads,
+          result.carrierBytes, result.payloadBytes, result.seconds, mbPerSecond, nsPerBit,
+          speedup > 0 ? fmt::format("{:.3f}", speedup) : "null");
+      return;
+    }
+
+    fmt::println("{:<12} {:<24} {:<6} {:>7} {:>14} {:>12} {:>12.1f} {:>10.3f} {:>8}", result.suite, result.name,
+        result.format, result.threads, result.carrierBytes, result.payloadBytes, mbPerSecond, nsPerBit,
+        speedup > 0 ? fmt::format("{:.2f}x", speedup) : "-");
+  }
+}
@@ -0,0 +1,53 @@
+#include "Benchmark.h"
+
+#include <fmt/core.h>
+#include <string>
+
+namespace {
+  auto printUsage() -> void {
+    fmt::println(stderr, "Usage: ImageStegBench [--suite=all|hotpaths|scaling] [--carrier-mb=N] "
+                         "[--max-carrier-mb=N] [--json]");
+    fmt::println(stderr, "  --carrier-mb      carrier size of the scaling suite (default 64)");
+    fmt::println(stderr, "  --max-carrier-mb  largest synthetic image of the hotpaths suite (default 64, up to 192)");
+    fmt::println(stderr, "  --json            one JSON object per result line instead of a table");
+  }
+}
+
+int main(int argc, char* argv[]) {
+    size_t carrierMegabytes = 64;
+    size_t maxCarrierMegabytes = 64;
+    std::string suite = "all";
+    auto output = Bench::OutputFormat::Table;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.starts_with("--carrier-mb=")) {
+            carrierMegabytes = std::stoul(arg.substr(13));
+        } else if (arg.starts_with("--max-carrier-mb=")) {
+            maxCarrierMegabytes = std::stoul(arg.substr(17));
+        } else if (arg.starts_with("--suite=")) {
+            suite = arg.substr(8);
+        } else if (arg == "--json") {
+            output = Bench::OutputFormat::Json;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (suite != "all" && suite != "hotpaths" && suite != "scaling") {
+        printUsage();
+        return 2;
+    }
+
+    Bench::printHeader(output);
+
+    if (suite == "all" || suite == "hotpaths") {
+        Bench::runHotPaths(maxCarrierMegabytes, output);
+    }
+    if (suite == "all" || suite == "scaling") {
+        Bench::runParallelScaling(carrierMegabytes, output);
+    }
+
+    return 0;
+}
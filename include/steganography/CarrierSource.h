@@ -0,0 +1,37 @@
+#pragma once
+#include "ImageHandle.h"
+#include "io/MappedFile.h"
+#include "lsb/Scatter.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// The logical carrier stream decode reads from: the carrier bytes that follow the pixel
+// data offset in order, or in scatter mode the bytes a keyed permutation picks from the
+// whole pixel data. Scattered bytes are gathered from a read-only mapping rather than read
+// one call at a time. Plain rasters, and in scatter mode carrier bytes that are not
+// contiguous (see CarrierGeometry.h), are gathered once up front. layout says where the
+// carrier bytes are: the image's own, or the flat one legacy payloads use.
+class CarrierSource {
+public:
+  CarrierSource(const ImageHandle& image, const ImageLayout& layout, const std::string& key, bool scatter);
+
+  // Logical carrier bytes available.
+  [[nodiscard]] auto size() const -> uint64_t;
+  // Copies logical carrier bytes [position, position + count) to out; the range must lie
+  // within size() and, in scatter mode, position must start a group.
+  auto read(uint64_t position, uint8_t* out, size_t count) const -> void;
+
+private:
+  const ImageHandle& image;
+  ImageLayout layout;
+  std::optional<Lsb::ScatterPermutation> permutation;
+  std::unique_ptr<MappedFile> mapping;
+  std::vector<uint8_t> decoded;
+  // The carrier bytes in memory, when they are not read from the file.
+  const uint8_t* carrier = nullptr;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include "concurrency/ParallelOptions.h"
+#include "crypto/PayloadCipher.h"
+#include "io/MappedFile.h"
+
+enum class WriteMode {
+  InPlace,  // map the file and modify only the payload bytes
+  Rewrite   // read the whole image, embed in memory and write it back
+};
+
+struct EncodeOptions {
+  WriteMode writeMode = WriteMode::InPlace;
+  FlushPolicy flushPolicy = FlushPolicy::Async;
+  // Payload bits stored per carrier byte (1-4). Recorded in the header, so decode
+  // picks the matching kernel on its own.
+  int bitsPerChannel = 1;
+  // Payload cipher, recorded in the header. Payloads encoded without a key always use the
+  // repeating key, since there is nothing to derive a ChaCha20 key from.
+  Crypto::Cipher cipher = Crypto::Cipher::ChaCha20;
+  // Spread the header and payload over the whole pixel data in a key-dependent order
+  // instead of filling the leading carrier bytes. Not recorded in the image: decoding
+  // needs DecodeOptions::scatter and the same key. Needs a seekable image, not a stream.
+  bool scatter = false;
+  // LZ4-compress the payload before ciphering and embedding. Recorded in the header;
+  // decode decompresses on its own.
+  bool compress = false;
+  // Reed-Solomon parity bytes per 255-byte codeword, an even number from 2 to 128, or 0
+  // for no error correction. Recorded in the header; decode repairs up to parity / 2
+  // damaged bytes per codeword on its own, and the header is stored three times over.
+  int fecParity = 0;
+  // Hamming matrix embedding: matrixBits (2-7) payload bits per block of 2^matrixBits - 1
+  // carrier bytes, changing at most one of them, or 0 for plain LSB. Needs
+  // bitsPerChannel 1 and is recorded in the header.
+  int matrixBits = 0;
+  // How far this call may spread embedding over the shared pool.
+  ParallelOptions parallel = {};
+};
+
+struct DecodeOptions {
+  // Read a payload embedded with EncodeOptions::scatter.
+  bool scatter = false;
+  // How far this call may spread extraction over the shared pool.
+  ParallelOptions parallel = {};
+};
@@ -1,18 +1,115 @@
 #pragma once
+#include "CarrierSource.h"
+#include "EncodeOptions.h"
+#include "ImageHandle.h"
+#include "concurrency/ParallelOptions.h"
+#include "crypto/PayloadCipher.h"
+#include "io/File.h"
+#include "lsb/PayloadHeader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
+// Receives decoded payload bytes in order, a bounded piece at a time.
+using PayloadSink = std::function<void(std::span<const std::byte>)>;
+
 class ISteganographer {
 public:
   virtual ~ISteganographer() = default;
 
-  virtual bool encode(const std::string& filepath, const std::string& message, const std::string& key) = 0;
-  virtual std::string decode(const std::string& filepath, const std::string& key) = 0;
-  virtual bool canEncode(const std::string& filepath, const std::string& message) = 0;
-  virtual auto getImageDimensions(const std::string& filepath) -> std::pair<int, int> = 0;
+  // Opens the image and parses its header once. Use File::Mode::ReadWrite for encoding.
+  auto open(const std::string& filepath, File::Mode mode = File::Mode::Read) const -> ImageHandle;
+
+  // Payloads are raw bytes; embedded NULs and non-text data round-trip unchanged.
+  virtual auto encode(ImageHandle& image, std::span<const std::byte> payload, const std::string& key, const EncodeOptions& options) -> bool;
+  // payloadBytes counts the bytes actually stored, which with options.compress is the
+  // compressed frame and with options.fecParity is coded; the overload taking the
+  // payload compresses it to find out.
+  virtual auto canEncode(const ImageHandle& image, uint64_t payloadBytes, const EncodeOptions& options) const -> bool;
+  auto canEncode(const ImageHandle& image, std::span<const std::byte> payload, const EncodeOptions& options) const -> bool;
+  // Stored bytes that always fit in the image with options, counted before error
+  // correction coding.
+  [[nodiscard]] auto capacity(const ImageHandle& image, const EncodeOptions& options) const -> uint64_t;
+
+  // Size of the decoded payload. The key matters in scatter mode and for compressed
+  // payloads, whose original size is stored enciphered.
+  [[nodiscard]] auto decodedSize(const ImageHandle& image, const std::string& key = "", const DecodeOptions& options = {}) const -> uint64_t;
+  // Decodes into out, which must hold at least decodedSize() bytes. Returns the payload size.
+  virtual auto decode(const ImageHandle& image, const std::string& key, std::span<std::byte> out, const DecodeOptions& options = {}) -> uint64_t;
+  // Decodes through a fixed-size window, so memory use does not grow with the payload.
+  // Compressed payloads are decompressed block by block on the way to the sink.
+  auto decode(const ImageHandle& image, const std::string& key, const PayloadSink& sink, const DecodeOptions& options = {}) -> uint64_t;
+
+  auto encode(ImageHandle& image, const std::string& message, const std::string& key, const EncodeOptions& options) -> bool;
+  auto decode(const ImageHandle& image, const std::string& key, const DecodeOptions& options = {}) -> std::string;
+  auto canEncode(const ImageHandle& image, const std::string& message, const EncodeOptions& options) const -> bool;
+  [[nodiscard]] auto getImageDimensions(const ImageHandle& image) const -> std::pair<int, int>;
+
+  // Streaming variants for pipes and carriers too large to keep around: the image is read
+  // from in once, front to back, in fixed-size blocks, and encodeStream writes it to out
+  // with the payload embedded. Memory use does not depend on the image size.
+  auto encodeStream(std::istream& in, std::ostream& out, std::span<const std::byte> payload, const std::string& key, const EncodeOptions& options) const -> bool;
+  auto decodeStream(std::istream& in, const std::string& key, const PayloadSink& sink) const -> uint64_t;
+
+  // Building blocks for callers that schedule their own reads and writes (see
+  // cli/EncodePipeline.h); binary images only. They take the stored payload, which
+  // storedPayload() makes: the payload itself, or with options.compress its compressed
+  // frame and with options.fecParity the Reed-Solomon coding of that, kept in frame.
+  static auto storedPayload(std::span<const std::byte> payload, const EncodeOptions& options, std::vector<std::byte>& frame) -> std::span<const std::byte>;
+  // Bytes of pixel data, from layout.pixelDataOffset on, that embedding storedBytes reads
+  // and rewrites. Throws if the payload does not fit.
+  auto pixelBytesFor(const ImageHandle& image, uint64_t storedBytes, const std::string& key, const EncodeOptions& options) const -> uint64_t;
+  // Embeds stored into pixels, which holds the first pixelBytesFor() bytes of the image's pixel data.
+  auto embedPixels(const ImageHandle& image, uint8_t* pixels, std::span<const std::byte> stored, const std::string& key, const EncodeOptions& options) const -> void;
+
+  // Path based shortcuts that open the image for a single call.
+  auto encode(const std::string& filepath, const std::string& message, const std::string& key, const EncodeOptions& options) -> bool;
+  auto encode(const std::string& filepath, const std::string& message, const std::string& key) -> bool;
+  auto decode(const std::string& filepath, const std::string& key, const DecodeOptions& options = {}) -> std::string;
+  auto canEncode(const std::string& filepath, const std::string& message, const EncodeOptions& options) const -> bool;
+  auto canEncode(const std::string& filepath, const std::string& message) const -> bool;
+  auto getImageDimensions(const std::string& filepath) const -> std::pair<int, int>;
 
 protected:
-  auto encodeLSB(std::vector<char>& buffer, size_t pixelDataOffset, const std::string& message, const std::string& key, const std::string& filepath) -> bool;
-  auto decodeLSB(const std::vector<char>& buffer, size_t pixelDataOffset, const std::string& key) -> std::string;
-  auto canEncodeWithDimensions(int width, int height, const std::string& message) -> bool;
-};
\ No newline at end of file
+  // Parses the layout from the first bytes of a fileSize byte file. Returns nullopt when
+  // head is too short to decide, in which case open() retries with a longer head.
+  // Throws if the header is invalid.
+  virtual auto parseLayout(std::span<const uint8_t> head, uint64_t fileSize) const -> std::optional<ImageLayout> = 0;
+
+  // These embed payload as given; encode() has already compressed it when options.compress is set.
+  auto encodeLSB(ImageHandle& image, std::span<const std::byte> payload, const std::string& key, const EncodeOptions& options) -> bool;
+  auto encodeLSBInPlace(ImageHandle& image, std::span<const std::byte> payload, const std::string& key, const EncodeOptions& options) -> bool;
+  // Plain (ASCII) rasters: parses the samples, embeds in their low bytes and rewrites the
+  // raster as text. Both write modes end up here, since the text can change length.
+  auto encodeAscii(ImageHandle& image, std::span<const std::byte> payload, const std::string& key, const EncodeOptions& options) -> bool;
+
+  // Embeds into carrier, the carrierBytes of pixel data, at the positions the keyed
+  // permutation picks. Runs in parallel chunks of the logical carrier stream.
+  auto embedScattered(uint8_t* carrier, uint64_t carrierBytes, const Lsb::PayloadHeader& header, std::span<const std::byte> payload, const std::string& key, const Crypto::PayloadCipher& cipher, const ParallelOptions& parallel) const -> void;
+
+  // The carrier the payload in image was embedded through, with its header in header:
+  // the image's own layout, or for a legacy header the flat one it was written in (see
+  // flatLayout()). Throws if the image holds no valid payload.
+  auto openCarrier(const ImageHandle& image, const std::string& key, bool scatter, Lsb::PayloadHeader& header) const -> CarrierSource;
+  // Reads and validates the payload header; throws if the image holds no valid payload.
+  auto readPayloadHeader(const CarrierSource& carrier) const -> Lsb::PayloadHeader;
+  // Decodes payload bytes [begin, begin + out.size()) into out. begin must start a group
+  // of header.density().
+  auto decodeLSB(const CarrierSource& carrier, const Lsb::PayloadHeader& header, const Crypto::PayloadCipher& cipher, uint64_t begin, std::span<std::byte> out, const ParallelOptions& parallel) const -> void;
+  // Decodes the whole payload to sink through a bounded window, correcting and
+  // decompressing it if the header says so. Returns the decoded size.
+  auto decodePayload(const CarrierSource& carrier, const Lsb::PayloadHeader& header, const Crypto::PayloadCipher& cipher, const PayloadSink& sink, const ParallelOptions& parallel) const -> uint64_t;
+  // The decoded size: the stored payload size before error correction coding, or the
+  // original size of a compressed payload.
+  auto decodedSize(const CarrierSource& carrier, const Lsb::PayloadHeader& header, const Crypto::PayloadCipher& cipher) const -> uint64_t;
+
+  // Grows head through read(), which appends count bytes and returns how many it got,
+  // until parseLayout() can decide. fileSize may be unknown (UINT64_MAX) for streams.
+  auto parseHead(std::vector<uint8_t>& head, uint64_t fileSize, const std::string& name, const std::function<size_t(uint8_t*, size_t)>& read) const -> ImageLayout;
+};
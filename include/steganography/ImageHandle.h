@@ -0,0 +1,64 @@
+#pragma once
+#include "Utils.h"
+#include "io/File.h"
+#include "lsb/CarrierGeometry.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// How channel samples are stored after the pixel data offset.
+enum class SampleEncoding { Binary, Ascii };
+
+// Everything encode/decode/canEncode need to know about an image, parsed once from its header.
+struct ImageLayout {
+  Utils::ImageFormat format = Utils::ImageFormat::NOT_SUPPORTED;
+  int width = 0;
+  int height = 0;
+  // Bits per pixel as the format stores them; plain PPM counts like its binary form.
+  int bitsPerPixel = 0;
+  uint64_t pixelDataOffset = 0;
+  // Which bytes from pixelDataOffset on are carrier bytes.
+  Lsb::CarrierGeometry geometry;
+  // Carrier bytes available for embedding, exactly as many as the pixel data holds.
+  uint64_t carrierBytes = 0;
+  // Where the first releases started their flat carrier (see flatLayout()). Their PPM
+  // parser counted four lines, which without a comment line ends one line into the
+  // raster; 0 when that line does not end within the parsed head.
+  uint64_t legacyDataOffset = 0;
+  int maxValue = 255;
+  // ASCII samples are decimal text, so embedding changes their length and encode has to
+  // rewrite the raster.
+  SampleEncoding encoding = SampleEncoding::Binary;
+};
+
+// The layout the first releases embedded through, and legacy (version 0) headers still
+// do: every byte from offset to the end of the pixel data, or of a fileSize byte file, is
+// a carrier byte, row padding, alpha and high sample bytes included.
+auto flatLayout(const ImageLayout& layout, uint64_t offset, uint64_t fileSize) -> ImageLayout;
+// The flat layouts a legacy payload may sit in besides the image's own, in the order to
+// try them: from the pixel data unless that is the geometry already, then from the first
+// releases' PPM offset. Plain rasters have none.
+auto legacyLayouts(const ImageLayout& layout, uint64_t fileSize) -> std::vector<ImageLayout>;
+
+// An open image file together with its parsed layout. Created by ISteganographer::open,
+// which does all the file system work up front, so later calls reuse the handle
+// instead of reopening and reparsing the file.
+class ImageHandle {
+public:
+  ImageHandle(File file, const ImageLayout& layout, uint64_t fileSize);
+
+  [[nodiscard]] auto getFile() -> File&;
+  [[nodiscard]] auto getFile() const -> const File&;
+  [[nodiscard]] auto getLayout() const -> const ImageLayout&;
+  [[nodiscard]] auto getPath() const -> const std::string&;
+  [[nodiscard]] auto getFileSize() const -> uint64_t;
+  [[nodiscard]] auto isWritable() const -> bool;
+  // Records the new length after an encode rewrote the file with a different size.
+  auto setFileSize(uint64_t size) -> void;
+
+private:
+  File file;
+  ImageLayout layout;
+  uint64_t fileSize = 0;
+};
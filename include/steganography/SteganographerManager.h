@@ -4,13 +4,16 @@
 #include "Utils.h"
 
 #include <map>
+#include <mutex>
 
 class SteganographerManager {
 public:
   SteganographerManager();
 
+  // Thread-safe; the returned steganographers are shared by all callers.
   auto getSteganographer(Utils::ImageFormat format) -> ISteganographer*;
 
 private:
+  std::mutex mutex;
   std::map<Utils::ImageFormat, ISteganographer*> steganographers;
 };
\ No newline at end of file
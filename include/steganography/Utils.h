@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace Utils {
   enum class ImageFormat { BMP, PPM, NOT_SUPPORTED };
@@ -11,7 +12,19 @@ namespace Utils {
 
   auto getImageInfo(const std::string& filePath, const std::pair<int, int>& dimensions) -> std::string;
 
-  auto hasWritePermission(const std::string& filepath) -> bool;
+  // A path that could not be read, and why.
+  struct PathFailure {
+    std::string path;
+    std::string reason;
+  };
+
+  // The supported images among paths, directories walked recursively, sorted and without
+  // duplicates. Other paths are kept whatever their extension; directories that cannot
+  // be walked end up in failures.
+  auto collectImages(const std::vector<std::string>& paths, std::vector<PathFailure>& failures) -> std::vector<std::string>;
+
+  // text with the characters JSON strings cannot hold as they are escaped.
+  auto jsonEscape(const std::string& text) -> std::string;
 
   auto textToBitString(const std::string& message) -> std::string;
   auto bitStringToText(const std::string& bitString) -> std::string;
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// CRC-32C (Castagnoli), the checksum of iSCSI and ext4. Uses the SSE4.2 CRC32 instruction
+// where it is compiled in (e.g. with IMAGESTEG_ENABLE_AVX2) or the ARMv8 CRC32C ones, and
+// slicing-by-8 tables otherwise.
+namespace Checksum {
+  // The CRC-32C of data following bytes whose CRC-32C is crc (0 for none), so a checksum
+  // can be extended piece by piece.
+  auto crc32c(const uint8_t* data, size_t count, uint32_t crc = 0) -> uint32_t;
+  auto crc32c(std::span<const std::byte> data, uint32_t crc = 0) -> uint32_t;
+}
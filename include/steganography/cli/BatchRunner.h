@@ -0,0 +1,50 @@
+#pragma once
+
+#include "steganography/SteganographerManager.h"
+#include "steganography/cli/CommandParser.h"
+#include "steganography/cli/CommandRunner.h"
+#include "steganography/cli/EncodePipeline.h"
+#include "steganography/concurrency/ThreadPool.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+// Runs many commands on a work-stealing pool and reports per-job status plus
+// aggregate throughput.
+class BatchRunner {
+public:
+  explicit BatchRunner(size_t threadCount = 0);
+
+  // Entry point for "--batch <manifest>" and "--batch-dir <dir> <payload-map>", either
+  // optionally followed by --stats for one JSON line per job; returns the process exit code.
+  // --batch-dir also takes --pipeline[=auto|uring|threads], --queue-depth=N and --buffers=N
+  // to encode through an EncodePipeline instead of one command per image.
+  auto run(std::vector<std::string> args) -> int;
+
+  // One shell command per line; blank lines and lines starting with '#' are skipped.
+  auto runManifest(const std::string& manifestPath) -> int;
+  // Encrypts every supported image in directory that has a "<image> <message> [key]"
+  // line in the payload map. Image names are relative to directory.
+  auto runDirectory(const std::string& directory, const std::string& payloadMapPath) -> int;
+
+  static auto isBatchFlag(const std::string& flag) -> bool;
+
+private:
+  struct Job {
+    std::string label;
+    Command command;
+  };
+
+  auto runJobs(const std::vector<Job>& jobs) -> int;
+  // Runs encodes through an EncodePipeline; failed jobs were rejected while reading the map.
+  auto runPipeline(const std::vector<EncodePipeline::Job>& encodes, const std::vector<std::string>& labels,
+      const std::vector<Job>& failed) -> int;
+
+  CommandParser commandParser;
+  SteganographerManager steganographerManager;
+  CommandRunner commandRunner;
+  ThreadPool pool;
+  bool collectStats = false;
+  std::optional<PipelineOptions> pipeline;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "CommandType.h"
+#include <map>
 #include <string>
 #include <vector>
 
@@ -7,4 +8,6 @@ struct Command {
   CommandType type = CommandType::Unknown;
   std::vector<std::string> args;
   std::string error;
+  // "--name=value" options, keyed by "--name".
+  std::map<std::string, std::string> options;
 };
@@ -11,16 +11,28 @@ namespace CommandErrors {
     return "Unknown flag or command: " + flag;
   }
 
+  inline auto InvalidOption(const std::string& option, const std::string& value, const std::string& expected) -> std::string {
+    return "Invalid value for " + option + ": '" + value + "'. Expected " + expected + ".";
+  }
+
   inline auto ArgError(const CommandType cmd, size_t givenCount) -> std::string {
     switch (cmd) {
     case CommandType::Encrypt:
-      return "Encrypt expects 2 or 3 arguments: <image> <message> <secret key>. Got " + std::to_string(givenCount) + ".";
+      return "Encrypt expects 2 or 3 arguments: <image> <message> <secret key> [--bits=1-4] [--cipher=chacha20|xor] [--scatter] [--compress] [--fec=2-128] [--matrix=2-7] [--out=file]. Got " + std::to_string(givenCount) + ".";
     case CommandType::Decrypt:
-      return "Decrypt expects 1 or 2 arguments: <image> <secret key>. Got " + std::to_string(givenCount) + ".";
+      return "Decrypt expects 1 or 2 arguments: <image> <secret key> [--scatter] [--out=file]. Got " + std::to_string(givenCount) + ".";
     case CommandType::Info:
       return "Info expects exactly 1 argument: <image>. Got " + std::to_string(givenCount) + ".";
     case CommandType::Check:
-      return "Check expects exactly 2 argument: <image> <message>. Got " + std::to_string(givenCount) + ".";
+      return "Check expects exactly 2 argument: <image> <message> [--bits=1-4] [--cipher=chacha20|xor] [--scatter] [--compress] [--fec=2-128] [--matrix=2-7]. Got " + std::to_string(givenCount) + ".";
+    case CommandType::Shard:
+      return "Shard expects at least 3 arguments: <message> <secret key> <image> [image...] [--bits=1-4] [--cipher=chacha20|xor] [--scatter] [--compress] [--fec=2-128] [--matrix=2-7]. Got " + std::to_string(givenCount) + ".";
+    case CommandType::Unshard:
+      return "Unshard expects at least 2 arguments: <secret key> <image> [image...] [--scatter] [--out=file]. Got " + std::to_string(givenCount) + ".";
+    case CommandType::Scan:
+      return "Scan expects at least 1 argument: <image|directory> [more...]. Got " + std::to_string(givenCount) + ".";
+    case CommandType::Inventory:
+      return "Inventory expects at least 1 argument: <image|directory> [more...] [--bits=1-4] [--cipher=chacha20|xor] [--scatter] [--fec=2-128] [--matrix=2-7] [--out=file]. Got " + std::to_string(givenCount) + ".";
     case CommandType::Help:
       return "Help takes no arguments.";
     default:
@@ -3,8 +3,14 @@
 #include "Command.h"
 
 #include <string>
+#include <vector>
 
 class CommandParser {
 public:
   [[nodiscard]] auto parse(const std::string& input) const -> Command;
+  // Parses already-split tokens, e.g. argv from a one-shot invocation.
+  [[nodiscard]] auto parse(std::vector<std::string> tokens) const -> Command;
+
+  // Splits a line into tokens, honouring double-quoted arguments.
+  static auto tokenize(const std::string& input) -> std::vector<std::string>;
 };
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Command.h"
+#include "steganography/SteganographerManager.h"
+#include "steganography/stats/Stats.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct CommandResult {
+  bool success = true;
+  // Text shown to the user: the command output, or the error message on failure.
+  std::string output;
+  uint64_t payloadBytes = 0;
+  // Phase timings and counters, set when the command was run with --stats.
+  std::shared_ptr<Stats::Collector> stats = nullptr;
+};
+
+// Executes parsed commands without touching the console, so the interactive shell,
+// one-shot invocations and batch jobs share the same behaviour. Safe to call from
+// several threads at once.
+class CommandRunner {
+public:
+  explicit CommandRunner(SteganographerManager& steganographerManager);
+
+  auto run(const Command& command) const -> CommandResult;
+
+  static auto helpText() -> std::string;
+
+private:
+  auto execute(const Command& command) const -> CommandResult;
+  auto executeEncrypt(const Command& command) const -> CommandResult;
+  // Encrypt with --out: the image is read once as a stream and written to out.
+  auto encryptStream(ISteganographer& steganographer, const Command& command, const std::string& out, const EncodeOptions& options) const -> CommandResult;
+  auto executeDecrypt(const Command& command) const -> CommandResult;
+  auto executeInfo(const Command& command) const -> CommandResult;
+  auto executeCheck(const Command& command) const -> CommandResult;
+  auto executeShard(const Command& command) const -> CommandResult;
+  auto executeUnshard(const Command& command) const -> CommandResult;
+  auto executeScan(const Command& command) const -> CommandResult;
+  auto executeInventory(const Command& command) const -> CommandResult;
+
+  SteganographerManager& steganographerManager;
+};
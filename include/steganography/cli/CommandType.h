@@ -5,6 +5,10 @@ enum class CommandType {
   Decrypt,
   Info,
   Check,
+  Shard,
+  Unshard,
+  Scan,
+  Inventory,
   Help,
   Unknown
 };
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "steganography/cli/DaemonProtocol.h"
+#include "steganography/io/UnixSocket.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Thin client for DaemonServer: forwards commands instead of running them, so callers
+// pay for a socket round trip rather than a process start.
+class DaemonClient {
+public:
+  // Entry point for "--client <socket> [command...]". With a command it runs just that
+  // one, printing like the one-shot CLI; without, it reads one command per line from
+  // stdin and pipelines them all. Returns the process exit code.
+  auto run(const std::vector<std::string>& args) -> int;
+
+  static auto isClientFlag(const std::string& flag) -> bool;
+
+private:
+  auto runOne(const UnixSocket& socket, const std::vector<std::string>& tokens) -> int;
+  // Sends every command in input without waiting for replies, while a second thread
+  // prints the replies as they arrive, one "[ok] line N: ..." line each.
+  auto runPipelined(const UnixSocket& socket, std::istream& input) -> int;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include "steganography/io/UnixSocket.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Wire format between the daemon and its clients. Every message is a frame: the 32-bit
+// body length and the 32-bit request id, both little-endian, then the body.
+//  Request body  - the command's argv-style tokens, each terminated by a NUL byte.
+//  Response body - a flags byte (bit 0: success), the 64-bit payload byte count, the
+//                  32-bit length of the output text, the output text, and the stats JSON
+//                  (see Stats::toJson) filling the rest; empty unless --stats was given.
+// A client may send any number of requests before reading a response, but has to keep
+// reading responses meanwhile, since the server stops taking requests while it cannot
+// write. Responses carry the id of their request and arrive in the order the requests
+// finish, not the order they were sent.
+namespace Daemon {
+  constexpr size_t FrameHeaderBytes = 8;
+  // Requests name their images and payloads by path, so frames stay small; anything
+  // larger is a corrupt or hostile length.
+  constexpr uint32_t MaxBodyBytes = 16 * 1024 * 1024;
+
+  struct Request {
+    uint32_t id = 0;
+    std::vector<std::string> tokens;
+  };
+
+  struct Response {
+    uint32_t id = 0;
+    bool success = false;
+    uint64_t payloadBytes = 0;
+    std::string output;
+    std::string stats;
+  };
+
+  // Append one frame to out.
+  auto appendRequest(const Request& request, std::vector<char>& out) -> void;
+  auto appendResponse(const Response& response, std::vector<char>& out) -> void;
+
+  // Read one frame through buffer, which is reused between calls. Return nullopt at a
+  // clean end of stream; throw if the frame is malformed.
+  auto readRequest(const UnixSocket& socket, std::vector<char>& buffer) -> std::optional<Request>;
+  auto readResponse(const UnixSocket& socket, std::vector<char>& buffer) -> std::optional<Response>;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "steganography/SteganographerManager.h"
+#include "steganography/cli/CommandParser.h"
+#include "steganography/cli/CommandRunner.h"
+#include "steganography/cli/DaemonProtocol.h"
+#include "steganography/concurrency/ThreadPool.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Long-running server for clients that send many small jobs: commands arrive over a Unix
+// domain socket (see DaemonProtocol.h) and run on one work-stealing pool that shares a
+// warm SteganographerManager. Each connection gets a reader thread, so a client can
+// pipeline requests while earlier ones are still running. Requests start in the order
+// they arrive (see ThreadPool.h).
+class DaemonServer {
+public:
+  explicit DaemonServer(size_t threadCount = 0);
+
+  // Entry point for "--daemon <socket>"; returns the process exit code.
+  auto run(const std::vector<std::string>& args) -> int;
+  // Serves on socketPath until the process is stopped. Throws if it cannot listen.
+  auto serve(const std::string& socketPath) -> void;
+
+  static auto isDaemonFlag(const std::string& flag) -> bool;
+
+private:
+  struct Connection;
+
+  auto handleConnection(const std::shared_ptr<Connection>& connection) -> void;
+  auto execute(const Daemon::Request& request) const -> Daemon::Response;
+
+  CommandParser commandParser;
+  SteganographerManager steganographerManager;
+  CommandRunner commandRunner;
+  ThreadPool pool;
+};
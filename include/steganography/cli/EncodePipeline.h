@@ -0,0 +1,56 @@
+#pragma once
+
+#include "steganography/SteganographerManager.h"
+#include "steganography/cli/CommandRunner.h"
+#include "steganography/concurrency/ThreadPool.h"
+#include "steganography/io/AsyncIo.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct PipelineOptions {
+  AsyncIoOptions io;
+  // Images in flight at once, each holding one buffer from the read of its pixel data
+  // until its write has completed.
+  size_t bufferCount = 8;
+  bool collectStats = false;
+};
+
+// Encodes many images with their I/O overlapped: while one image is being embedded on
+// the pool, the pixel data of the next ones is being read and that of earlier ones
+// written back, all through AsyncIo. Each image moves through
+//   prepare (pool: open, parse the header, load and compress the payload)
+//   -> read (async: just the pixel bytes the payload touches)
+//   -> embed (pool) -> write (async: the same bytes) -> sync (async, FlushPolicy::Sync only)
+// and releases its buffer to the next image when done. Plain (ASCII) images, which
+// change length when encoded, fall back to a regular encode in the prepare step.
+class EncodePipeline {
+public:
+  struct Job {
+    std::string image;
+    // A message argument as the CLI takes it; see PayloadSource.
+    std::string message;
+    std::string key;
+  };
+
+  // Receives each job's result and the wall time it took from prepare to the last write.
+  using Report = std::function<void(size_t job, const CommandResult& result, double milliseconds)>;
+
+  EncodePipeline(SteganographerManager& steganographerManager, ThreadPool& pool, const PipelineOptions& options);
+
+  // Encodes every job, calling report once per job, from this thread, as each one finishes.
+  auto run(const std::vector<Job>& jobs, const Report& report) -> void;
+
+  // The I/O backend in use: "io_uring" or "threads".
+  [[nodiscard]] auto backendName() const -> std::string;
+
+private:
+  struct Slot;
+
+  SteganographerManager& steganographerManager;
+  ThreadPool& pool;
+  PipelineOptions options;
+  std::unique_ptr<AsyncIo> io;
+};
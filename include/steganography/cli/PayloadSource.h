@@ -0,0 +1,32 @@
+#pragma once
+#include "steganography/io/File.h"
+#include "steganography/io/MappedFile.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// The payload named by a message argument: "@path" maps the file read-only, "@-" reads
+// stdin, "@@text" is the literal "@text" and anything else is the message itself.
+// Payload bytes are used where they are, without copying into a std::string, so the
+// argument of a literal message must outlive the source.
+class PayloadSource {
+public:
+  explicit PayloadSource(const std::string& argument);
+
+  PayloadSource(const PayloadSource&) = delete;
+  auto operator=(const PayloadSource&) -> PayloadSource& = delete;
+
+  [[nodiscard]] auto bytes() const -> std::span<const std::byte>;
+
+private:
+  auto readStdin() -> void;
+
+  std::optional<File> file;
+  std::unique_ptr<MappedFile> mapping;
+  std::vector<std::byte> buffer;
+  std::span<const std::byte> payload;
+};
@@ -2,25 +2,25 @@
 
 #include "steganography/SteganographerManager.h"
 #include "steganography/cli/CommandParser.h"
+#include "steganography/cli/CommandRunner.h"
 
 #include <string>
+#include <vector>
 
 class Shell {
   public:
     Shell();
 
     auto run() -> void;
+    // Runs a single command given as argv-style tokens; returns the process exit code.
+    auto runOnce(const std::vector<std::string>& tokens) -> int;
 
   private:
     auto printPrompt() const -> void;
-    auto handleCommand(const Command& command) -> void;
-    auto executeEncrypt(const std::vector<std::string>& tokens) -> void;
-    auto executeDecrypt(const std::vector<std::string>& tokens) -> void;
-    auto executeInfo(const std::vector<std::string>& tokens) -> void;
-    auto executeCheck(const std::vector<std::string>& tokens) -> void;
-    auto executeHelp() const -> void;
+    auto handleCommand(const Command& command) -> bool;
 
     CommandParser commandParser;
     SteganographerManager steganographerManager;
+    CommandRunner commandRunner;
 };
 
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Built-in LZ4 block format codec: greedy single-probe matching, tuned for speed rather
+// than ratio, with no dependency on liblz4. Blocks are independent; framing is left to
+// the caller (see PayloadFrame.h).
+namespace Lz4 {
+  // Largest compressed size of count input bytes.
+  auto compressBound(size_t count) -> size_t;
+
+  // Compresses count bytes of src into dst, which must hold compressBound(count) bytes.
+  // Returns the compressed size.
+  auto compressBlock(const uint8_t* src, size_t count, uint8_t* dst) -> size_t;
+
+  // Decompresses the count byte block at src into dst, which must be exactly rawBytes long.
+  // Throws if the block is malformed or does not decode to exactly rawBytes.
+  auto decompressBlock(const uint8_t* src, size_t count, uint8_t* dst, size_t rawBytes) -> void;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Framing for compressed payloads: the 8-byte little-endian raw size, then the payload in
+// independent blocks of FrameBlockBytes raw bytes (the last one shorter). Each block is a
+// 4-byte little-endian word, whose low 31 bits give the stored size and whose top bit
+// marks a block kept as is because it did not compress, followed by the stored bytes.
+// Independent blocks keep decode memory at one block whatever the payload size.
+namespace Compress {
+  constexpr size_t FrameBlockBytes = 64 * 1024;
+  constexpr size_t FrameHeaderBytes = 8;
+
+  auto compressFrame(std::span<const std::byte> payload) -> std::vector<std::byte>;
+
+  // Incremental decoder: feed() the frame in pieces of any size and the raw payload comes
+  // out through emit, a block at a time.
+  class FrameDecoder {
+  public:
+    using Emit = std::function<void(std::span<const std::byte>)>;
+
+    auto feed(std::span<const std::byte> data, const Emit& emit) -> void;
+    // Throws unless the whole frame has been fed.
+    auto finish() const -> void;
+
+    // The raw size, once the frame header has been fed.
+    [[nodiscard]] auto rawSize() const -> std::optional<uint64_t>;
+    // The raw size from the first FrameHeaderBytes of a frame.
+    static auto readRawSize(std::span<const std::byte, FrameHeaderBytes> header) -> uint64_t;
+
+  private:
+    // Bytes pending must reach before the next header or block can be decoded.
+    [[nodiscard]] auto wanted() const -> size_t;
+    auto decodeBlock(const Emit& emit) -> void;
+
+    std::vector<std::byte> pending;
+    std::vector<std::byte> block;
+    std::optional<uint64_t> raw;
+    uint64_t emitted = 0;
+  };
+}
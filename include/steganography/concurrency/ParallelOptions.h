@@ -0,0 +1,10 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+struct ParallelOptions {
+  // Upper bound on threads working on one image, including the caller; 0 uses every hardware thread.
+  size_t threadCount = 0;
+  // Images whose touched carrier range is smaller than this stay on the calling thread.
+  uint64_t thresholdBytes = 4 * 1024 * 1024;
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool: every worker owns a deque, pops its own newest task and
+// steals the oldest task of another worker when it runs dry. Tasks submitted from
+// a worker go to that worker's deque; external submissions go to a shared queue that
+// workers take from oldest first once their own deque is empty, so they start in the
+// order they were submitted.
+class ThreadPool {
+public:
+  // threadCount == 0 uses one worker per hardware thread.
+  explicit ThreadPool(size_t threadCount = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+
+  // Tasks must not throw; catch inside the task and record the failure instead.
+  auto submit(std::function<void()> task) -> void;
+
+  // Runs queued tasks on the calling thread until every submitted task has finished.
+  auto waitIdle() -> void;
+
+  // Calls body(i) for every i in [0, count) on at most maxWorkers threads, the caller
+  // included (0 = pool size + 1). Indices are handed out dynamically. Returns when all
+  // calls finished and rethrows the first exception thrown by body. Safe to call from
+  // inside a pool task: the caller works through the indices itself, so it never
+  // waits on queued helpers.
+  auto parallelFor(size_t count, size_t maxWorkers, const std::function<void(size_t)>& body) -> void;
+
+  [[nodiscard]] auto size() const -> size_t;
+
+  // Process-wide pool used for intra-image parallelism.
+  static auto shared() -> ThreadPool&;
+
+  static auto defaultThreadCount() -> size_t;
+
+private:
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  auto workerLoop(size_t index) -> void;
+  auto tryRunOne(size_t home) -> bool;
+  auto takeTask(size_t home, std::function<void()>& task) -> bool;
+
+  std::vector<std::unique_ptr<WorkQueue>> queues;
+  WorkQueue injected;
+  std::vector<std::thread> workers;
+
+  std::atomic<size_t> queued{0};
+  std::atomic<size_t> unfinished{0};
+
+  std::mutex stateMutex;
+  std::condition_variable workAvailable;
+  std::condition_variable allDone;
+  bool stopping = false;
+};
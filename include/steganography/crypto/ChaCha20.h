@@ -0,0 +1,29 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// ChaCha20 stream cipher in its original form: 64-bit block counter and 64-bit nonce,
+// so a single key covers any payload size. Any keystream position can be reached
+// directly through the block counter, which lets ranges be processed independently.
+// Full blocks are generated several at a time with SSE2 or AVX2 where available.
+namespace Crypto {
+  class ChaCha20 {
+  public:
+    static constexpr size_t KeyBytes = 32;
+    static constexpr size_t BlockBytes = 64;
+
+    explicit ChaCha20(std::span<const uint8_t, KeyBytes> key, uint64_t nonce = 0);
+
+    // XORs data with keystream bytes [offset, offset + count).
+    auto apply(uint8_t* data, size_t count, uint64_t offset) const -> void;
+
+    // Writes keystream block counter to out.
+    auto block(uint64_t counter, uint8_t* out) const -> void;
+
+  private:
+    // Constants, key and nonce; the counter words are filled in per block.
+    std::array<uint32_t, 16> input = {};
+  };
+}
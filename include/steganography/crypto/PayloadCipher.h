@@ -0,0 +1,49 @@
+#pragma once
+#include "ChaCha20.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+// The keystream XORed onto payload bytes, addressed by payload offset so any range of a
+// payload can be ciphered on its own.
+//  RepeatingKey - the classic scheme: byte i is XORed with key[i % key.size()].
+//  ChaCha20     - ChaCha20 keyed by PBKDF2-HMAC-SHA-256 over the passphrase and a random
+//                 per-image salt stored in the payload header.
+namespace Crypto {
+  enum class Cipher : uint8_t { RepeatingKey, ChaCha20 };
+
+  constexpr size_t SaltBytes = 16;
+  constexpr uint32_t KdfIterations = 100000;
+  using Salt = std::array<uint8_t, SaltBytes>;
+
+  // A fresh salt from the system's random device.
+  auto randomSalt() -> Salt;
+
+  class PayloadCipher {
+  public:
+    // The repeating-key cipher; an empty key leaves payloads unchanged.
+    explicit PayloadCipher(std::string key);
+    // ChaCha20 with the key derived from passphrase and salt. The derivation is
+    // deliberately slow, so build one cipher per payload and share it across threads.
+    PayloadCipher(const std::string& passphrase, const Salt& salt);
+
+    // XORs data, which holds payload bytes [offset, offset + count), with the keystream.
+    auto apply(uint8_t* data, size_t count, uint64_t offset) const -> void;
+    // True if apply() never changes anything.
+    [[nodiscard]] auto isIdentity() const -> bool;
+    [[nodiscard]] auto getCipher() const -> Cipher;
+    // 32 bits of an HMAC keyed with the cipher key, stored in versioned headers so a wrong
+    // key fails before any payload is read. For ChaCha20 it comes from the derived key,
+    // so checking a guess still costs the whole key derivation.
+    [[nodiscard]] auto keyCheck() const -> uint32_t;
+
+  private:
+    std::string key;
+    std::optional<ChaCha20> chacha;
+    uint32_t check = 0;
+  };
+}
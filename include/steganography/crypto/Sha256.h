@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Self-contained SHA-256 (FIPS 180-4) with HMAC and PBKDF2 on top, enough to derive
+// cipher keys from a passphrase without any external library.
+namespace Crypto {
+  class Sha256 {
+  public:
+    static constexpr size_t DigestBytes = 32;
+    static constexpr size_t BlockBytes = 64;
+    using Digest = std::array<uint8_t, DigestBytes>;
+
+    Sha256();
+
+    auto update(std::span<const uint8_t> data) -> void;
+    // Pads and returns the digest; the object must not be updated afterwards.
+    auto finish() -> Digest;
+
+    static auto hash(std::span<const uint8_t> data) -> Digest;
+
+  private:
+    auto compress(const uint8_t* block) -> void;
+
+    std::array<uint32_t, 8> state;
+    std::array<uint8_t, BlockBytes> buffer = {};
+    size_t buffered = 0;
+    uint64_t totalBytes = 0;
+  };
+
+  auto hmacSha256(std::span<const uint8_t> key, std::span<const uint8_t> message) -> Sha256::Digest;
+
+  // PBKDF2 with HMAC-SHA-256 (RFC 8018); fills out with derived key material.
+  auto pbkdf2Sha256(std::span<const uint8_t> password, std::span<const uint8_t> salt, uint32_t iterations,
+      std::span<uint8_t> out) -> void;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Reed-Solomon error correction over GF(2^8) for embedded payloads. Each codeword holds up
+// to 255 - parity data bytes followed by parity bytes, and corrects any parity / 2 wrong
+// bytes among them; a flipped carrier bit spoils exactly one byte.
+//
+// Codewords are interleaved in groups of InterleaveCodewords, so a run of damaged carrier
+// bytes is spread over a whole group. A group of d data bytes uses m = ceil(d / k)
+// codewords (k = 255 - parity) and is stored as the d data bytes unchanged, then parity
+// rows of m bytes: byte i of the data belongs to codeword i % m, and parity row r holds
+// byte r of every codeword's parity. Every group is full (InterleaveCodewords * k data
+// bytes) but the last. Codewords whose last data row is short count the missing byte as
+// a known 0. Decoding an undamaged payload only checks the syndromes.
+//
+// Encoding and the syndrome checks run the codewords of a group in lockstep, one 16-byte
+// row at a time, through per-constant product tables: split by nibble for PSHUFB where
+// SSSE3 is available (e.g. with IMAGESTEG_ENABLE_AVX2), one 256-byte table otherwise.
+namespace Fec {
+  constexpr size_t CodewordBytes = 255;
+  constexpr size_t InterleaveCodewords = 16;
+  constexpr int MinParity = 2;
+  constexpr int MaxParity = 128;
+
+  // Parity bytes per codeword: an even number from MinParity to MaxParity.
+  auto isValidParity(int parity) -> bool;
+
+  // Coded size of dataBytes of payload; dataBytes itself when parity is 0.
+  auto codedBytes(uint64_t dataBytes, int parity) -> uint64_t;
+  // The payload size codedBytes came from; nullopt if no payload codes to that size.
+  auto dataBytes(uint64_t codedBytes, int parity) -> std::optional<uint64_t>;
+  // The largest payload whose coded size is at most codedBytes.
+  auto maxDataBytes(uint64_t codedBytes, int parity) -> uint64_t;
+
+  auto encode(std::span<const std::byte> data, int parity) -> std::vector<std::byte>;
+  // Calls visit with each run of data bytes in coded, the output of encode(), in order;
+  // together they are the data it was encoded from.
+  auto forEachData(std::span<const std::byte> coded, int parity,
+      const std::function<void(std::span<const std::byte>)>& visit) -> void;
+
+  // Incremental decoder: feed() the coded bytes in pieces of any size and the corrected
+  // payload comes out through emit, a group at a time. Throws once a codeword is found to
+  // have more errors than it can correct; past parity / 2 errors a codeword can also
+  // decode to the wrong data, so callers check what comes out against a checksum (the
+  // payload header's CRC-32C, see forEachData()).
+  class Decoder {
+  public:
+    using Emit = std::function<void(std::span<const std::byte>)>;
+
+    Decoder(uint64_t codedBytes, int parity);
+
+    auto feed(std::span<const std::byte> data, const Emit& emit) -> void;
+    // Throws unless every coded byte has been fed.
+    auto finish() const -> void;
+
+    // Coded bytes, data and parity, corrected so far.
+    [[nodiscard]] auto corrected() const -> uint64_t;
+
+  private:
+    auto decodeGroup(const Emit& emit) -> void;
+
+    int parity;
+    uint64_t remaining;
+    std::vector<std::byte> group;
+    size_t groupBytes = 0;
+    uint64_t correctedBytes = 0;
+  };
+}
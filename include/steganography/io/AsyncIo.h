@@ -0,0 +1,147 @@
+#pragma once
+#include "File.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class AsyncIoBackend {
+  Auto,     // io_uring where the kernel allows it, threads otherwise
+  IoUring,  // Linux only; creating it throws elsewhere or when the kernel refuses
+  Threads   // blocking positioned I/O on a few helper threads; works everywhere
+};
+
+struct AsyncIoOptions {
+  AsyncIoBackend backend = AsyncIoBackend::Auto;
+  // Operations in flight at once: the io_uring submission queue size, or the number of
+  // helper threads (capped at MaxIoThreads) for the thread backend.
+  size_t queueDepth = 32;
+};
+
+// Positioned file reads, writes and syncs that run in the background and report back
+// through wait(). Every operation carries a caller-chosen tag; a read or write completes
+// only once all its bytes have been transferred, or with an error. Submitting is safe
+// from any thread; wait() must only be called from one thread at a time.
+class AsyncIo {
+public:
+  struct Completion {
+    uint64_t tag = 0;
+    // Bytes transferred; reads come up short only at end of file.
+    size_t bytes = 0;
+    // Empty on success.
+    std::string error = {};
+  };
+
+  static constexpr size_t MaxIoThreads = 16;
+
+  virtual ~AsyncIo() = default;
+
+  static auto create(const AsyncIoOptions& options) -> std::unique_ptr<AsyncIo>;
+
+  // The files and buffers must stay valid until the operation has completed.
+  virtual auto read(const File& file, uint64_t offset, void* buffer, size_t count, uint64_t tag) -> void = 0;
+  virtual auto write(File& file, uint64_t offset, const void* buffer, size_t count, uint64_t tag) -> void = 0;
+  virtual auto sync(const File& file, uint64_t tag) -> void = 0;
+  // Completes tag without any I/O, e.g. to wake the waiting thread from another one.
+  virtual auto notify(uint64_t tag) -> void = 0;
+
+  // Blocks until at least one operation has completed and appends every completion
+  // available by then to out.
+  virtual auto wait(std::vector<Completion>& out) -> void = 0;
+
+  [[nodiscard]] virtual auto name() const -> std::string = 0;
+};
+
+// The portable backend: operations queue up for a pool of threads that run them with
+// File::readAt and friends.
+class ThreadIo final : public AsyncIo {
+public:
+  explicit ThreadIo(size_t threadCount);
+  ~ThreadIo() override;
+
+  auto read(const File& file, uint64_t offset, void* buffer, size_t count, uint64_t tag) -> void override;
+  auto write(File& file, uint64_t offset, const void* buffer, size_t count, uint64_t tag) -> void override;
+  auto sync(const File& file, uint64_t tag) -> void override;
+  auto notify(uint64_t tag) -> void override;
+  auto wait(std::vector<Completion>& out) -> void override;
+  [[nodiscard]] auto name() const -> std::string override;
+
+private:
+  auto submit(std::function<Completion()> operation) -> void;
+  auto complete(Completion completion) -> void;
+  auto workerLoop() -> void;
+
+  std::mutex mutex;
+  std::condition_variable pending;
+  std::condition_variable completed;
+  std::deque<std::function<Completion()>> operations;
+  std::vector<Completion> completions;
+  bool stopping = false;
+  std::vector<std::thread> workers;
+};
+
+#ifdef __linux__
+// The io_uring backend, driven through the raw system calls so there is no dependency
+// on liburing. Short transfers are resubmitted for the remainder.
+class UringIo final : public AsyncIo {
+public:
+  // Throws if the kernel has no io_uring or does not allow it.
+  explicit UringIo(size_t queueDepth);
+  ~UringIo() override;
+
+  UringIo(const UringIo&) = delete;
+  auto operator=(const UringIo&) -> UringIo& = delete;
+
+  auto read(const File& file, uint64_t offset, void* buffer, size_t count, uint64_t tag) -> void override;
+  auto write(File& file, uint64_t offset, const void* buffer, size_t count, uint64_t tag) -> void override;
+  auto sync(const File& file, uint64_t tag) -> void override;
+  auto notify(uint64_t tag) -> void override;
+  auto wait(std::vector<Completion>& out) -> void override;
+  [[nodiscard]] auto name() const -> std::string override;
+
+private:
+  struct Operation;
+
+  auto submit(std::unique_ptr<Operation> operation) -> void;
+  // Hands the next transfer of operation to the kernel, or parks it in backlog while
+  // entries operations are already in flight. The caller holds submitMutex.
+  auto push(Operation* operation) -> void;
+  // Reaps the completion queue into out, resubmitting short transfers.
+  auto reap(std::vector<Completion>& out) -> void;
+  // Unmaps the rings and closes the ring descriptor.
+  auto release() -> void;
+
+  int ring = -1;
+  unsigned entries = 0;
+
+  void* sqRing = nullptr;
+  size_t sqRingBytes = 0;
+  void* cqRing = nullptr;
+  size_t cqRingBytes = 0;
+  void* sqes = nullptr;
+  size_t sqesBytes = 0;
+
+  unsigned* sqHead = nullptr;
+  unsigned* sqTail = nullptr;
+  unsigned sqMask = 0;
+  unsigned* sqArray = nullptr;
+  unsigned* cqHead = nullptr;
+  unsigned* cqTail = nullptr;
+  unsigned cqMask = 0;
+  void* cqes = nullptr;
+
+  // Submissions come from any thread; only the waiting thread reaps completions.
+  std::mutex submitMutex;
+  // Operations handed to the kernel and not yet reaped. Capping them at the submission
+  // queue size keeps the completion queue, twice as large, from overflowing.
+  size_t inFlight = 0;
+  std::deque<Operation*> backlog;
+};
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Thin RAII wrapper over a native file handle (POSIX fd or Win32 HANDLE).
+class File {
+public:
+  enum class Mode { Read, ReadWrite };
+
+#ifdef _WIN32
+  using NativeHandle = void*;
+  static constexpr NativeHandle InvalidHandle = nullptr;
+#else
+  using NativeHandle = int;
+  static constexpr NativeHandle InvalidHandle = -1;
+#endif
+
+  File() = default;
+  File(const std::string& filepath, Mode mode);
+  ~File();
+
+  File(const File&) = delete;
+  auto operator=(const File&) -> File& = delete;
+  File(File&& other) noexcept;
+  auto operator=(File&& other) noexcept -> File&;
+
+  [[nodiscard]] auto isOpen() const -> bool;
+  [[nodiscard]] auto size() const -> uint64_t;
+  [[nodiscard]] auto nativeHandle() const -> NativeHandle;
+  [[nodiscard]] auto getPath() const -> const std::string&;
+  [[nodiscard]] auto isWritable() const -> bool;
+
+  // Positioned read that does not move any file pointer; returns fewer than count
+  // bytes only at end of file.
+  auto readAt(uint64_t offset, void* buffer, size_t count) const -> size_t;
+  // Like readAt, but throws unless all count bytes were read.
+  auto readExactAt(uint64_t offset, void* buffer, size_t count) const -> void;
+
+  // Positioned write; throws unless all count bytes were written.
+  auto writeAt(uint64_t offset, const void* buffer, size_t count) -> void;
+
+  // Truncates or extends the file to size bytes.
+  auto resize(uint64_t size) -> void;
+
+  // Flushes file data and metadata to stable storage.
+  auto sync() const -> void;
+  auto close() -> void;
+
+private:
+  std::string path;
+  Mode mode = Mode::Read;
+  NativeHandle handle = InvalidHandle;
+};
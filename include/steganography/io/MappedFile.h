@@ -0,0 +1,42 @@
+#pragma once
+#include "File.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// How dirty pages of a writable mapping reach the disk.
+//  None  - left to the OS page cache; the file is consistent for other readers immediately.
+//  Async - writeback of the dirty range is scheduled before returning.
+//  Sync  - the dirty range (and file metadata) is on stable storage before returning.
+enum class FlushPolicy { None, Async, Sync };
+
+// Maps [offset, offset + length) of an open file; the range must lie within the file.
+// The mapping is writable only if the file was opened for writing.
+// The mapping is aligned down to the allocation granularity internally; data() points
+// at the requested offset.
+class MappedFile {
+public:
+  MappedFile(const File& file, uint64_t offset, size_t length);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+  [[nodiscard]] auto data() -> uint8_t*;
+  [[nodiscard]] auto data() const -> const uint8_t*;
+  [[nodiscard]] auto size() const -> size_t;
+
+  // Flushes [offset, offset + length) of the mapped range according to policy.
+  auto flush(FlushPolicy policy, size_t offset, size_t length) -> void;
+  auto flush(FlushPolicy policy) -> void;
+
+private:
+  const File& file;
+  void* base = nullptr;
+  size_t baseLength = 0;
+  size_t delta = 0;
+  size_t length = 0;
+#ifdef _WIN32
+  void* mapping = nullptr;
+#endif
+};
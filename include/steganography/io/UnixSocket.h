@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Thin RAII wrapper over a stream socket in the AF_UNIX family, which Windows 10 and
+// later support through Winsock as well.
+class UnixSocket {
+public:
+#ifdef _WIN32
+  using NativeHandle = uintptr_t;
+  static constexpr NativeHandle InvalidHandle = ~NativeHandle{0};
+#else
+  using NativeHandle = int;
+  static constexpr NativeHandle InvalidHandle = -1;
+#endif
+
+  UnixSocket() = default;
+  ~UnixSocket();
+
+  UnixSocket(const UnixSocket&) = delete;
+  auto operator=(const UnixSocket&) -> UnixSocket& = delete;
+  UnixSocket(UnixSocket&& other) noexcept;
+  auto operator=(UnixSocket&& other) noexcept -> UnixSocket&;
+
+  // Binds and listens on path. A socket file left behind by a server that no longer
+  // answers is replaced; one that still answers makes this throw.
+  static auto listen(const std::string& path) -> UnixSocket;
+  static auto connect(const std::string& path) -> UnixSocket;
+
+  // Waits for the next client. Throws once the listening socket has been shut down.
+  auto accept() const -> UnixSocket;
+
+  // Reads up to count bytes; returns 0 at end of stream.
+  auto readSome(void* buffer, size_t count) const -> size_t;
+  // Reads exactly count bytes. Returns false on a clean end of stream before the first
+  // byte and throws if the stream ends part way.
+  auto readExact(void* buffer, size_t count) const -> bool;
+  // Throws unless all count bytes were written.
+  auto writeAll(const void* buffer, size_t count) const -> void;
+
+  // Ends the sending direction, so the peer reads end of stream once it has the rest.
+  auto shutdownWrite() const -> void;
+
+  [[nodiscard]] auto isOpen() const -> bool;
+  auto close() -> void;
+
+private:
+  explicit UnixSocket(NativeHandle handle);
+
+  NativeHandle handle = InvalidHandle;
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Where the carrier bytes sit in an image's pixel data. The data is rows of rowStride
+// bytes, each starting with width pixels of pixelBytes bytes; every pixel holds channels
+// carrier bytes, channelStride apart from its byte firstChannel on. Row padding, alpha
+// and the high bytes of 16-bit samples are never part of the carrier. Carrier bytes are
+// numbered in file order, row by row.
+namespace Lsb {
+  struct CarrierGeometry {
+    uint64_t width = 0;
+    uint64_t rowStride = 0;
+    int pixelBytes = 3;
+    int channels = 3;
+    int channelStride = 1;
+    int firstChannel = 0;
+
+    [[nodiscard]] auto rowCarrierBytes() const -> uint64_t;
+    // Whether carrier byte i is simply pixel data byte i, so no gathering is needed.
+    [[nodiscard]] auto isContiguous() const -> bool;
+    // Pixel data bytes, from the start of the first row, up to and including the last of
+    // carrier bytes [0, count).
+    [[nodiscard]] auto spanBytes(uint64_t count) const -> uint64_t;
+    // Offset of the row that holds carrier byte index.
+    [[nodiscard]] auto rowOffset(uint64_t index) const -> uint64_t;
+    // Carrier bytes wholly inside the first dataBytes bytes of pixel data.
+    [[nodiscard]] auto carrierBytesWithin(uint64_t dataBytes) const -> uint64_t;
+  };
+
+  // Copies carrier bytes [first, first + count) to out. pixels starts at the row that
+  // holds carrier byte first. Rows are walked with kernels specialised on the pixel
+  // shape, so only row and pixel boundaries branch, never single bytes.
+  auto loadCarrier(const uint8_t* pixels, const CarrierGeometry& geometry, uint64_t first, uint8_t* out, size_t count) -> void;
+  // Stores count bytes from in as the carrier bytes loadCarrier() would read.
+  auto storeCarrier(uint8_t* pixels, const CarrierGeometry& geometry, uint64_t first, const uint8_t* in, size_t count) -> void;
+}
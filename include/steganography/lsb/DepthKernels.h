@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Embed/extract kernels specialised on the number of bits stored per carrier byte.
+// A group of Bits payload bytes (8 * Bits bits) always fills exactly 8 carrier bytes,
+// so every depth runs the same fully unrolled shape with compile-time shifts and masks.
+// Bits are consumed most significant first; within a carrier byte the first bit lands
+// in the highest of its Bits low bits, so depth 1 matches the classic layout.
+namespace Lsb {
+  template <int Bits>
+  struct DepthKernel {
+    static_assert(Bits >= 1 && Bits <= 4, "1 to 4 bits per channel are supported");
+
+    static constexpr uint8_t Mask = (1u << Bits) - 1;
+    static constexpr int GroupPayloadBytes = Bits;
+    static constexpr int GroupCarrierBytes = 8;
+
+    static auto embedGroup(uint8_t* carrier, const uint8_t* payload) -> void {
+      uint64_t value = loadGroup(payload, std::make_index_sequence<Bits>{});
+      embedValue(carrier, value, std::make_index_sequence<GroupCarrierBytes>{});
+    }
+
+    static auto extractGroup(const uint8_t* carrier, uint8_t* payload) -> void {
+      uint64_t value = extractValue(carrier, std::make_index_sequence<GroupCarrierBytes>{});
+      storeGroup(payload, value, std::make_index_sequence<Bits>{});
+    }
+
+    static auto embed(uint8_t* carrier, const uint8_t* payload, const size_t count) -> void {
+      size_t groups = count / Bits;
+      for (size_t g = 0; g < groups; g++) {
+        embedGroup(carrier + g * GroupCarrierBytes, payload + g * Bits);
+      }
+
+      auto tail = count % Bits;
+      if (tail != 0) {
+        // The last partial group is padded with zero bits; only the carrier bytes that
+        // hold real payload bits are written.
+        uint8_t padded[Bits] = {};
+        for (size_t i = 0; i < tail; i++) padded[i] = payload[groups * Bits + i];
+
+        uint64_t value = loadGroup(padded, std::make_index_sequence<Bits>{});
+        auto* c = carrier + groups * GroupCarrierBytes;
+        for (size_t j = 0; j < (tail * 8 + Bits - 1) / Bits; j++) {
+          c[j] = static_cast<uint8_t>((c[j] & ~Mask) | ((value >> (8 * Bits - Bits * (j + 1))) & Mask));
+        }
+      }
+    }
+
+    static auto extract(const uint8_t* carrier, uint8_t* payload, const size_t count) -> void {
+      size_t groups = count / Bits;
+      for (size_t g = 0; g < groups; g++) {
+        extractGroup(carrier + g * GroupCarrierBytes, payload + g * Bits);
+      }
+
+      auto tail = count % Bits;
+      if (tail != 0) {
+        uint64_t value = 0;
+        const auto* c = carrier + groups * GroupCarrierBytes;
+        for (size_t j = 0; j < (tail * 8 + Bits - 1) / Bits; j++) {
+          value |= static_cast<uint64_t>(c[j] & Mask) << (8 * Bits - Bits * (j + 1));
+        }
+
+        uint8_t padded[Bits];
+        storeGroup(padded, value, std::make_index_sequence<Bits>{});
+        for (size_t i = 0; i < tail; i++) payload[groups * Bits + i] = padded[i];
+      }
+    }
+
+  private:
+    template <size_t... I>
+    static auto loadGroup(const uint8_t* payload, std::index_sequence<I...>) -> uint64_t {
+      return ((static_cast<uint64_t>(payload[I]) << (8 * (Bits - 1 - I))) | ...);
+    }
+
+    template <size_t... I>
+    static auto storeGroup(uint8_t* payload, const uint64_t value, std::index_sequence<I...>) -> void {
+      ((payload[I] = static_cast<uint8_t>(value >> (8 * (Bits - 1 - I)))), ...);
+    }
+
+    template <size_t... J>
+    static auto embedValue(uint8_t* carrier, const uint64_t value, std::index_sequence<J...>) -> void {
+      ((carrier[J] = static_cast<uint8_t>((carrier[J] & ~Mask) | ((value >> (8 * Bits - Bits * (J + 1))) & Mask))), ...);
+    }
+
+    template <size_t... J>
+    static auto extractValue(const uint8_t* carrier, std::index_sequence<J...>) -> uint64_t {
+      return ((static_cast<uint64_t>(carrier[J] & Mask) << (8 * Bits - Bits * (J + 1))) | ...);
+    }
+  };
+}
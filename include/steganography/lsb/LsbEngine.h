@@ -0,0 +1,87 @@
+#pragma once
+#include "steganography/concurrency/ParallelOptions.h"
+#include "steganography/crypto/PayloadCipher.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Packed-byte LSB embedding. At one bit per channel a payload byte is spread across
+// 8 consecutive carrier bytes, most significant bit first, which is the same layout
+// the old '0'/'1' bit-string path produced. Deeper embedding (2-4 bits per channel)
+// packs the same bit stream into fewer carrier bytes, see DepthKernels.h; matrix
+// embedding spreads it over more of them and changes fewer, see MatrixKernels.h.
+namespace Lsb {
+  constexpr int MaxBitsPerChannel = 4;
+  constexpr int MinMatrixBits = 2;
+  constexpr int MaxMatrixBits = 7;
+  constexpr size_t CarrierBytesPerByte = 8;
+  // Payload bytes per parallel task at one bit per channel; the matching 256 KiB of
+  // carrier stays cache-resident.
+  constexpr size_t ParallelChunkBytes = 32 * 1024;
+
+  // How payload bits are laid into carrier bytes: bitsPerChannel low bits of each, or,
+  // with matrixBits set, matrixBits bits in the lowest bits of each block of
+  // 2^matrixBits - 1 carrier bytes. Either way a group of groupPayloadBytes() payload
+  // bytes fills exactly groupCarrierBytes() carrier bytes, so ranges that start on a
+  // group are independent. Converts from a plain depth.
+  struct Density {
+    constexpr Density(const int bitsPerChannel = 1, const int matrixBits = 0)
+      : bitsPerChannel(bitsPerChannel), matrixBits(matrixBits) {}
+
+    [[nodiscard]] constexpr auto groupPayloadBytes() const -> size_t {
+      return static_cast<size_t>(matrixBits > 0 ? matrixBits : bitsPerChannel);
+    }
+    [[nodiscard]] constexpr auto groupCarrierBytes() const -> size_t {
+      return matrixBits > 0 ? CarrierBytesPerByte * ((size_t{1} << matrixBits) - 1) : CarrierBytesPerByte;
+    }
+
+    int bitsPerChannel;
+    // 0 for plain embedding.
+    int matrixBits;
+  };
+
+  auto isValidBitsPerChannel(int bitsPerChannel) -> bool;
+  auto isValidMatrixBits(int matrixBits) -> bool;
+  // Carrier bytes that hold count payload bytes at the given density.
+  auto carrierBytesFor(uint64_t count, Density density) -> uint64_t;
+  // Payload bytes that fit in carrierBytes at the given density.
+  auto payloadBytesWithin(uint64_t carrierBytes, Density density) -> uint64_t;
+  // Largest multiple of a group's payload bytes not above preferred, so that chunk
+  // boundaries always fall on whole groups of carrier bytes.
+  auto alignedChunkBytes(size_t preferred, Density density) -> size_t;
+
+  enum class Kernel { Scalar, Table, SSE2, AVX2 };
+
+  auto getKernelName(Kernel kernel) -> std::string;
+
+  // Best kernel compiled into this binary.
+  auto bestKernel() -> Kernel;
+  auto activeKernel() -> Kernel;
+  auto setKernel(Kernel kernel) -> void;
+
+  auto embedBytes(uint8_t* carrier, const uint8_t* payload, size_t count, Density density = 1) -> void;
+  auto extractBytes(const uint8_t* carrier, uint8_t* payload, size_t count, Density density = 1) -> void;
+
+  auto embedBytes(Kernel kernel, uint8_t* carrier, const uint8_t* payload, size_t count) -> void;
+  auto extractBytes(Kernel kernel, const uint8_t* carrier, uint8_t* payload, size_t count) -> void;
+
+  // Embeds the ciphered payload without materialising the ciphered copy. payload holds
+  // payload bytes [offset, offset + count); offset must start a group when embedding
+  // part of a larger payload.
+  auto embedWithKey(uint8_t* carrier, const uint8_t* payload, size_t count, const Crypto::PayloadCipher& cipher,
+      uint64_t offset = 0, Density density = 1) -> void;
+
+  // Chunked versions that split the range across ThreadPool::shared(). Every group of
+  // carrier bytes depends only on its own payload bytes and the keystream is addressed
+  // by offset, so chunks are fully independent.
+  auto embedWithKey(uint8_t* carrier, const uint8_t* payload, size_t count, const Crypto::PayloadCipher& cipher,
+      const ParallelOptions& parallel, Density density = 1) -> void;
+  auto extractWithKey(const uint8_t* carrier, uint8_t* payload, size_t count, const Crypto::PayloadCipher& cipher,
+      const ParallelOptions& parallel, Density density = 1) -> void;
+
+  // Payload bytes per parallel chunk at the given density.
+  auto parallelChunkBytes(Density density) -> size_t;
+  // Number of parallelChunkBytes() chunks to split count payload bytes into; 1 means serial.
+  auto parallelChunkCount(size_t count, const ParallelOptions& parallel, Density density = 1) -> size_t;
+}
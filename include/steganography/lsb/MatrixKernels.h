@@ -0,0 +1,152 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Matrix embedding with the binary Hamming code of length N = 2^P - 1: P payload bits
+// live in the lowest bits of a block of N carrier bytes as the block's syndrome, the XOR
+// of the 1-based positions of its bytes with the lowest bit set. Embedding flips the
+// lowest bit of at most one byte per block, the one at the position that turns the
+// syndrome into the payload bits, so on random carriers a block changes with odds
+// 1 - 2^-P instead of P / 2 changes for plain LSB.
+//
+// A group of P payload bytes (8 * P bits, most significant first, like DepthKernel)
+// fills 8 blocks, 8 * N carrier bytes. The lowest bits of a group are packed 64 at a
+// time, and syndrome bit k of a block is the parity of its packed bits under a fixed
+// mask of the positions with bit k set, so a block costs P popcounts rather than N
+// byte visits.
+namespace Lsb {
+  template <int P>
+  struct MatrixKernel {
+    static_assert(P >= 2 && P <= 7, "Hamming codes of 2 to 7 bits are supported");
+
+    static constexpr uint64_t Mask = (uint64_t{1} << P) - 1;
+    static constexpr size_t BlockBytes = (size_t{1} << P) - 1;
+    static constexpr size_t GroupPayloadBytes = P;
+    static constexpr size_t GroupCarrierBytes = 8 * BlockBytes;
+
+    static auto embed(uint8_t* carrier, const uint8_t* payload, const size_t count) -> void {
+      size_t groups = count / P;
+      for (size_t g = 0; g < groups; g++) {
+        embedBlocks(carrier + g * GroupCarrierBytes, loadGroup(payload + g * P, P), 8);
+      }
+
+      // The last partial group is padded with zero bits; only the blocks that hold real
+      // payload bits are touched.
+      auto tail = count % P;
+      if (tail != 0) {
+        embedBlocks(carrier + groups * GroupCarrierBytes, loadGroup(payload + groups * P, tail), tailBlocks(tail));
+      }
+    }
+
+    static auto extract(const uint8_t* carrier, uint8_t* payload, const size_t count) -> void {
+      size_t groups = count / P;
+      for (size_t g = 0; g < groups; g++) {
+        storeGroup(payload + g * P, extractBlocks(carrier + g * GroupCarrierBytes, 8), P);
+      }
+
+      auto tail = count % P;
+      if (tail != 0) {
+        storeGroup(payload + groups * P, extractBlocks(carrier + groups * GroupCarrierBytes, tailBlocks(tail)), tail);
+      }
+    }
+
+  private:
+    // Packed lowest bits of a group, with a spare word so a block read never runs past it.
+    static constexpr size_t PackedWords = GroupCarrierBytes / 64 + 2;
+    using Packed = std::array<uint64_t, PackedWords>;
+
+    // columns[k] holds, for positions 1..N at bits 0..N-1, the positions with bit k set;
+    // the second word covers positions past 64, which only the 7-bit code has.
+    static constexpr auto makeColumns() -> std::array<std::array<uint64_t, 2>, P> {
+      std::array<std::array<uint64_t, 2>, P> columns{};
+      for (int k = 0; k < P; k++) {
+        for (size_t position = 1; position <= BlockBytes; position++) {
+          if ((position >> k) & 1) columns[k][(position - 1) / 64] |= uint64_t{1} << ((position - 1) % 64);
+        }
+      }
+      return columns;
+    }
+
+    static constexpr auto columns = makeColumns();
+
+    static auto tailBlocks(const size_t tail) -> size_t {
+      return (tail * 8 + P - 1) / P;
+    }
+
+    static auto loadGroup(const uint8_t* payload, const size_t count) -> uint64_t {
+      uint64_t value = 0;
+      for (size_t i = 0; i < P; i++) {
+        value = (value << 8) | (i < count ? payload[i] : 0);
+      }
+      return value;
+    }
+
+    static auto storeGroup(uint8_t* payload, const uint64_t value, const size_t count) -> void {
+      for (size_t i = 0; i < count; i++) {
+        payload[i] = static_cast<uint8_t>(value >> (8 * (P - 1 - i)));
+      }
+    }
+
+    // Packs the lowest bits of bytes carrier bytes, byte i into bit i % 64 of word i / 64.
+    static auto pack(const uint8_t* carrier, const size_t bytes, Packed& packed) -> void {
+      packed.fill(0);
+      size_t i = 0;
+      if constexpr (std::endian::native == std::endian::little) {
+        // The multiply gathers the lowest bit of byte j of a word into bit 56 + j.
+        for (; i + 8 <= bytes; i += 8) {
+          uint64_t word;
+          std::memcpy(&word, carrier + i, sizeof(word));
+          auto bits = ((word & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56;
+          packed[i / 64] |= bits << (i % 64);
+        }
+      }
+      for (; i < bytes; i++) {
+        packed[i / 64] |= static_cast<uint64_t>(carrier[i] & 1) << (i % 64);
+      }
+    }
+
+    // The 64 packed bits from bit offset onwards.
+    static auto bitsAt(const Packed& packed, const size_t offset) -> uint64_t {
+      auto word = offset / 64, shift = offset % 64;
+      auto bits = packed[word] >> shift;
+      return shift == 0 ? bits : bits | packed[word + 1] << (64 - shift);
+    }
+
+    static auto syndrome(const Packed& packed, const size_t block) -> uint64_t {
+      auto low = bitsAt(packed, block * BlockBytes);
+      uint64_t high = 0;
+      if constexpr (BlockBytes > 64) high = bitsAt(packed, block * BlockBytes + 64);
+
+      uint64_t value = 0;
+      for (int k = 0; k < P; k++) {
+        auto parity = std::popcount(low & columns[k][0]) ^ std::popcount(high & columns[k][1]);
+        value |= static_cast<uint64_t>(parity & 1) << k;
+      }
+      return value;
+    }
+
+    static auto embedBlocks(uint8_t* carrier, const uint64_t value, const size_t blocks) -> void {
+      Packed packed;
+      pack(carrier, blocks * BlockBytes, packed);
+      for (size_t b = 0; b < blocks; b++) {
+        auto bits = (value >> (8 * P - P * (b + 1))) & Mask;
+        if (auto position = syndrome(packed, b) ^ bits) {
+          carrier[b * BlockBytes + position - 1] ^= 1;
+        }
+      }
+    }
+
+    static auto extractBlocks(const uint8_t* carrier, const size_t blocks) -> uint64_t {
+      Packed packed;
+      pack(carrier, blocks * BlockBytes, packed);
+      uint64_t value = 0;
+      for (size_t b = 0; b < blocks; b++) {
+        value |= syndrome(packed, b) << (8 * P - P * (b + 1));
+      }
+      return value;
+    }
+  };
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "steganography/crypto/PayloadCipher.h"
+#include "steganography/lsb/LsbEngine.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// The header in front of every embedded payload. It is always stored at one bit per
+// carrier byte, so it can be read before the payload depth is known.
+//
+// The first 32-bit word is the classic length prefix: the payload length in bits,
+// which is always a multiple of 8, with bitsPerChannel - 1 in its low two bits, so a
+// one-bit payload produces exactly the classic prefix. Bit 2 announces a second 32-bit
+// word, used by payloads of 2^29 bytes or more and by any non-default cipher. Its upper
+// 24 bits continue the byte length above the 29 bits the prefix holds and its low 8 bits
+// are flags: bit 0 selects ChaCha20, in which case the 16-byte key derivation salt
+// follows the second word, again at one bit per carrier byte, and bit 1 marks a payload
+// stored as a compressed frame (see PayloadFrame.h). The other flags are reserved and
+// must be 0. Without the second word the payload is stored as is under the repeating key.
+//
+// Flag bit 2 marks a payload stored Reed-Solomon coded (see ReedSolomon.h). A third word
+// then follows the second, ahead of any salt: the parity bytes per codeword in its top 8
+// bits, 8 reserved zero bits and a CRC-16 of the header (both words, the top half of this
+// one and the salt). Such a header is written three times in a row, so one whose first
+// copy is damaged is still read from the bitwise majority of the three.
+//
+// Flag bit 3 marks a versioned header, which every header with the second word now is.
+// Four more words close it, after any third word and salt: the magic "STG" with the
+// version (1) in the low byte, the cipher's key check, the CRC-32C of the stored payload
+// before it is enciphered and the CRC-32C of the header itself, every word before this
+// one and the salt. A header whose magic or checksum does not match is rejected, and a
+// wrong key fails on the key check before the payload is read. Headers without the flag,
+// the bare prefix above included, are read as before: the legacy layout. Legacy headers
+// and their payloads go through the flat carrier of the first releases rather than the
+// image's geometry (see flatLayout() in ImageHandle.h), so a plain repeating-key image
+// reads back with those releases and theirs read back here, padded and 32-bit BMPs too.
+//
+// Bits 4-6 of the flags hold the matrix code, 2 to 7, of a payload stored with matrix
+// embedding at one bit per channel (see MatrixKernels.h), or 0 for plain embedding. Only
+// versioned headers carry one. The payload then starts at the first whole group of
+// carrier bytes after the header, so that its groups line up with the carrier ranges
+// streaming and scattering work in.
+namespace Lsb {
+  struct PayloadHeader {
+    uint64_t payloadBytes = 0;
+    int bitsPerChannel = 1;
+    Crypto::Cipher cipher = Crypto::Cipher::RepeatingKey;
+    // Key derivation salt; only stored for ChaCha20.
+    Crypto::Salt salt = {};
+    // payloadBytes then counts the stored frame, not the original payload.
+    bool compressed = false;
+    // Reed-Solomon parity bytes per codeword, or 0 for none; payloadBytes then counts
+    // the coded bytes.
+    int fecParity = 0;
+    // 0 for the legacy layout, otherwise the version of the closing words below.
+    int version = 0;
+    uint32_t keyCheck = 0;
+    // CRC-32C of the stored payload as it is before the cipher is applied; of its data
+    // bytes only when it is error corrected.
+    uint32_t payloadCrc = 0;
+    // Hamming code bits of matrix embedding, or 0 for none.
+    int matrixBits = 0;
+
+    [[nodiscard]] auto density() const -> Density {
+      return {bitsPerChannel, matrixBits};
+    }
+  };
+
+  constexpr size_t HeaderWordBits = 32;
+  constexpr size_t SaltCarrierBytes = Crypto::SaltBytes * 8;
+  constexpr size_t VersionedCarrierBytes = 4 * HeaderWordBits;
+  constexpr size_t HeaderCopies = 3;
+  constexpr size_t MaxHeaderCarrierBytes = HeaderCopies * (3 * HeaderWordBits + SaltCarrierBytes + VersionedCarrierBytes);
+  constexpr int CurrentHeaderVersion = 1;
+  constexpr uint64_t MaxPayloadBytes = (uint64_t{1} << 53) - 1;
+
+  // True if header needs the second word. New headers that do are written versioned.
+  auto isExtended(const PayloadHeader& header) -> bool;
+
+  // Carrier bytes the header takes: one word, two if it needs the extended word, plus the
+  // salt for ChaCha20 and the closing words of a versioned header; with error correction
+  // three words and the rest, three times over.
+  auto headerCarrierBytes(const PayloadHeader& header) -> size_t;
+  // Carrier bytes ahead of the payload: the header, rounded up to a whole group with
+  // matrix embedding.
+  auto payloadCarrierOffset(const PayloadHeader& header) -> uint64_t;
+
+  auto writeHeader(uint8_t* carrier, const PayloadHeader& header) -> void;
+  // Reads the header from the first available carrier bytes. Returns nullopt if the
+  // header is malformed or needs more than available bytes.
+  auto readHeader(const uint8_t* carrier, size_t available) -> std::optional<PayloadHeader>;
+}
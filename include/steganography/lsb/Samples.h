@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Plain (ASCII) Netpbm rasters, whose samples are decimal text rather than bytes.
+namespace Lsb {
+  // Parses out.size() decimal samples from text, skipping whitespace and '#' comments.
+  // Digits are converted eight bytes at a time. Throws if text runs out first or a sample
+  // is malformed or above 65535. Samples above the image's maxval are accepted, since
+  // embedding can push a sample just past a maxval that is not all ones.
+  auto parseDecimalSamples(std::string_view text, std::span<uint16_t> out) -> void;
+  // Appends samples as decimal text, space separated in lines of at most 70 characters.
+  auto appendDecimalSamples(std::span<const uint16_t> samples, std::string& out) -> void;
+}
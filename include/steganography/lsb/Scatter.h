@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Keyed scattering of the carrier stream. The stream is moved in groups of
+// ScatterGroupBytes carrier bytes (one depth group, see DepthKernels.h): logical group g,
+// which the sequential layout would store at byte 8g, is stored at group permutation(g)
+// of the pixel data. The header and payload are spread over the whole image instead of
+// its first rows, while every random access still moves a whole group.
+namespace Lsb {
+  constexpr size_t ScatterGroupBytes = 8;
+
+  // Carrier bytes usable in scatter mode: whole groups only.
+  auto scatterCapacity(uint64_t carrierBytes) -> uint64_t;
+  // Groups that hold count logical carrier bytes.
+  auto scatterGroupsFor(uint64_t count) -> uint64_t;
+
+  // A keyed bijection over [0, size) that needs no per-index memory: an alternating
+  // Feistel network over the smallest power of two covering size, cycle-walked until the
+  // result falls back inside the domain. The walk takes under two steps on average.
+  class ScatterPermutation {
+  public:
+    static constexpr int Rounds = 4;
+
+    ScatterPermutation(uint64_t size, const std::string& key);
+
+    [[nodiscard]] auto operator()(uint64_t index) const -> uint64_t;
+    [[nodiscard]] auto size() const -> uint64_t;
+
+    // groups[j] = (*this)(first + j) for j < count.
+    auto map(uint64_t first, uint64_t* groups, size_t count) const -> void;
+
+  private:
+    [[nodiscard]] auto permute(uint64_t value) const -> uint64_t;
+
+    uint64_t domainSize = 0;
+    int highBits = 1;
+    int lowBits = 1;
+    uint64_t lowMask = 1;
+    std::array<uint64_t, Rounds> roundKeys = {};
+  };
+
+  // Copies count logical carrier bytes, starting at the first of the mapped groups, to out.
+  auto gather(const uint8_t* carrier, const uint64_t* groups, uint8_t* out, size_t count) -> void;
+  // Stores count bytes from in as the logical carrier bytes gather() would read.
+  auto scatter(uint8_t* carrier, const uint64_t* groups, const uint8_t* in, size_t count) -> void;
+}
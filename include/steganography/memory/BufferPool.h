@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+// Per-thread reuse of the carrier buffers and scratch that encode and decode need for
+// the length of one call. Batch jobs, daemon requests and parallel chunks run on
+// long-lived pool threads, so once a thread has seen the sizes its jobs need it stops
+// allocating for them. Buffers go back to the pool of the thread that releases them.
+namespace Memory {
+  // Buffers a thread keeps for reuse, and the most bytes they may hold in total; a
+  // buffer that would go past either is freed instead.
+  constexpr size_t MaxPooledBuffers = 16;
+  constexpr size_t MaxPooledBytes = size_t{256} << 20;
+
+  // Heap bytes as the pool hands them around. They come from new[] without an
+  // initializer, so they are never zeroed and are aligned for any scalar type.
+  struct Storage {
+    std::unique_ptr<uint8_t[]> bytes;
+    // Capacity; never shrunk, so it is what the pool tracks.
+    size_t size = 0;
+  };
+
+  // A buffer of at least size bytes leased from the calling thread's pool. The contents
+  // are whatever an earlier lease left, or indeterminate in fresh storage; never zeroed.
+  class Buffer {
+  public:
+    Buffer() = default;
+    explicit Buffer(size_t size);
+    ~Buffer();
+
+    Buffer(Buffer&& other) noexcept;
+    auto operator=(Buffer&& other) noexcept -> Buffer&;
+    Buffer(const Buffer&) = delete;
+    auto operator=(const Buffer&) -> Buffer& = delete;
+
+    [[nodiscard]] auto data() -> uint8_t* {
+      return storage.bytes.get();
+    }
+    [[nodiscard]] auto data() const -> const uint8_t* {
+      return storage.bytes.get();
+    }
+    [[nodiscard]] auto size() const -> size_t {
+      return count;
+    }
+    [[nodiscard]] auto bytes() -> std::span<std::byte> {
+      return std::as_writable_bytes(std::span(storage.bytes.get(), count));
+    }
+
+    // Storage for count values of T, which must be trivial.
+    template <typename T>
+    [[nodiscard]] auto as() -> T* {
+      return reinterpret_cast<T*>(storage.bytes.get());
+    }
+
+  private:
+    auto release() -> void;
+
+    Storage storage;
+    size_t count = 0;
+  };
+}
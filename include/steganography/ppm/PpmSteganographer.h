@@ -2,9 +2,6 @@
 #include "../ISteganographer.h"
 
 class PpmSteganographer : public ISteganographer {
-public:
-  bool encode(const std::string &filepath, const std::string &message, const std::string &key) override;
-  std::string decode(const std::string &filepath, const std::string &key) override;
-  bool canEncode(const std::string &filepath, const std::string &message) override;
-  auto getImageDimensions(const std::string& filepath) -> std::pair<int, int> override;
-};
\ No newline at end of file
+protected:
+  auto parseLayout(std::span<const uint8_t> head, uint64_t fileSize) const -> std::optional<ImageLayout> override;
+};
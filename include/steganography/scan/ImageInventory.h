@@ -0,0 +1,54 @@
+#pragma once
+
+#include "steganography/EncodeOptions.h"
+#include "steganography/SteganographerManager.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// A bulk listing for auditing image archives: what each image's header says and how much
+// it can hold. Only the header is read. ISteganographer::open() costs an open, one fstat
+// for the size and one small read per image, and images are listed in parallel.
+struct InventoryEntry {
+  std::string image;
+  Utils::ImageFormat format = Utils::ImageFormat::NOT_SUPPORTED;
+  int width = 0;
+  int height = 0;
+  int bitsPerPixel = 0;
+  uint64_t fileBytes = 0;
+  uint64_t carrierBytes = 0;
+  // Payload bytes that fit with the listing's options, as ISteganographer::capacity().
+  uint64_t capacityBytes = 0;
+  // Why the image or directory could not be listed; the other fields are unset then.
+  std::string error;
+
+  // One JSON object on a single line, without the line break.
+  [[nodiscard]] auto toJson() const -> std::string;
+};
+
+struct InventoryReport {
+  size_t listed = 0;
+  size_t failed = 0;
+};
+
+class ImageInventory {
+public:
+  using EntrySink = std::function<void(const InventoryEntry&)>;
+
+  explicit ImageInventory(SteganographerManager& steganographerManager);
+
+  // Lists every supported image among paths, walking directories recursively, in
+  // parallel on the shared pool. sink gets each entry as soon as its image is done, in
+  // no particular order and from one thread at a time. Images that cannot be read and
+  // directories that cannot be walked arrive as entries with an error.
+  auto list(const std::vector<std::string>& paths, const EncodeOptions& options, const EntrySink& sink) const -> InventoryReport;
+
+  // Lists one image. Throws if it cannot be read.
+  auto describe(const std::string& image, const EncodeOptions& options) const -> InventoryEntry;
+
+private:
+  SteganographerManager& steganographerManager;
+};
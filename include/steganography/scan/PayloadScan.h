@@ -0,0 +1,65 @@
+#pragma once
+
+#include "steganography/ImageHandle.h"
+#include "steganography/SteganographerManager.h"
+#include "steganography/lsb/PayloadHeader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// A keyless triage of which images carry a payload. Only the start of the carrier is
+// read: the payload header and at most SignatureCarrierBytes of what would follow it.
+// Nothing is decoded. Payloads embedded with --scatter start at a keyed position and
+// cannot be found this way.
+//
+// An image is a candidate when its header is well formed and its payload fits the
+// capacity. Such a header can still be chance, so each candidate gets a confidence
+// built from two parts:
+//   - the header term, 1 minus the odds that the low bits of an image without a payload
+//     would form a header that fits just as well. Those odds shrink as the capacity
+//     falls behind the 2^29 byte range of the length prefix. A versioned header has to
+//     pass its CRC-32C, which chance all but never does, so its term is 1.
+//   - the signature term, from a chi-square test on the sampled payload bits. Embedding
+//     evens out the counts of sample values that differ only in the bits it replaces,
+//     which untouched image data seldom does. A sample the test does not reject scores
+//     1, one it rejects outright 0.5 (plain, unkeyed payloads are not random either) and
+//     one too small to judge 0.75.
+// The confidence is the product of both terms.
+struct ScanResult {
+  std::string image;
+  Lsb::PayloadHeader header;
+  double confidence = 0;
+  double headerTerm = 0;
+  double signatureTerm = 0;
+};
+
+struct ScanReport {
+  // Candidates, most confident first.
+  std::vector<ScanResult> candidates;
+  size_t scanned = 0;
+  // "<image>: <reason>" for every image that could not be read.
+  std::vector<std::string> failures;
+};
+
+class PayloadScanner {
+public:
+  static constexpr size_t SignatureCarrierBytes = 64 * 1024;
+
+  explicit PayloadScanner(SteganographerManager& steganographerManager);
+
+  // Scans every supported image among paths, walking directories recursively, in
+  // parallel on the shared pool.
+  auto scan(const std::vector<std::string>& paths) const -> ScanReport;
+
+  // Scans one image; nullopt when it has no plausible header. Throws if it cannot be read.
+  auto probe(const std::string& image) const -> std::optional<ScanResult>;
+
+private:
+  // Probes the carrier bytes layout puts in handle's image.
+  auto probe(const ImageHandle& handle, const ImageLayout& layout) const -> std::optional<ScanResult>;
+
+  SteganographerManager& steganographerManager;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// A payload split across several carriers is stored as one shard per image, each an
+// ordinary embedded payload that starts with this fixed-size header. All fields are
+// little-endian: the magic "ISSH", a 32-bit flags word (bit 0: the shards together form
+// a compressed frame, see PayloadFrame.h), the 64-bit set id shared by every shard of one
+// split, the 32-bit shard index and count, the 64-bit offset of this shard's bytes in the
+// joined payload and the 64-bit size of the joined payload.
+namespace Shard {
+  constexpr size_t HeaderBytes = 40;
+
+  struct Header {
+    uint64_t setId = 0;
+    uint32_t index = 0;
+    uint32_t count = 0;
+    uint64_t offset = 0;
+    uint64_t totalBytes = 0;
+    bool compressed = false;
+  };
+
+  auto writeHeader(const Header& header, std::span<std::byte, HeaderBytes> out) -> void;
+  // Returns nullopt unless bytes start with a well-formed header.
+  auto readHeader(std::span<const std::byte> bytes) -> std::optional<Header>;
+
+  // Splits payloadBytes over carriers that can take capacities[i] bytes each, not
+  // counting the shard header, in proportion to their capacity, so every carrier is
+  // filled to about the same fraction. Every carrier gets a shard, possibly an empty
+  // one. Throws if the payload does not fit.
+  auto planShards(std::span<const uint64_t> capacities, uint64_t payloadBytes) -> std::vector<uint64_t>;
+}
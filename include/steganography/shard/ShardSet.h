@@ -0,0 +1,43 @@
+#pragma once
+
+#include "steganography/EncodeOptions.h"
+#include "steganography/ISteganographer.h"
+#include "steganography/SteganographerManager.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// A shard set that cannot be written or joined as given: images missing, repeated, too
+// small, unreadable or from different sets. The message is meant for the user as it is.
+class ShardError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+// Splits one payload across several carrier images, BMP and PPM mixed, and joins it back.
+// Each image gets one shard (see ShardHeader.h) sized by its capacity. Images are
+// embedded and decoded in parallel, one per task, and decode accepts the images in any order.
+class ShardSet {
+public:
+  explicit ShardSet(SteganographerManager& steganographerManager);
+
+  // Embeds payload across images in place, all with the same key and options. With
+  // options.compress the payload is compressed once as a whole before it is split.
+  // Every image is opened and sized before any is written, so a payload that does not
+  // fit leaves all of them untouched. Returns the number of payload bytes stored.
+  auto encode(const std::vector<std::string>& images, std::span<const std::byte> payload, const std::string& key, const EncodeOptions& options) const -> uint64_t;
+
+  // Decodes the shards in images, checks that they form one complete set and passes the
+  // joined payload to sink in order. Returns the payload size. Both throw ShardError when
+  // the images do not make a set, naming the image at fault where there is one.
+  auto decode(const std::vector<std::string>& images, const std::string& key, const PayloadSink& sink, const DecodeOptions& options = {}) const -> uint64_t;
+
+private:
+  auto steganographerFor(const std::string& image) const -> ISteganographer&;
+
+  SteganographerManager& steganographerManager;
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Opt-in per-command instrumentation. Probes only record while a Session is active on
+// the current thread, so with stats off each probe costs a thread_local load and a branch.
+namespace Stats {
+  enum class Phase { Open, ParseHeader, Read, Map, Compress, ErrorCorrection, Checksum, Embed, Extract, Xor, Decompress, Write, Flush };
+  constexpr size_t PhaseCount = 13;
+
+  // Allocations is only counted and reported in builds with IMAGESTEG_COUNT_ALLOCATIONS.
+  enum class Counter { BytesRead, BytesWritten, CarrierBytes, Allocations, BufferReuses, CorrectedBytes };
+  constexpr size_t CounterCount = 6;
+
+  auto getPhaseName(Phase phase) -> std::string;
+  auto getCounterName(Counter counter) -> std::string;
+
+  // Totals for one command. Safe to update from several threads; time spent in a phase
+  // on several threads at once is summed, so phases can add up to more than wall time.
+  class Collector {
+  public:
+    auto addTime(Phase phase, uint64_t nanoseconds) -> void;
+    auto add(Counter counter, uint64_t amount) -> void;
+
+    [[nodiscard]] auto getNanoseconds(Phase phase) const -> uint64_t;
+    [[nodiscard]] auto getCalls(Phase phase) const -> uint64_t;
+    [[nodiscard]] auto getCount(Counter counter) const -> uint64_t;
+
+  private:
+    std::array<std::atomic<uint64_t>, PhaseCount> nanoseconds{};
+    std::array<std::atomic<uint64_t>, PhaseCount> calls{};
+    std::array<std::atomic<uint64_t>, CounterCount> counters{};
+  };
+
+  inline thread_local Collector* current = nullptr;
+
+  // Routes the probes of the current thread to collector (nullptr turns them off) until
+  // destroyed. Parallel code passes the caller's active() collector on to its tasks.
+  class Session {
+  public:
+    explicit Session(Collector* collector) : previous(current) {
+      current = collector;
+    }
+    ~Session() {
+      current = previous;
+    }
+
+    Session(const Session&) = delete;
+    auto operator=(const Session&) -> Session& = delete;
+
+  private:
+    Collector* previous;
+  };
+
+  inline auto active() -> Collector* {
+    return current;
+  }
+
+  inline auto add(const Counter counter, const uint64_t amount) -> void {
+    if (auto* collector = current) collector->add(counter, amount);
+  }
+
+  // Adds the lifetime of the scope to phase.
+  class ScopedTimer {
+  public:
+    explicit ScopedTimer(const Phase phase) : collector(current), phase(phase) {
+      if (collector) start = std::chrono::steady_clock::now();
+    }
+    ~ScopedTimer() {
+      if (collector) {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        collector->addTime(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+      }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    auto operator=(const ScopedTimer&) -> ScopedTimer& = delete;
+
+  private:
+    Collector* collector;
+    Phase phase;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  // Multi-line table of the phases and counters that recorded anything.
+  auto formatSummary(const Collector& collector) -> std::string;
+  // {"phases":{"<name>":{"ms":..,"calls":..},...},"counters":{"<name>":..,...}}
+  auto toJson(const Collector& collector) -> std::string;
+}
@@ -1,7 +1,32 @@
+#include "steganography/cli/BatchRunner.h"
+#include "steganography/cli/DaemonClient.h"
+#include "steganography/cli/DaemonServer.h"
 #include "steganography/cli/Shell.h"
 
-int main() {
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    if (!args.empty() && BatchRunner::isBatchFlag(args[0])) {
+        BatchRunner batchRunner;
+        return batchRunner.run(args);
+    }
+    if (!args.empty() && DaemonServer::isDaemonFlag(args[0])) {
+        DaemonServer server;
+        return server.run(args);
+    }
+    if (!args.empty() && DaemonClient::isClientFlag(args[0])) {
+        DaemonClient client;
+        return client.run(args);
+    }
+
     Shell shell;
+    if (!args.empty()) {
+        return shell.runOnce(args);
+    }
+
     shell.run();
 
     return 0;
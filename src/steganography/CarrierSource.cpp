@@ -0,0 +1,92 @@
+#include "steganography/CarrierSource.h"
+#include "steganography/lsb/CarrierGeometry.h"
+#include "steganography/lsb/Samples.h"
+#include "steganography/memory/BufferPool.h"
+#include "steganography/stats/Stats.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace {
+    // Group positions computed ahead of each batch of scattered reads.
+    constexpr size_t GatherBatchGroups = 512;
+}
+
+CarrierSource::CarrierSource(const ImageHandle& image, const ImageLayout& layout, const std::string& key,
+    const bool scatter) : image(image), layout(layout) {
+    if (layout.encoding == SampleEncoding::Ascii) {
+        // Plain rasters have no fixed byte per sample, so they are parsed once up front.
+        Stats::ScopedTimer timer(Stats::Phase::Read);
+        std::string text(static_cast<size_t>(image.getFileSize() - layout.pixelDataOffset), '\0');
+        image.getFile().readExactAt(layout.pixelDataOffset, text.data(), text.size());
+
+        std::vector<uint16_t> samples(static_cast<size_t>(layout.carrierBytes));
+        Lsb::parseDecimalSamples(text, samples);
+        decoded.resize(samples.size());
+        std::transform(samples.begin(), samples.end(), decoded.begin(),
+            [](const uint16_t sample) { return static_cast<uint8_t>(sample); });
+        carrier = decoded.data();
+    } else if (scatter) {
+        Stats::ScopedTimer timer(Stats::Phase::Map);
+        mapping = std::make_unique<MappedFile>(image.getFile(), layout.pixelDataOffset,
+            static_cast<size_t>(layout.geometry.spanBytes(layout.carrierBytes)));
+        carrier = mapping->data();
+
+        if (!layout.geometry.isContiguous()) {
+            decoded.resize(static_cast<size_t>(layout.carrierBytes));
+            Lsb::loadCarrier(mapping->data(), layout.geometry, 0, decoded.data(), decoded.size());
+            carrier = decoded.data();
+            mapping.reset();
+        }
+    }
+
+    if (scatter) {
+        permutation.emplace(layout.carrierBytes / Lsb::ScatterGroupBytes, key);
+    }
+}
+
+auto CarrierSource::size() const -> uint64_t {
+    if (permutation) {
+        return permutation->size() * Lsb::ScatterGroupBytes;
+    }
+    if (carrier != nullptr) {
+        return decoded.size();
+    }
+    if (!layout.geometry.isContiguous()) {
+        return layout.carrierBytes;
+    }
+    return image.getFileSize() - layout.pixelDataOffset;
+}
+
+auto CarrierSource::read(const uint64_t position, uint8_t* out, const size_t count) const -> void {
+    Stats::ScopedTimer timer(Stats::Phase::Read);
+    if (permutation) {
+        uint64_t groups[GatherBatchGroups];
+        auto first = position / Lsb::ScatterGroupBytes;
+        for (size_t done = 0; done < count;) {
+            auto n = std::min(count - done, GatherBatchGroups * Lsb::ScatterGroupBytes);
+            permutation->map(first + done / Lsb::ScatterGroupBytes, groups,
+                static_cast<size_t>(Lsb::scatterGroupsFor(n)));
+            Lsb::gather(carrier, groups, out + done, n);
+            done += n;
+        }
+        return;
+    }
+    if (carrier != nullptr) {
+        std::memcpy(out, carrier + position, count);
+        return;
+    }
+
+    const auto& geometry = layout.geometry;
+    if (geometry.isContiguous()) {
+        image.getFile().readExactAt(layout.pixelDataOffset + position, out, count);
+        return;
+    }
+
+    // Reads the rows that hold the range and gathers its carrier bytes out of them.
+    auto begin = geometry.rowOffset(position);
+    Memory::Buffer rows(static_cast<size_t>(geometry.spanBytes(position + count) - begin));
+    image.getFile().readExactAt(layout.pixelDataOffset + begin, rows.data(), rows.size());
+    Lsb::loadCarrier(rows.data(), geometry, position, out, count);
+}
@@ -1,66 +1,1133 @@
 #include "steganography/ISteganographer.h"
-#include "steganography/Utils.h"
+#include "steganography/checksum/Crc32c.h"
+#include "steganography/compress/PayloadFrame.h"
+#include "steganography/concurrency/ThreadPool.h"
+#include "steganography/crypto/PayloadCipher.h"
+#include "steganography/fec/ReedSolomon.h"
+#include "steganography/io/File.h"
+#include "steganography/io/MappedFile.h"
+#include "steganography/lsb/LsbEngine.h"
+#include "steganography/lsb/CarrierGeometry.h"
+#include "steganography/lsb/PayloadHeader.h"
+#include "steganography/lsb/Samples.h"
+#include "steganography/lsb/Scatter.h"
+#include "steganography/memory/BufferPool.h"
+#include "steganography/stats/Stats.h"
 
-#include <bitset>
-#include <fstream>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <ostream>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
-auto ISteganographer::encodeLSB(std::vector<char>& buffer, size_t pixelDataOffset, const std::string& message,
-    const std::string& key, const std::string& filepath) -> bool {
-    std::string bitMessage = Utils::textToBitString(message);
-    std::bitset<32> messageLength(bitMessage.length());
+namespace {
+    constexpr size_t DecodeChunkBytes = 64 * 1024;
+    constexpr size_t HeaderProbeBytes = 4 * 1024;
+    constexpr size_t MaxHeaderProbeBytes = 1024 * 1024;
+    constexpr size_t SinkWindowBytes = 1024 * 1024;
+    // Logical carrier bytes gathered, embedded and scattered back per task in scatter
+    // mode, rounded down to whole groups of the payload; it still holds the largest header.
+    constexpr size_t ScatterChunkBytes = 64 * 1024;
+    // Carrier bytes per streaming read and write; a multiple of CarrierBytesPerByte.
+    constexpr size_t StreamBlockBytes = 1024 * 1024;
+    constexpr uint64_t UnknownSize = std::numeric_limits<uint64_t>::max();
+    // LZ4 expands a block at most about 255-fold, which bounds what a corrupt frame header
+    // can make decode reserve up front.
+    constexpr uint64_t MaxExpansion = 256;
 
-    bitMessage = Utils::xorString(bitMessage, key);
-    bitMessage = messageLength.to_string() + bitMessage;
+    // The header an encode with these options produces, for sizing; the salt is left empty.
+    // Headers that need the extended word are versioned, so only plain repeating-key
+    // payloads keep the legacy layout.
+    auto headerFor(const uint64_t payloadBytes, const EncodeOptions& options) -> Lsb::PayloadHeader {
+        Lsb::PayloadHeader header{payloadBytes, options.bitsPerChannel, options.cipher, {}, options.compress,
+            options.fecParity};
+        header.matrixBits = options.matrixBits;
+        if (Lsb::isExtended(header)) {
+            header.version = Lsb::CurrentHeaderVersion;
+        }
+        return header;
+    }
+
+    // The header to embed. There is nothing to derive a cipher key from without a key, so
+    // such payloads use the repeating key; ChaCha20 gets a fresh salt every time.
+    auto headerFor(const uint64_t payloadBytes, const EncodeOptions& options, const std::string& key)
+        -> Lsb::PayloadHeader {
+        auto header = headerFor(payloadBytes, options);
+        if (key.empty()) {
+            header.cipher = Crypto::Cipher::RepeatingKey;
+        }
+        if (header.cipher == Crypto::Cipher::ChaCha20) {
+            header.salt = Crypto::randomSalt();
+        }
+        return header;
+    }
+
+    auto cipherFor(const Lsb::PayloadHeader& header, const std::string& key) -> Crypto::PayloadCipher {
+        if (header.cipher == Crypto::Cipher::ChaCha20) {
+            return {key, header.salt};
+        }
+        return Crypto::PayloadCipher(key);
+    }
+
+    // Records the key check and the payload checksum in a versioned header. An error
+    // corrected payload is checksummed on its data bytes, which is what decoding gets back
+    // from the corrector, so that a miscorrection shows.
+    auto seal(Lsb::PayloadHeader& header, std::span<const std::byte> payload, const Crypto::PayloadCipher& cipher)
+        -> void {
+        if (header.version == 0) return;
+
+        Stats::ScopedTimer timer(Stats::Phase::Checksum);
+        header.keyCheck = cipher.keyCheck();
+        if (header.fecParity == 0) {
+            header.payloadCrc = Checksum::crc32c(payload);
+            return;
+        }
+
+        uint32_t crc = 0;
+        Fec::forEachData(payload, header.fecParity, [&](std::span<const std::byte> data) {
+            crc = Checksum::crc32c(data, crc);
+        });
+        header.payloadCrc = crc;
+    }
+
+    // The cipher to decode with. A versioned header rejects a wrong key here, before any
+    // payload byte is read.
+    auto decodingCipherFor(const Lsb::PayloadHeader& header, const std::string& key) -> Crypto::PayloadCipher {
+        auto cipher = cipherFor(header, key);
+        if (header.version > 0 && cipher.keyCheck() != header.keyCheck) {
+            throw std::runtime_error("Wrong key: the image holds a payload encrypted with another one.");
+        }
+        return cipher;
+    }
+
+    // Throws unless crc, the CRC-32C of the whole stored payload (after error correction,
+    // if any), matches a versioned header.
+    auto verifyPayload(const Lsb::PayloadHeader& header, const uint32_t crc) -> void {
+        if (header.version > 0 && crc != header.payloadCrc) {
+            throw std::runtime_error("The payload does not match its checksum; the image is damaged.");
+        }
+    }
+
+    auto crcOf(std::span<const std::byte> bytes, const uint32_t crc = 0) -> uint32_t {
+        Stats::ScopedTimer timer(Stats::Phase::Checksum);
+        return Checksum::crc32c(bytes, crc);
+    }
+
+    // Runs embed on carrier bytes [0, count) of the pixel data at pixels: in place when
+    // they are contiguous, otherwise on a gathered copy that is stored back afterwards.
+    template <typename Embed>
+    auto withCarrierBytes(uint8_t* pixels, const Lsb::CarrierGeometry& geometry, const uint64_t count, Embed&& embed)
+        -> void {
+        if (geometry.isContiguous()) {
+            embed(pixels);
+            return;
+        }
+
+        Memory::Buffer carrier(static_cast<size_t>(count));
+        Lsb::loadCarrier(pixels, geometry, 0, carrier.data(), carrier.size());
+        embed(carrier.data());
+        Lsb::storeCarrier(pixels, geometry, 0, carrier.data(), carrier.size());
+    }
+
+    // Rows per streamed block: about StreamBlockBytes of them, holding a multiple of
+    // groupCarrierBytes carrier bytes so that every block starts a group.
+    auto streamBlockRows(const Lsb::CarrierGeometry& geometry, const uint64_t groupCarrierBytes) -> uint64_t {
+        auto step = groupCarrierBytes / std::gcd(geometry.rowCarrierBytes(), groupCarrierBytes);
+        auto rows = std::max<uint64_t>(1, StreamBlockBytes / geometry.rowStride);
+        return std::max<uint64_t>(step, rows / step * step);
+    }
+
+    auto requireBinarySamples(const ImageLayout& layout) -> void {
+        if (layout.encoding == SampleEncoding::Ascii) {
+            throw std::runtime_error("Plain (ASCII) images change length when encoded and cannot be streamed.");
+        }
+    }
+
+    auto asBytes(const std::string& text) -> std::span<const std::byte> {
+        return std::as_bytes(std::span(text.data(), text.size()));
+    }
+
+    // Carrier bytes needed for the header plus the payload bits.
+    auto requiredCarrierBytes(const Lsb::PayloadHeader& header) -> uint64_t {
+        return Lsb::payloadCarrierOffset(header) + Lsb::carrierBytesFor(header.payloadBytes, header.density());
+    }
+
+    // Throws unless layout has required carrier bytes, all inside the fileSize byte file.
+    auto requireCarrierBytes(const ImageLayout& layout, const uint64_t fileSize, const uint64_t required) -> void {
+        if (required > layout.carrierBytes || layout.pixelDataOffset + layout.geometry.spanBytes(required) > fileSize) {
+            throw std::runtime_error("Message too long to encode in this image.");
+        }
+    }
+
+    // The layout a payload with header is embedded through. Legacy (version 0) headers
+    // keep the flat run of bytes the first releases wrote, so those images stay readable
+    // both ways; the rest skip row padding, alpha and high sample bytes.
+    auto layoutFor(const ImageLayout& layout, const Lsb::PayloadHeader& header, const bool scatter,
+        const uint64_t fileSize) -> ImageLayout {
+        if (header.version > 0 || scatter || layout.encoding == SampleEncoding::Ascii ||
+            layout.geometry.isContiguous()) {
+            return layout;
+        }
+        return flatLayout(layout, layout.pixelDataOffset, fileSize);
+    }
+
+    // Picks the layout the payload in an image was embedded through, with its header;
+    // readHeader(layout) throws when layout holds no valid header. A versioned header read
+    // through the geometry settles it. Otherwise the first legacy layout that holds a
+    // legacy header does, and failing those the geometry's answer stands.
+    template <typename ReadHeader>
+    auto findPayloadLayout(const ImageLayout& layout, const uint64_t fileSize, ReadHeader&& readHeader)
+        -> std::pair<ImageLayout, Lsb::PayloadHeader> {
+        std::optional<Lsb::PayloadHeader> header;
+        std::exception_ptr error;
+        try {
+            header = readHeader(layout);
+        } catch (const std::runtime_error&) {
+            error = std::current_exception();
+        }
+        if (header && (header->version > 0 || layout.geometry.isContiguous())) {
+            return {layout, *header};
+        }
+
+        for (const auto& legacy : legacyLayouts(layout, fileSize)) {
+            try {
+                auto legacyHeader = readHeader(legacy);
+                if (legacyHeader.version == 0) return {legacy, legacyHeader};
+            } catch (const std::runtime_error&) {
+                // Not this one either.
+            }
+        }
+
+        if (!header) {
+            std::rethrow_exception(error);
+        }
+        return {layout, *header};
+    }
+
+    // Writes the header and the keyed payload into carrier, which starts at the pixel data.
+    auto embedMessage(uint8_t* carrier, const Lsb::PayloadHeader& header, std::span<const std::byte> payload,
+        const Crypto::PayloadCipher& cipher, const ParallelOptions& parallel) -> void {
+        Stats::ScopedTimer timer(Stats::Phase::Embed);
+        Stats::add(Stats::Counter::CarrierBytes, requiredCarrierBytes(header));
+
+        Lsb::writeHeader(carrier, header);
+        Lsb::embedWithKey(carrier + Lsb::payloadCarrierOffset(header), reinterpret_cast<const uint8_t*>(payload.data()),
+            payload.size(), cipher, parallel, header.density());
+    }
+
+    // Embeds whatever part of the header and payload falls into bytes [position, position + count)
+    // of the carrier region that starts at the pixel data. position must be a multiple of
+    // the payload's groupCarrierBytes, so it starts a group, and the first range must hold
+    // the header.
+    auto embedCarrierRange(uint8_t* carrier, uint64_t position, size_t count, const Lsb::PayloadHeader& header,
+        std::span<const std::byte> payload, const Crypto::PayloadCipher& cipher) -> void {
+        Stats::ScopedTimer timer(Stats::Phase::Embed);
+        auto payloadOffset = Lsb::payloadCarrierOffset(header);
+        if (position == 0) {
+            Lsb::writeHeader(carrier, header);
+        }
+
+        auto start = std::max<uint64_t>(position, payloadOffset);
+        auto end = position + count;
+        if (start >= end) return;
+
+        auto density = header.density();
+        auto groupBytes = density.groupCarrierBytes();
+        auto groups = (end - start + groupBytes - 1) / groupBytes;
+        auto begin = (start - payloadOffset) / groupBytes * density.groupPayloadBytes();
+        auto n = std::min<uint64_t>(payload.size() - begin, groups * density.groupPayloadBytes());
+
+        Lsb::embedWithKey(carrier + (start - position), reinterpret_cast<const uint8_t*>(payload.data()) + begin,
+            static_cast<size_t>(n), cipher, begin, density);
+        Stats::add(Stats::Counter::CarrierBytes, end - start);
+    }
+
+    auto readStream(std::istream& in, uint8_t* buffer, const size_t count) -> size_t {
+        Stats::ScopedTimer timer(Stats::Phase::Read);
+        in.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(count));
+
+        auto n = static_cast<size_t>(in.gcount());
+        Stats::add(Stats::Counter::BytesRead, n);
+        return n;
+    }
+
+    auto writeStream(std::ostream& out, const uint8_t* buffer, const size_t count) -> void {
+        Stats::ScopedTimer timer(Stats::Phase::Write);
+        out.write(reinterpret_cast<const char*>(buffer), static_cast<std::streamsize>(count));
+        Stats::add(Stats::Counter::BytesWritten, count);
+    }
+
+    // Replays the bytes consumed while parsing the header, then continues with the stream.
+    class StreamReader {
+    public:
+        StreamReader(std::istream& in, std::vector<uint8_t> head) : in(in), head(std::move(head)) {}
+
+        // Reads up to count bytes; fewer only at the end of the stream.
+        auto read(uint8_t* buffer, const size_t count) -> size_t {
+            size_t done = 0;
+            if (position < head.size()) {
+                done = std::min(count, head.size() - position);
+                std::copy_n(head.data() + position, done, buffer);
+                position += done;
+            }
+            if (done < count && in) {
+                done += readStream(in, buffer + done, count - done);
+            }
+            return done;
+        }
+
+        // Copies up to count bytes to out (nullptr discards them) through block.
+        // Returns the number of bytes copied.
+        auto copy(std::ostream* out, const uint64_t count, Memory::Buffer& block) -> uint64_t {
+            uint64_t copied = 0;
+            while (copied < count) {
+                auto n = read(block.data(), static_cast<size_t>(std::min<uint64_t>(block.size(), count - copied)));
+                if (out != nullptr) {
+                    writeStream(*out, block.data(), n);
+                }
+                copied += n;
+                if (n == 0) break;
+            }
+            return copied;
+        }
+
+    private:
+        std::istream& in;
+        std::vector<uint8_t> head;
+        size_t position = 0;
+    };
+
+    // Reads the carrier bytes of payload[begin, begin + count) through scratch and extracts
+    // them into out. begin must start a group.
+    auto readPayload(const CarrierSource& carrier, uint64_t payloadOffset, uint8_t* out, uint64_t begin, size_t count,
+        uint8_t* scratch, size_t scratchBytes, const Crypto::PayloadCipher& cipher, Lsb::Density density) -> void {
+        auto perRead = Lsb::alignedChunkBytes(static_cast<size_t>(Lsb::payloadBytesWithin(scratchBytes, density)), density);
+
+        for (size_t done = 0; done < count;) {
+            auto n = std::min(perRead, count - done);
+            auto carrierBytes = Lsb::carrierBytesFor(n, density);
+            carrier.read(payloadOffset + Lsb::carrierBytesFor(begin + done, density), scratch,
+                static_cast<size_t>(carrierBytes));
+            {
+                Stats::ScopedTimer timer(Stats::Phase::Extract);
+                Lsb::extractBytes(scratch, out + done, n, density);
+            }
+            {
+                Stats::ScopedTimer timer(Stats::Phase::Xor);
+                cipher.apply(out + done, n, begin + done);
+            }
+            Stats::add(Stats::Counter::CarrierBytes, carrierBytes);
+            done += n;
+        }
+    }
+}
+
+auto ISteganographer::open(const std::string& filepath, const File::Mode mode) const -> ImageHandle {
+    auto file = [&] {
+        Stats::ScopedTimer timer(Stats::Phase::Open);
+        return File(filepath, mode);
+    }();
+    auto fileSize = file.size();
+
+    // Nothing outlives the parse, so each thread keeps one head buffer for every image.
+    thread_local std::vector<uint8_t> head;
+    head.clear();
+    auto layout = parseHead(head, fileSize, filepath, [&](uint8_t* buffer, const size_t count) {
+        return file.readAt(static_cast<uint64_t>(buffer - head.data()), buffer, count);
+    });
+
+    return {std::move(file), layout, fileSize};
+}
+
+auto ISteganographer::parseHead(std::vector<uint8_t>& head, const uint64_t fileSize, const std::string& name,
+    const std::function<size_t(uint8_t*, size_t)>& read) const -> ImageLayout {
+    Stats::ScopedTimer timer(Stats::Phase::ParseHeader);
+
+    // Most headers fit in the first read; longer ones (e.g. PPM comments) grow the head.
+    auto target = static_cast<size_t>(std::min<uint64_t>(fileSize, HeaderProbeBytes));
+
+    while (true) {
+        auto loaded = head.size();
+        head.resize(target);
+        auto n = read(head.data() + loaded, target - loaded);
+        head.resize(loaded + n);
+
+        if (auto layout = parseLayout(head, fileSize)) {
+            return *layout;
+        }
+
+        if (head.size() < target || head.size() >= fileSize || target >= MaxHeaderProbeBytes) {
+            throw std::runtime_error("Invalid or truncated image header: " + name);
+        }
+        target = static_cast<size_t>(std::min<uint64_t>(fileSize, target * 2));
+    }
+}
+
+auto ISteganographer::encode(ImageHandle& image, std::span<const std::byte> payload, const std::string& key,
+    const EncodeOptions& options) -> bool {
+    std::vector<std::byte> frame;
+    auto stored = storedPayload(payload, options, frame);
+    if (!canEncode(image, stored.size(), options)) {
+        throw std::runtime_error("Image is too small to encode the message.");
+    }
+
+    if (options.writeMode == WriteMode::InPlace) {
+        return encodeLSBInPlace(image, stored, key, options);
+    }
+
+    return encodeLSB(image, stored, key, options);
+}
+
+auto ISteganographer::canEncode(const ImageHandle& image, const uint64_t payloadBytes,
+    const EncodeOptions& options) const -> bool {
+    auto carrierBytes = image.getLayout().carrierBytes;
+    if (options.scatter) {
+        carrierBytes = Lsb::scatterCapacity(carrierBytes);
+    }
+    return carrierBytes >= requiredCarrierBytes(headerFor(payloadBytes, options));
+}
+
+auto ISteganographer::canEncode(const ImageHandle& image, std::span<const std::byte> payload,
+    const EncodeOptions& options) const -> bool {
+    // Coding only adds parity, whose size is known without doing it.
+    uint64_t storedBytes = payload.size();
+    if (options.compress) {
+        Stats::ScopedTimer timer(Stats::Phase::Compress);
+        storedBytes = Compress::compressFrame(payload).size();
+    }
+    return canEncode(image, Fec::codedBytes(storedBytes, options.fecParity), options);
+}
+
+auto ISteganographer::capacity(const ImageHandle& image, const EncodeOptions& options) const -> uint64_t {
+    auto carrierBytes = image.getLayout().carrierBytes;
+    if (options.scatter) {
+        carrierBytes = Lsb::scatterCapacity(carrierBytes);
+    }
+
+    // Large payloads need the extended header word, so try the answer with either size.
+    uint64_t bytes = 0;
+    for (auto payloadBytes : {uint64_t{0}, Lsb::MaxPayloadBytes}) {
+        auto header = headerFor(payloadBytes, options);
+        auto payloadOffset = Lsb::payloadCarrierOffset(header);
+        if (carrierBytes < payloadOffset) continue;
+
+        auto fits = std::min(Lsb::MaxPayloadBytes, Lsb::payloadBytesWithin(carrierBytes - payloadOffset, header.density()));
+        if (canEncode(image, fits, options)) {
+            bytes = std::max(bytes, fits);
+        }
+    }
+    return Fec::maxDataBytes(bytes, options.fecParity);
+}
+
+auto ISteganographer::storedPayload(std::span<const std::byte> payload, const EncodeOptions& options,
+    std::vector<std::byte>& frame) -> std::span<const std::byte> {
+    if (!options.compress && options.fecParity == 0) return payload;
+
+    if (options.compress) {
+        Stats::ScopedTimer timer(Stats::Phase::Compress);
+        frame = Compress::compressFrame(payload);
+        payload = frame;
+    }
+    if (options.fecParity > 0) {
+        Stats::ScopedTimer timer(Stats::Phase::ErrorCorrection);
+        frame = Fec::encode(payload, options.fecParity);
+    }
+    return frame;
+}
+
+auto ISteganographer::pixelBytesFor(const ImageHandle& image, const uint64_t storedBytes, const std::string& key,
+    const EncodeOptions& options) const -> uint64_t {
+    const auto& layout = image.getLayout();
+    requireBinarySamples(layout);
+
+    // Sized like headerFor(storedBytes, options, key), without drawing a salt.
+    auto header = headerFor(storedBytes, options);
+    if (key.empty()) {
+        header.cipher = Crypto::Cipher::RepeatingKey;
+    }
+    auto required = requiredCarrierBytes(header);
+    auto carrierLayout = layoutFor(layout, header, options.scatter, image.getFileSize());
+    requireCarrierBytes(carrierLayout, image.getFileSize(), required);
+
+    return carrierLayout.geometry.spanBytes(options.scatter ? layout.carrierBytes : required);
+}
+
+auto ISteganographer::embedPixels(const ImageHandle& image, uint8_t* pixels, std::span<const std::byte> stored,
+    const std::string& key, const EncodeOptions& options) const -> void {
+    requireBinarySamples(image.getLayout());
+
+    auto header = headerFor(stored.size(), options, key);
+    auto required = requiredCarrierBytes(header);
+    auto layout = layoutFor(image.getLayout(), header, options.scatter, image.getFileSize());
+    requireCarrierBytes(layout, image.getFileSize(), required);
+    auto cipher = cipherFor(header, key);
+    seal(header, stored, cipher);
+
+    auto carrierBytes = options.scatter ? layout.carrierBytes : required;
+    withCarrierBytes(pixels, layout.geometry, carrierBytes, [&](uint8_t* carrier) {
+        if (options.scatter) {
+            embedScattered(carrier, carrierBytes, header, stored, key, cipher, options.parallel);
+        } else {
+            embedMessage(carrier, header, stored, cipher, options.parallel);
+        }
+    });
+}
+
+auto ISteganographer::decodedSize(const ImageHandle& image, const std::string& key,
+    const DecodeOptions& options) const -> uint64_t {
+    Lsb::PayloadHeader header;
+    auto carrier = openCarrier(image, key, options.scatter, header);
+    return decodedSize(carrier, header, decodingCipherFor(header, key));
+}
+
+auto ISteganographer::decode(const ImageHandle& image, const std::string& key, std::span<std::byte> out,
+    const DecodeOptions& options) -> uint64_t {
+    Lsb::PayloadHeader header;
+    auto carrier = openCarrier(image, key, options.scatter, header);
+    auto cipher = decodingCipherFor(header, key);
+    auto size = decodedSize(carrier, header, cipher);
+    if (out.size() < size) {
+        throw std::runtime_error("Output buffer is too small for the decoded message.");
+    }
+
+    if (!header.compressed && header.fecParity == 0) {
+        decodeLSB(carrier, header, cipher, 0, out.first(static_cast<size_t>(size)), options.parallel);
+        verifyPayload(header, crcOf(out.first(static_cast<size_t>(size))));
+        return size;
+    }
+
+    // Neither decoder ever emits more than the size decodedSize() found.
+    size_t written = 0;
+    decodePayload(carrier, header, cipher, [&](std::span<const std::byte> bytes) {
+        std::copy(bytes.begin(), bytes.end(), out.begin() + static_cast<std::ptrdiff_t>(written));
+        written += bytes.size();
+    }, options.parallel);
+    return size;
+}
+
+auto ISteganographer::decode(const ImageHandle& image, const std::string& key, const PayloadSink& sink,
+    const DecodeOptions& options) -> uint64_t {
+    Lsb::PayloadHeader header;
+    auto carrier = openCarrier(image, key, options.scatter, header);
+    return decodePayload(carrier, header, decodingCipherFor(header, key), sink, options.parallel);
+}
+
+auto ISteganographer::encode(ImageHandle& image, const std::string& message, const std::string& key,
+    const EncodeOptions& options) -> bool {
+    return encode(image, asBytes(message), key, options);
+}
+
+auto ISteganographer::decode(const ImageHandle& image, const std::string& key, const DecodeOptions& options)
+    -> std::string {
+    Lsb::PayloadHeader header;
+    auto carrier = openCarrier(image, key, options.scatter, header);
+    auto cipher = decodingCipherFor(header, key);
+
+    std::string message;
+    if (!header.compressed && header.fecParity == 0) {
+        message.resize(static_cast<size_t>(header.payloadBytes));
+        auto bytes = std::as_writable_bytes(std::span(message.data(), message.size()));
+        decodeLSB(carrier, header, cipher, 0, bytes, options.parallel);
+        verifyPayload(header, crcOf(bytes));
+        return message;
+    }
+
+    message.reserve(static_cast<size_t>(
+        std::min(decodedSize(carrier, header, cipher), header.payloadBytes * MaxExpansion)));
+    decodePayload(carrier, header, cipher, [&](std::span<const std::byte> bytes) {
+        message.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }, options.parallel);
+    return message;
+}
 
-    if (pixelDataOffset + bitMessage.size() > buffer.size()) {
+auto ISteganographer::canEncode(const ImageHandle& image, const std::string& message,
+    const EncodeOptions& options) const -> bool {
+    return canEncode(image, asBytes(message), options);
+}
+
+auto ISteganographer::getImageDimensions(const ImageHandle& image) const -> std::pair<int, int> {
+    return {image.getLayout().width, image.getLayout().height};
+}
+
+auto ISteganographer::encode(const std::string& filepath, const std::string& message, const std::string& key,
+    const EncodeOptions& options) -> bool {
+    auto image = open(filepath, File::Mode::ReadWrite);
+    return encode(image, message, key, options);
+}
+
+auto ISteganographer::encode(const std::string& filepath, const std::string& message, const std::string& key) -> bool {
+    return encode(filepath, message, key, EncodeOptions{});
+}
+
+auto ISteganographer::decode(const std::string& filepath, const std::string& key, const DecodeOptions& options)
+    -> std::string {
+    auto image = open(filepath);
+    return decode(image, key, options);
+}
+
+auto ISteganographer::canEncode(const std::string& filepath, const std::string& message,
+    const EncodeOptions& options) const -> bool {
+    return canEncode(open(filepath), message, options);
+}
+
+auto ISteganographer::canEncode(const std::string& filepath, const std::string& message) const -> bool {
+    return canEncode(filepath, message, EncodeOptions{});
+}
+
+auto ISteganographer::getImageDimensions(const std::string& filepath) const -> std::pair<int, int> {
+    return getImageDimensions(open(filepath));
+}
+
+auto ISteganographer::encodeLSB(ImageHandle& image, std::span<const std::byte> payload, const std::string& key,
+    const EncodeOptions& options) -> bool {
+    if (image.getLayout().encoding == SampleEncoding::Ascii) {
+        return encodeAscii(image, payload, key, options);
+    }
+
+    auto header = headerFor(payload.size(), options, key);
+    auto required = requiredCarrierBytes(header);
+    auto layout = layoutFor(image.getLayout(), header, options.scatter, image.getFileSize());
+    requireCarrierBytes(layout, image.getFileSize(), required);
+    auto cipher = cipherFor(header, key);
+    seal(header, payload, cipher);
+
+    auto& file = image.getFile();
+    Memory::Buffer buffer(static_cast<size_t>(image.getFileSize()));
+    {
+        Stats::ScopedTimer timer(Stats::Phase::Read);
+        file.readExactAt(0, buffer.data(), buffer.size());
+    }
+
+    auto* pixels = buffer.data() + layout.pixelDataOffset;
+    if (options.scatter) {
+        withCarrierBytes(pixels, layout.geometry, layout.carrierBytes, [&](uint8_t* carrier) {
+            embedScattered(carrier, layout.carrierBytes, header, payload, key, cipher, options.parallel);
+        });
+    } else {
+        withCarrierBytes(pixels, layout.geometry, required, [&](uint8_t* carrier) {
+            embedMessage(carrier, header, payload, cipher, options.parallel);
+        });
+    }
+
+    {
+        Stats::ScopedTimer timer(Stats::Phase::Write);
+        file.writeAt(0, buffer.data(), buffer.size());
+    }
+    if (options.flushPolicy == FlushPolicy::Sync) {
+        Stats::ScopedTimer timer(Stats::Phase::Flush);
+        file.sync();
+    }
+
+    return true;
+}
+
+auto ISteganographer::encodeLSBInPlace(ImageHandle& image, std::span<const std::byte> payload,
+    const std::string& key, const EncodeOptions& options) -> bool {
+    if (image.getLayout().encoding == SampleEncoding::Ascii) {
+        return encodeAscii(image, payload, key, options);
+    }
+
+    auto header = headerFor(payload.size(), options, key);
+    auto required = requiredCarrierBytes(header);
+    auto layout = layoutFor(image.getLayout(), header, options.scatter, image.getFileSize());
+    requireCarrierBytes(layout, image.getFileSize(), required);
+    auto cipher = cipherFor(header, key);
+    seal(header, payload, cipher);
+
+    // Only the prefix and payload bytes are mapped, so the pages dirtied (and later
+    // written back) scale with the message, not with the image. Scattered bytes can land
+    // anywhere in the pixel data, so scatter mode maps all of it.
+    auto carrierBytes = options.scatter ? layout.carrierBytes : required;
+    auto mappedBytes = layout.geometry.spanBytes(carrierBytes);
+    auto mapping = [&] {
+        Stats::ScopedTimer timer(Stats::Phase::Map);
+        return MappedFile(image.getFile(), layout.pixelDataOffset, static_cast<size_t>(mappedBytes));
+    }();
+    withCarrierBytes(mapping.data(), layout.geometry, carrierBytes, [&](uint8_t* carrier) {
+        if (options.scatter) {
+            embedScattered(carrier, carrierBytes, header, payload, key, cipher, options.parallel);
+        } else {
+            embedMessage(carrier, header, payload, cipher, options.parallel);
+        }
+    });
+
+    // The dirty pages reach the file through the mapping rather than write calls.
+    Stats::add(Stats::Counter::BytesWritten, layout.geometry.spanBytes(required));
+    {
+        Stats::ScopedTimer timer(Stats::Phase::Flush);
+        mapping.flush(options.flushPolicy);
+    }
+
+    return true;
+}
+
+auto ISteganographer::encodeAscii(ImageHandle& image, std::span<const std::byte> payload, const std::string& key,
+    const EncodeOptions& options) -> bool {
+    const auto& layout = image.getLayout();
+    auto header = headerFor(payload.size(), options, key);
+    auto required = requiredCarrierBytes(header);
+    if (required > layout.carrierBytes) {
         throw std::runtime_error("Message too long to encode in this image.");
     }
+    auto cipher = cipherFor(header, key);
+    seal(header, payload, cipher);
+
+    auto& file = image.getFile();
+    std::string text(static_cast<size_t>(image.getFileSize()), '\0');
+    {
+        Stats::ScopedTimer timer(Stats::Phase::Read);
+        file.readExactAt(0, text.data(), text.size());
+    }
 
-    for (size_t i = 0; i < bitMessage.size(); i++) {
-        buffer[pixelDataOffset + i] = Utils::setLSB(static_cast<uint8_t>(buffer[pixelDataOffset + i]), bitMessage[i]);
+    std::vector<uint16_t> samples(static_cast<size_t>(layout.carrierBytes));
+    std::vector<uint8_t> carrier(samples.size());
+    {
+        Stats::ScopedTimer timer(Stats::Phase::Read);
+        Lsb::parseDecimalSamples(std::string_view(text).substr(layout.pixelDataOffset), samples);
+        for (size_t i = 0; i < samples.size(); i++) carrier[i] = static_cast<uint8_t>(samples[i]);
     }
 
-    std::ofstream out(filepath, std::ios::binary | std::ios::trunc);
-    if (!out.is_open()) {
-        throw std::runtime_error("Failed to open file for writing: " + filepath);
+    if (options.scatter) {
+        embedScattered(carrier.data(), carrier.size(), header, payload, key, cipher, options.parallel);
+    } else {
+        embedMessage(carrier.data(), header, payload, cipher, options.parallel);
     }
 
-    out.write(buffer.data(), buffer.size());
-    out.close();
+    // The header is kept byte for byte; the raster is re-emitted and may change length.
+    {
+        Stats::ScopedTimer timer(Stats::Phase::Write);
+        for (size_t i = 0; i < samples.size(); i++) {
+            samples[i] = static_cast<uint16_t>((samples[i] & 0xFF00) | carrier[i]);
+        }
+        text.resize(static_cast<size_t>(layout.pixelDataOffset));
+        Lsb::appendDecimalSamples(samples, text);
+
+        file.writeAt(0, text.data(), text.size());
+        file.resize(text.size());
+        image.setFileSize(text.size());
+    }
+    if (options.flushPolicy == FlushPolicy::Sync) {
+        Stats::ScopedTimer timer(Stats::Phase::Flush);
+        file.sync();
+    }
 
     return true;
 }
 
-auto ISteganographer::decodeLSB(const std::vector<char>& buffer, size_t pixelDataOffset, const std::string& key) -> std::string {
-    if (pixelDataOffset + 32 > buffer.size()) {
+auto ISteganographer::embedScattered(uint8_t* carrier, const uint64_t carrierBytes,
+    const Lsb::PayloadHeader& header, std::span<const std::byte> payload, const std::string& key,
+    const Crypto::PayloadCipher& cipher, const ParallelOptions& parallel) const -> void {
+    Lsb::ScatterPermutation permutation(carrierBytes / Lsb::ScatterGroupBytes, key);
+
+    // Each task gathers a slice of the logical carrier stream into scratch, embeds it with
+    // the sequential kernels and scatters it back to the same groups. The permutation is
+    // a bijection, so no two tasks ever touch the same carrier byte. Slices are whole
+    // groups of the payload, which are themselves whole scatter groups.
+    auto required = requiredCarrierBytes(header);
+    auto groupBytes = header.density().groupCarrierBytes();
+    auto chunkBytes = ScatterChunkBytes / groupBytes * groupBytes;
+    auto chunks = static_cast<size_t>((required + chunkBytes - 1) / chunkBytes);
+    auto* stats = Stats::active();
+    auto embedChunk = [&](const size_t chunk) {
+        Stats::Session session(stats);
+        auto position = static_cast<uint64_t>(chunk) * chunkBytes;
+        auto n = static_cast<size_t>(std::min<uint64_t>(chunkBytes, required - position));
+
+        auto groupCount = static_cast<size_t>(Lsb::scatterGroupsFor(n));
+        Memory::Buffer groupBuffer(groupCount * sizeof(uint64_t));
+        auto* groups = groupBuffer.as<uint64_t>();
+        Memory::Buffer scratch(n);
+        {
+            Stats::ScopedTimer timer(Stats::Phase::Read);
+            permutation.map(position / Lsb::ScatterGroupBytes, groups, groupCount);
+            Lsb::gather(carrier, groups, scratch.data(), n);
+        }
+        embedCarrierRange(scratch.data(), position, n, header, payload, cipher);
+        {
+            Stats::ScopedTimer timer(Stats::Phase::Write);
+            Lsb::scatter(carrier, groups, scratch.data(), n);
+        }
+    };
+
+    if (chunks <= 1 || parallel.threadCount == 1 || required < parallel.thresholdBytes) {
+        for (size_t chunk = 0; chunk < chunks; chunk++) embedChunk(chunk);
+    } else {
+        ThreadPool::shared().parallelFor(chunks, parallel.threadCount, embedChunk);
+    }
+}
+
+auto ISteganographer::openCarrier(const ImageHandle& image, const std::string& key, const bool scatter,
+    Lsb::PayloadHeader& header) const -> CarrierSource {
+    // Scattered and plain payloads never used the flat layout, and gathering them twice
+    // would cost a pass over the pixel data.
+    const auto& layout = image.getLayout();
+    if (scatter || layout.encoding == SampleEncoding::Ascii) {
+        CarrierSource carrier(image, layout, key, scatter);
+        header = readPayloadHeader(carrier);
+        return carrier;
+    }
+
+    auto [carrierLayout, found] = findPayloadLayout(layout, image.getFileSize(), [&](const ImageLayout& candidate) {
+        return readPayloadHeader(CarrierSource(image, candidate, key, false));
+    });
+    header = found;
+    return {image, carrierLayout, key, false};
+}
+
+auto ISteganographer::readPayloadHeader(const CarrierSource& carrier) const -> Lsb::PayloadHeader {
+    auto carrierSize = carrier.size();
+    if (Lsb::HeaderWordBits > carrierSize) {
         throw std::runtime_error("File is corrupted or too small for a valid encoded message.");
     }
 
-    std::string lengthBits;
-    for (int i = 0; i < 32; i++) {
-        auto bit = (buffer[pixelDataOffset + i] & 1) ? '1' : '0';
-        lengthBits += bit;
+    // One read covers the header whether or not it carries the extended length word.
+    uint8_t bytes[Lsb::MaxHeaderCarrierBytes];
+    auto available = static_cast<size_t>(std::min<uint64_t>(sizeof(bytes), carrierSize));
+    {
+        Stats::ScopedTimer timer(Stats::Phase::ParseHeader);
+        carrier.read(0, bytes, available);
     }
 
-    auto length = std::bitset<32>(lengthBits).to_ulong();
-    if (length == 0 || pixelDataOffset + 32 + length > buffer.size()) {
+    auto header = Lsb::readHeader(bytes, available);
+    if (!header || header->payloadBytes == 0 || requiredCarrierBytes(*header) > carrierSize) {
         throw std::runtime_error("Invalid or corrupted encoded message length.");
     }
 
-    std::string messageBits;
-    for (size_t i = 0; i < length; i++) {
-        auto bit = (buffer[pixelDataOffset + 32 + i] & 1) ? '1' : '0';
-        messageBits += bit;
+    return *header;
+}
+
+auto ISteganographer::decodeLSB(const CarrierSource& carrier, const Lsb::PayloadHeader& header,
+    const Crypto::PayloadCipher& cipher, const uint64_t begin, std::span<std::byte> out,
+    const ParallelOptions& parallel) const -> void {
+    auto* payload = reinterpret_cast<uint8_t*>(out.data());
+    auto density = header.density();
+
+    // Only the payload's carrier bytes are read. Large payloads are split into
+    // independent chunks that read and extract in parallel.
+    auto payloadOffset = Lsb::payloadCarrierOffset(header);
+    auto chunks = Lsb::parallelChunkCount(out.size(), parallel, density);
+
+    if (chunks <= 1) {
+        uint8_t scratch[DecodeChunkBytes];
+        readPayload(carrier, payloadOffset, payload, begin, out.size(), scratch, sizeof(scratch), cipher, density);
+    } else {
+        auto chunkBytes = Lsb::parallelChunkBytes(density);
+        auto* stats = Stats::active();
+        ThreadPool::shared().parallelFor(chunks, parallel.threadCount, [&](const size_t chunk) {
+            Stats::Session session(stats);
+            auto offset = chunk * chunkBytes;
+            auto count = std::min(chunkBytes, out.size() - offset);
+
+            Memory::Buffer scratch(DecodeChunkBytes);
+            readPayload(carrier, payloadOffset, payload + offset, begin + offset, count, scratch.data(), scratch.size(),
+                cipher, density);
+        });
+    }
+}
+
+auto ISteganographer::decodePayload(const CarrierSource& carrier, const Lsb::PayloadHeader& header,
+    const Crypto::PayloadCipher& cipher, const PayloadSink& sink, const ParallelOptions& parallel) const -> uint64_t {
+    // Coded bytes are corrected a group at a time and a compressed frame is decompressed
+    // a block at a time, so neither decoder holds more than that.
+    std::optional<Fec::Decoder> corrector;
+    if (header.fecParity > 0) {
+        corrector.emplace(header.payloadBytes, header.fecParity);
+    }
+    Compress::FrameDecoder decoder;
+    uint32_t crc = 0;
+    auto decompressBytes = [&](std::span<const std::byte> bytes) {
+        crc = crcOf(bytes, crc);
+        if (header.compressed) {
+            decoder.feed(bytes, sink);
+        } else {
+            sink(bytes);
+        }
+    };
+    // Held by reference, which std::function stores without allocating.
+    Fec::Decoder::Emit decompress = std::ref(decompressBytes);
+    auto emit = [&](std::span<const std::byte> bytes) {
+        if (corrector) {
+            corrector->feed(bytes, decompress);
+        } else {
+            decompress(bytes);
+        }
+    };
+
+    // The window stays a whole number of groups, so every slice starts on a carrier
+    // byte boundary and still splits across threads.
+    auto windowBytes = Lsb::alignedChunkBytes(SinkWindowBytes, header.density());
+    Memory::Buffer window(static_cast<size_t>(std::min<uint64_t>(windowBytes, header.payloadBytes)));
+
+    for (uint64_t done = 0; done < header.payloadBytes;) {
+        auto n = static_cast<size_t>(std::min<uint64_t>(window.size(), header.payloadBytes - done));
+        auto slice = window.bytes().first(n);
+
+        decodeLSB(carrier, header, cipher, done, slice, parallel);
+        emit(slice);
+        done += n;
     }
 
-    messageBits = Utils::xorString(messageBits, key);
-    return Utils::bitStringToText(messageBits);
+    if (corrector) {
+        corrector->finish();
+    }
+    verifyPayload(header, crc);
+    if (!header.compressed) {
+        return *Fec::dataBytes(header.payloadBytes, header.fecParity);
+    }
+    decoder.finish();
+    return *decoder.rawSize();
 }
 
-auto ISteganographer::canEncodeWithDimensions(int width, int height, const std::string& message) -> bool {
-    auto availableBits = static_cast<long long>(width * height) * 3;
-    auto messageBits = Utils::textToBitString(message).length();
+auto ISteganographer::decodedSize(const CarrierSource& carrier, const Lsb::PayloadHeader& header,
+    const Crypto::PayloadCipher& cipher) const -> uint64_t {
+    auto storedBytes = *Fec::dataBytes(header.payloadBytes, header.fecParity);
+    if (!header.compressed) {
+        return storedBytes;
+    }
+    if (storedBytes < Compress::FrameHeaderBytes) {
+        throw std::runtime_error("Corrupted compressed payload.");
+    }
 
-    return availableBits >= messageBits + 32;
+    std::array<std::byte, Compress::FrameHeaderBytes> frameHeader;
+    if (header.fecParity == 0) {
+        decodeLSB(carrier, header, cipher, 0, frameHeader, {});
+        return Compress::FrameDecoder::readRawSize(frameHeader);
+    }
+
+    // The frame header sits in the first group, which has to be corrected as a whole.
+    Memory::Buffer group(
+        static_cast<size_t>(std::min<uint64_t>(header.payloadBytes, Fec::CodewordBytes * Fec::InterleaveCodewords)));
+    decodeLSB(carrier, header, cipher, 0, group.bytes(), {});
+    // The decode proper corrects this group again, so only it counts the corrections.
+    Stats::Session quiet(nullptr);
+    Fec::Decoder corrector(header.payloadBytes, header.fecParity);
+    corrector.feed(group.bytes(), [&](std::span<const std::byte> bytes) {
+        std::copy_n(bytes.begin(), frameHeader.size(), frameHeader.begin());
+    });
+    return Compress::FrameDecoder::readRawSize(frameHeader);
+}
+
+auto ISteganographer::encodeStream(std::istream& in, std::ostream& out, std::span<const std::byte> payload,
+    const std::string& key, const EncodeOptions& options) const -> bool {
+    if (options.scatter) {
+        throw std::runtime_error("Scatter mode needs random access to the image and cannot encode a stream.");
+    }
+
+    std::vector<uint8_t> head;
+    auto layout = parseHead(head, UnknownSize, "<stream>", [&](uint8_t* buffer, const size_t count) {
+        return readStream(in, buffer, count);
+    });
+    requireBinarySamples(layout);
+
+    std::vector<std::byte> frame;
+    payload = storedPayload(payload, options, frame);
+    auto header = headerFor(payload.size(), options, key);
+    auto required = requiredCarrierBytes(header);
+    layout = layoutFor(layout, header, false, UnknownSize);
+    if (layout.carrierBytes < required) {
+        throw std::runtime_error("Image is too small to encode the message.");
+    }
+    auto cipher = cipherFor(header, key);
+    seal(header, payload, cipher);
+
+    const auto& geometry = layout.geometry;
+    auto rows = streamBlockRows(geometry, header.density().groupCarrierBytes());
+    auto blockCarrierBytes = rows * geometry.rowCarrierBytes();
+
+    StreamReader reader(in, std::move(head));
+    Memory::Buffer block(static_cast<size_t>(rows * geometry.rowStride));
+
+    if (reader.copy(&out, layout.pixelDataOffset, block) < layout.pixelDataOffset) {
+        throw std::runtime_error("Carrier ended before its pixel data.");
+    }
+
+    // Only the rows that hold the header and payload are modified; the last block stops
+    // after the last carrier byte and the rest of the image passes straight through.
+    for (uint64_t position = 0; position < required; position += blockCarrierBytes) {
+        auto n = std::min(blockCarrierBytes, required - position);
+        auto fileBytes = static_cast<size_t>(position + n < required
+            ? block.size()
+            : geometry.spanBytes(required) - geometry.rowOffset(position));
+        if (reader.read(block.data(), fileBytes) < fileBytes) {
+            throw std::runtime_error("Carrier ended before the message was embedded.");
+        }
+
+        withCarrierBytes(block.data(), geometry, n, [&](uint8_t* carrier) {
+            embedCarrierRange(carrier, position, static_cast<size_t>(n), header, payload, cipher);
+        });
+        writeStream(out, block.data(), fileBytes);
+    }
+
+    reader.copy(&out, UnknownSize, block);
+    if (!out.flush()) {
+        throw std::runtime_error("Failed to write the encoded image.");
+    }
+
+    return true;
+}
+
+auto ISteganographer::decodeStream(std::istream& in, const std::string& key, const PayloadSink& sink) const
+    -> uint64_t {
+    std::vector<uint8_t> head;
+    auto layout = parseHead(head, UnknownSize, "<stream>", [&](uint8_t* buffer, const size_t count) {
+        return readStream(in, buffer, count);
+    });
+    requireBinarySamples(layout);
+
+    // Which layout the payload went through shows in its header, so enough pixel data for
+    // the header in any of them is read ahead; the reader replays it below.
+    auto headerSpan = [](const ImageLayout& candidate) {
+        return candidate.pixelDataOffset +
+            candidate.geometry.spanBytes(std::min<uint64_t>(Lsb::MaxHeaderCarrierBytes, candidate.carrierBytes));
+    };
+    auto needed = headerSpan(layout);
+    for (const auto& legacy : legacyLayouts(layout, UnknownSize)) {
+        needed = std::max(needed, headerSpan(legacy));
+    }
+    if (head.size() < needed) {
+        auto loaded = head.size();
+        head.resize(static_cast<size_t>(needed));
+        head.resize(loaded + readStream(in, head.data() + loaded, head.size() - loaded));
+    }
+
+    layout = findPayloadLayout(layout, UnknownSize, [&](const ImageLayout& candidate) {
+        auto dataBytes = head.size() > candidate.pixelDataOffset ? head.size() - candidate.pixelDataOffset : 0;
+        std::array<uint8_t, Lsb::MaxHeaderCarrierBytes> carrier;
+        auto available = static_cast<size_t>(std::min<uint64_t>(
+            {carrier.size(), candidate.carrierBytes, candidate.geometry.carrierBytesWithin(dataBytes)}));
+        std::optional<Lsb::PayloadHeader> header;
+        if (available > 0) {
+            Lsb::loadCarrier(head.data() + candidate.pixelDataOffset, candidate.geometry, 0, carrier.data(), available);
+            header = Lsb::readHeader(carrier.data(), available);
+        }
+        if (!header || header->payloadBytes == 0 || requiredCarrierBytes(*header) > candidate.carrierBytes) {
+            throw std::runtime_error("Invalid or corrupted encoded message length.");
+        }
+        return *header;
+    }).first;
+
+    StreamReader reader(in, std::move(head));
+    Memory::Buffer block(StreamBlockBytes);
+
+    if (reader.copy(nullptr, layout.pixelDataOffset, block) < layout.pixelDataOffset) {
+        throw std::runtime_error("File is corrupted or too small for a valid encoded message.");
+    }
+
+    // Unless the carrier bytes are contiguous, they are gathered a row at a time; whatever
+    // a read leaves of a row waits for the next one.
+    const auto& geometry = layout.geometry;
+    auto contiguous = geometry.isContiguous();
+    Memory::Buffer row(contiguous ? 0 : static_cast<size_t>(geometry.rowStride));
+    Memory::Buffer rowCarrier(contiguous ? 0 : static_cast<size_t>(geometry.rowCarrierBytes()));
+    size_t rowAvailable = 0;
+    size_t rowPosition = 0;
+    auto readCarrier = [&](uint8_t* out, const size_t count) -> size_t {
+        if (contiguous) return reader.read(out, count);
+
+        size_t done = 0;
+        while (done < count) {
+            if (rowPosition == rowAvailable) {
+                auto n = reader.read(row.data(), row.size());
+                rowAvailable = static_cast<size_t>(std::min<uint64_t>(rowCarrier.size(), geometry.carrierBytesWithin(n)));
+                rowPosition = 0;
+                if (rowAvailable == 0) break;
+                Lsb::loadCarrier(row.data(), geometry, 0, rowCarrier.data(), rowAvailable);
+            }
+
+            auto n = std::min(count - done, rowAvailable - rowPosition);
+            std::copy_n(rowCarrier.data() + rowPosition, n, out + done);
+            rowPosition += n;
+            done += n;
+        }
+        return done;
+    };
+
+    // The header is read at the largest size it can have, since a damaged one only shows
+    // its size once all its copies are in; the payload bytes read with it come first below.
+    std::array<uint8_t, Lsb::MaxHeaderCarrierBytes> headerCarrier;
+    auto available = readCarrier(headerCarrier.data(),
+        static_cast<size_t>(std::min<uint64_t>(headerCarrier.size(), layout.carrierBytes)));
+    auto header = Lsb::readHeader(headerCarrier.data(), available);
+    if (!header || header->payloadBytes == 0 || requiredCarrierBytes(*header) > layout.carrierBytes) {
+        throw std::runtime_error("Invalid or corrupted encoded message length.");
+    }
+
+    // A matrix payload starts on a whole group, which may lie past the bytes read so far.
+    auto payloadOffset = Lsb::payloadCarrierOffset(*header);
+    auto leftover = std::span(headerCarrier).first(available).subspan(std::min<uint64_t>(payloadOffset, available));
+    if (payloadOffset > available) {
+        auto padding = static_cast<size_t>(payloadOffset - available);
+        if (readCarrier(block.data(), padding) < padding) {
+            throw std::runtime_error("Invalid or corrupted encoded message length.");
+        }
+    }
+    auto readPayloadCarrier = [&](uint8_t* out, const size_t count) -> size_t {
+        auto n = std::min(count, leftover.size());
+        std::copy_n(leftover.begin(), n, out);
+        leftover = leftover.subspan(n);
+        return n < count ? n + readCarrier(out + n, count - n) : n;
+    };
+
+    auto density = header->density();
+    auto cipher = decodingCipherFor(*header, key);
+    Memory::Buffer window(Lsb::alignedChunkBytes(static_cast<size_t>(Lsb::payloadBytesWithin(block.size(), density)), density));
+    std::optional<Fec::Decoder> corrector;
+    if (header->fecParity > 0) {
+        corrector.emplace(header->payloadBytes, header->fecParity);
+    }
+    Compress::FrameDecoder decoder;
+    uint32_t crc = 0;
+    auto decompressBytes = [&](std::span<const std::byte> bytes) {
+        crc = crcOf(bytes, crc);
+        if (header->compressed) {
+            decoder.feed(bytes, sink);
+        } else {
+            sink(bytes);
+        }
+    };
+    // Held by reference, which std::function stores without allocating.
+    Fec::Decoder::Emit decompress = std::ref(decompressBytes);
+
+    for (uint64_t done = 0; done < header->payloadBytes;) {
+        auto n = static_cast<size_t>(std::min<uint64_t>(window.size(), header->payloadBytes - done));
+        auto carrierBytes = static_cast<size_t>(Lsb::carrierBytesFor(n, density));
+        if (readPayloadCarrier(block.data(), carrierBytes) < carrierBytes) {
+            throw std::runtime_error("Invalid or corrupted encoded message length.");
+        }
+
+        {
+            Stats::ScopedTimer timer(Stats::Phase::Extract);
+            Lsb::extractBytes(block.data(), window.data(), n, density);
+        }
+        {
+            Stats::ScopedTimer timer(Stats::Phase::Xor);
+            cipher.apply(window.data(), n, done);
+        }
+        Stats::add(Stats::Counter::CarrierBytes, carrierBytes);
+        auto bytes = std::as_bytes(std::span(window.data(), n));
+        if (corrector) {
+            corrector->feed(bytes, decompress);
+        } else {
+            decompress(bytes);
+        }
+        done += n;
+    }
+
+    if (corrector) {
+        corrector->finish();
+    }
+    verifyPayload(*header, crc);
+    if (!header->compressed) {
+        return *Fec::dataBytes(header->payloadBytes, header->fecParity);
+    }
+    decoder.finish();
+    return *decoder.rawSize();
 }
@@ -0,0 +1,67 @@
+#include "steganography/ImageHandle.h"
+
+#include <algorithm>
+#include <utility>
+
+auto flatLayout(const ImageLayout& layout, const uint64_t offset, const uint64_t fileSize) -> ImageLayout {
+    auto flat = layout;
+    flat.pixelDataOffset = offset;
+
+    // One byte per pixel in rows as long as the image's, so streaming keeps its block size.
+    auto& geometry = flat.geometry;
+    geometry.width = std::max<uint64_t>(layout.geometry.rowStride, 1);
+    geometry.rowStride = geometry.width;
+    geometry.pixelBytes = 1;
+    geometry.channels = 1;
+    geometry.channelStride = 1;
+    geometry.firstChannel = 0;
+
+    auto end = std::min(fileSize,
+        layout.pixelDataOffset + layout.geometry.rowStride * static_cast<uint64_t>(layout.height));
+    flat.carrierBytes = end > offset ? end - offset : 0;
+    return flat;
+}
+
+auto legacyLayouts(const ImageLayout& layout, const uint64_t fileSize) -> std::vector<ImageLayout> {
+    std::vector<ImageLayout> layouts;
+    if (layout.encoding == SampleEncoding::Ascii) return layouts;
+
+    if (!layout.geometry.isContiguous()) {
+        layouts.push_back(flatLayout(layout, layout.pixelDataOffset, fileSize));
+    }
+    if (layout.legacyDataOffset != 0 && layout.legacyDataOffset != layout.pixelDataOffset) {
+        layouts.push_back(flatLayout(layout, layout.legacyDataOffset, fileSize));
+    }
+    return layouts;
+}
+
+ImageHandle::ImageHandle(File file, const ImageLayout& layout, const uint64_t fileSize)
+    : file(std::move(file)), layout(layout), fileSize(fileSize) {}
+
+auto ImageHandle::getFile() -> File& {
+    return file;
+}
+
+auto ImageHandle::getFile() const -> const File& {
+    return file;
+}
+
+auto ImageHandle::getLayout() const -> const ImageLayout& {
+    return layout;
+}
+
+auto ImageHandle::getPath() const -> const std::string& {
+    return file.getPath();
+}
+
+auto ImageHandle::getFileSize() const -> uint64_t {
+    return fileSize;
+}
+
+auto ImageHandle::isWritable() const -> bool {
+    return file.isWritable();
+}
+
+auto ImageHandle::setFileSize(const uint64_t size) -> void {
+    fileSize = size;
+}
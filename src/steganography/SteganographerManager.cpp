@@ -6,6 +6,8 @@
 SteganographerManager::SteganographerManager() {}
 
 auto SteganographerManager::getSteganographer(const Utils::ImageFormat format) -> ISteganographer* {
+  std::lock_guard lock(mutex);
+
   const auto& it = steganographers.find(format);
   if (it != steganographers.end()) {
     return it->second;
@@ -1,5 +1,6 @@
 #include "steganography/Utils.h"
 
+#include <algorithm>
 #include <bitset>
 #include <filesystem>
 #include <fmt/ostream.h>
@@ -9,7 +10,7 @@ namespace Utils {
     auto ext = filename.substr(filename.find_last_of(".") + 1);
 
     if (ext == "bmp") return ImageFormat::BMP;
-    if (ext == "ppm") return ImageFormat::PPM;
+    if (ext == "ppm" || ext == "pgm" || ext == "pnm") return ImageFormat::PPM;
     return ImageFormat::NOT_SUPPORTED;
   }
 
@@ -47,9 +48,56 @@ namespace Utils {
     }
   }
 
-  auto hasWritePermission(const std::string &filepath) -> bool {
-    std::ofstream file(filepath, std::ios::app);
-    return file.is_open();
+  auto collectImages(const std::vector<std::string>& paths, std::vector<PathFailure>& failures)
+      -> std::vector<std::string> {
+    std::vector<std::string> images;
+    for (const auto& path : paths) {
+      std::error_code error;
+      if (!std::filesystem::is_directory(path, error)) {
+        images.push_back(path);
+        continue;
+      }
+
+      for (std::filesystem::recursive_directory_iterator it(path, error), end; !error && it != end;
+           it.increment(error)) {
+        if (!it->is_regular_file()) continue;
+
+        auto image = it->path().string();
+        if (getImageFormat(image) != ImageFormat::NOT_SUPPORTED) {
+          images.push_back(std::move(image));
+        }
+      }
+      if (error) {
+        failures.push_back({path, "Cannot scan directory: " + error.message()});
+      }
+    }
+
+    std::ranges::sort(images);
+    images.erase(std::unique(images.begin(), images.end()), images.end());
+    return images;
+  }
+
+  auto jsonEscape(const std::string& text) -> std::string {
+    std::string escaped;
+    escaped.reserve(text.size());
+
+    for (unsigned char c : text) {
+      switch (c) {
+        case '"': escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\r': escaped += "\\r"; break;
+        case '\t': escaped += "\\t"; break;
+        default:
+          if (c < 0x20) {
+            escaped += fmt::format("\\u{:04x}", c);
+          } else {
+            escaped += static_cast<char>(c);
+          }
+      }
+    }
+
+    return escaped;
   }
 
   auto textToBitString(const std::string &message) -> std::string {
@@ -80,8 +128,6 @@ namespace Utils {
       result += c;
     }
 
-    result.erase(std::ranges::find(result, '\0'), result.end());
-
     return result;
   }
 
@@ -1,93 +1,135 @@
 #include "steganography/bmp/BmpSteganographer.h"
 #include "steganography/Utils.h"
 
-#include <bitset>
+#include <algorithm>
 #include <cstdint>
-#include <fstream>
-#include <iostream>
-#include <vector>
+#include <cstdlib>
 #include <stdexcept>
 
 namespace {
-    auto readDimensions(std::ifstream& file) -> std::pair<int, int> {
-        file.seekg(18);
-        if (file.fail()) {
-            throw std::runtime_error("Failed to seek to BMP width/height fields.");
-        }
+    constexpr size_t FileHeaderBytes = 14;
+    // BITMAPCOREHEADER; every later DIB header starts like BITMAPINFOHEADER.
+    constexpr uint32_t CoreHeaderBytes = 12;
+    constexpr uint32_t InfoHeaderBytes = 40;
 
-        int32_t w = 0, h = 0;
-        file.read(reinterpret_cast<char*>(&w), sizeof(w));
-        file.read(reinterpret_cast<char*>(&h), sizeof(h));
+    constexpr uint32_t CompressionRgb = 0;
+    constexpr uint32_t CompressionBitfields = 3;
+    constexpr uint32_t CompressionAlphaBitfields = 6;
 
-        if (file.fail()) {
-            throw std::runtime_error("Failed to read BMP dimensions.");
-        }
+    [[noreturn]] auto unsupported(const std::string& reason) -> void {
+        throw std::runtime_error("Unsupported BMP: " + reason + ".");
+    }
 
-        return {w, std::abs(h)};
+    auto readLittleEndian16(std::span<const uint8_t> bytes, size_t offset) -> uint32_t {
+        return bytes[offset] | (bytes[offset + 1] << 8);
     }
-}
 
-auto BmpSteganographer::getImageDimensions(const std::string& filepath) -> std::pair<int, int> {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file: " + filepath);
+    auto readLittleEndian32(std::span<const uint8_t> bytes, size_t offset) -> uint32_t {
+        return bytes[offset] | (bytes[offset + 1] << 8) | (bytes[offset + 2] << 16) |
+            (static_cast<uint32_t>(bytes[offset + 3]) << 24);
     }
 
-    return readDimensions(file);
+    // The first of the three bytes of a 32-bit pixel that hold colour, from the red, green
+    // and blue masks; the fourth byte, alpha or unused, is never a carrier byte.
+    auto firstColorByte(const uint32_t colorMask) -> int {
+        if (colorMask == 0x00FFFFFF) return 0;
+        if (colorMask == 0xFFFFFF00) return 1;
+        unsupported("32-bit channel masks must be whole bytes");
+    }
 }
 
-auto BmpSteganographer::encode(const std::string &filepath, const std::string &message, const std::string &key) -> bool {
-    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open BMP file for encoding: " + filepath);
+auto BmpSteganographer::parseLayout(std::span<const uint8_t> head, const uint64_t fileSize) const
+    -> std::optional<ImageLayout> {
+    if (head.size() < FileHeaderBytes + 4) {
+        return std::nullopt;
     }
-
-    if (!canEncode(filepath, message)) {
-        throw std::runtime_error("BMP image is too small to encode the message.");
+    if (head[0] != 'B' || head[1] != 'M') {
+        throw std::runtime_error("Invalid BMP signature.");
     }
 
-    auto size = file.tellg();
-    file.seekg(0, std::ios::beg);
-
-    std::vector<char> buffer(size);
-    if (!file.read(buffer.data(), size)) {
-        throw std::runtime_error("Failed to read BMP file contents.");
+    auto dibBytes = readLittleEndian32(head, FileHeaderBytes);
+    if (dibBytes != CoreHeaderBytes && dibBytes < InfoHeaderBytes) {
+        unsupported("unknown DIB header");
     }
-    file.close();
-
-    uint32_t pixelDataOffset = *reinterpret_cast<uint32_t*>(&buffer[10]);
-    
-    return encodeLSB(buffer, pixelDataOffset, message, key, filepath);
-}
+    auto compression = dibBytes == CoreHeaderBytes ? CompressionRgb : 0;
 
-auto BmpSteganographer::decode(const std::string &filepath, const std::string &key) -> std::string {
-    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open BMP file for decoding: " + filepath);
+    // BITMAPINFOHEADER keeps its bit field masks in the twelve (or, with alpha, sixteen)
+    // bytes that follow it; later headers hold them inline.
+    size_t needed = FileHeaderBytes + dibBytes;
+    if (head.size() < needed) {
+        return std::nullopt;
+    }
+    if (dibBytes != CoreHeaderBytes) {
+        compression = readLittleEndian32(head, 30);
+        if (dibBytes == InfoHeaderBytes && compression == CompressionBitfields) needed += 12;
+        if (dibBytes == InfoHeaderBytes && compression == CompressionAlphaBitfields) needed += 16;
+        if (head.size() < needed) {
+            return std::nullopt;
+        }
     }
 
-    auto size = file.tellg();
-    file.seekg(0, std::ios::beg);
-
-    std::vector<char> buffer(size);
-    if (!file.read(buffer.data(), size)) {
-        throw std::runtime_error("Failed to read BMP file for decoding.");
+    ImageLayout layout;
+    layout.format = Utils::ImageFormat::BMP;
+    layout.pixelDataOffset = readLittleEndian32(head, 10);
+    layout.legacyDataOffset = layout.pixelDataOffset;
+
+    int bitsPerPixel = 0;
+    if (dibBytes == CoreHeaderBytes) {
+        layout.width = static_cast<int>(readLittleEndian16(head, 18));
+        layout.height = static_cast<int>(readLittleEndian16(head, 20));
+        bitsPerPixel = static_cast<int>(readLittleEndian16(head, 24));
+    } else {
+        // A negative height marks top-down rows. Carrier bytes follow file order either way.
+        layout.width = static_cast<int32_t>(readLittleEndian32(head, 18));
+        layout.height = std::abs(static_cast<int32_t>(readLittleEndian32(head, 22)));
+        bitsPerPixel = static_cast<int>(readLittleEndian16(head, 28));
     }
-    file.close();
 
-    uint32_t pixelDataOffset = *reinterpret_cast<uint32_t*>(&buffer[10]);
-    
-    return decodeLSB(buffer, pixelDataOffset, key);
-}
+    if (layout.width < 0) {
+        throw std::runtime_error("Invalid BMP dimensions.");
+    }
+    if (compression != CompressionRgb && compression != CompressionBitfields &&
+        compression != CompressionAlphaBitfields) {
+        unsupported("compressed pixel data");
+    }
 
-auto BmpSteganographer::canEncode(const std::string &filepath, const std::string &message) -> bool {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open BMP file: " + filepath);
+    // 8-bit pixels are palette indices, 16-bit ones are little-endian words whose low
+    // byte holds the lowest bits of blue, and 24- and 32-bit ones are one byte per channel.
+    auto& geometry = layout.geometry;
+    geometry.width = static_cast<uint64_t>(layout.width);
+    switch (bitsPerPixel) {
+    case 8:
+        geometry.pixelBytes = 1;
+        geometry.channels = 1;
+        break;
+    case 16:
+        geometry.pixelBytes = 2;
+        geometry.channels = 1;
+        break;
+    case 24:
+        geometry.pixelBytes = 3;
+        geometry.channels = 3;
+        break;
+    case 32:
+        geometry.pixelBytes = 4;
+        geometry.channels = 3;
+        if (compression != CompressionRgb) {
+            auto masks = FileHeaderBytes + InfoHeaderBytes;
+            geometry.firstChannel = firstColorByte(readLittleEndian32(head, masks) | readLittleEndian32(head, masks + 4) |
+                readLittleEndian32(head, masks + 8));
+        }
+        break;
+    default:
+        unsupported(std::to_string(bitsPerPixel) + " bits per pixel");
     }
+    layout.bitsPerPixel = bitsPerPixel;
 
-    auto [width, height] = readDimensions(file);
-    file.close();
+    // Rows are padded to a multiple of four bytes.
+    geometry.rowStride = (geometry.width * static_cast<uint64_t>(bitsPerPixel) + 31) / 32 * 4;
 
-    return canEncodeWithDimensions(width, height, message);
-}
\ No newline at end of file
+    auto carriers = geometry.rowCarrierBytes() * static_cast<uint64_t>(layout.height);
+    auto fileBytes = fileSize > layout.pixelDataOffset ? fileSize - layout.pixelDataOffset : 0;
+    layout.carrierBytes = std::min(carriers, geometry.carrierBytesWithin(fileBytes));
+
+    return layout;
+}
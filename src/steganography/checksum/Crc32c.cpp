@@ -0,0 +1,96 @@
+#include "steganography/checksum/Crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#define STEG_HAVE_SSE42_CRC 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define STEG_HAVE_ARM_CRC 1
+#endif
+
+namespace {
+#if defined(STEG_HAVE_SSE42_CRC) || defined(STEG_HAVE_ARM_CRC)
+  auto loadWord(const uint8_t* data) -> uint64_t {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    return word;
+  }
+#endif
+
+#if defined(STEG_HAVE_SSE42_CRC)
+  auto update(uint32_t crc, const uint8_t* data, size_t count) -> uint32_t {
+    uint64_t state = crc;
+    for (; count >= 8; data += 8, count -= 8) {
+      state = _mm_crc32_u64(state, loadWord(data));
+    }
+    crc = static_cast<uint32_t>(state);
+    for (; count > 0; data++, count--) {
+      crc = _mm_crc32_u8(crc, *data);
+    }
+    return crc;
+  }
+#elif defined(STEG_HAVE_ARM_CRC)
+  auto update(uint32_t crc, const uint8_t* data, size_t count) -> uint32_t {
+    for (; count >= 8; data += 8, count -= 8) {
+      crc = __crc32cd(crc, loadWord(data));
+    }
+    for (; count > 0; data++, count--) {
+      crc = __crc32cb(crc, *data);
+    }
+    return crc;
+  }
+#else
+  // The reflected Castagnoli polynomial.
+  constexpr uint32_t Polynomial = 0x82F63B78;
+
+  // tables[k][b] is the CRC of byte b followed by k zero bytes, so eight bytes are folded
+  // in with eight independent lookups.
+  using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+  constexpr auto makeTables() -> Tables {
+    Tables tables{};
+    for (uint32_t b = 0; b < 256; b++) {
+      auto crc = b;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = crc & 1 ? (crc >> 1) ^ Polynomial : crc >> 1;
+      }
+      tables[0][b] = crc;
+    }
+    for (size_t k = 1; k < tables.size(); k++) {
+      for (size_t b = 0; b < 256; b++) {
+        tables[k][b] = (tables[k - 1][b] >> 8) ^ tables[0][tables[k - 1][b] & 0xFF];
+      }
+    }
+    return tables;
+  }
+
+  constexpr Tables tables = makeTables();
+
+  // The first four bytes of each eight are folded into the CRC, low byte first.
+  auto update(uint32_t crc, const uint8_t* data, size_t count) -> uint32_t {
+    for (; count >= 8; data += 8, count -= 8) {
+      auto low = crc ^ (static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+          static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24);
+      crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^
+          tables[4][low >> 24] ^ tables[3][data[4]] ^ tables[2][data[5]] ^ tables[1][data[6]] ^ tables[0][data[7]];
+    }
+    for (; count > 0; data++, count--) {
+      crc = (crc >> 8) ^ tables[0][(crc ^ *data) & 0xFF];
+    }
+    return crc;
+  }
+#endif
+}
+
+namespace Checksum {
+  auto crc32c(const uint8_t* data, const size_t count, const uint32_t crc) -> uint32_t {
+    return ~update(~crc, data, count);
+  }
+
+  auto crc32c(std::span<const std::byte> data, const uint32_t crc) -> uint32_t {
+    return crc32c(reinterpret_cast<const uint8_t*>(data.data()), data.size(), crc);
+  }
+}
@@ -0,0 +1,279 @@
+#include "steganography/cli/BatchRunner.h"
+#include "steganography/Utils.h"
+#include "steganography/stats/Stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fmt/core.h>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    auto secondsSince(const Clock::time_point start) -> double {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    auto isSkippable(const std::string& line) -> bool {
+        auto first = line.find_first_not_of(" \t\r");
+        return first == std::string::npos || line[first] == '#';
+    }
+
+    auto usageError() -> int {
+        fmt::println(stderr, "Usage: ImageSteg --batch <manifest> | --batch-dir <dir> <payload-map> [--stats]\n"
+                             "       [--pipeline[=auto|uring|threads]] [--queue-depth=N] [--buffers=N]");
+        return 2;
+    }
+
+    // Removes "<name>" or "<name>=<value>" from args; returns whether it was there.
+    auto takeOption(std::vector<std::string>& args, const std::string& name, std::string& value) -> bool {
+        auto option = std::ranges::find_if(args, [&name](const std::string& arg) {
+            return arg == name || arg.starts_with(name + "=");
+        });
+        if (option == args.end()) return false;
+
+        value = option->size() > name.size() ? option->substr(name.size() + 1) : "";
+        args.erase(option);
+        return true;
+    }
+
+    auto parseCount(const std::string& value, size_t& count) -> bool {
+        if (value.empty() || !std::ranges::all_of(value, [](unsigned char c) { return std::isdigit(c); })) {
+            return false;
+        }
+        try {
+            count = std::stoul(value);
+        } catch (const std::exception&) {
+            return false;
+        }
+        return count > 0;
+    }
+
+    // One line per job: plain text, or JSON when the job collected stats.
+    auto printResult(const std::string& label, const CommandResult& result, const double milliseconds) -> void {
+        if (result.stats) {
+            fmt::println("{{\"job\":\"{}\",\"success\":{},\"ms\":{:.3f},\"payload_bytes\":{},\"output\":\"{}\",\"stats\":{}}}",
+                Utils::jsonEscape(label), result.success, milliseconds, result.payloadBytes,
+                Utils::jsonEscape(result.output), Stats::toJson(*result.stats));
+            return;
+        }
+
+        fmt::println("[{}] {}: {} ({:.2f} ms)", result.success ? "ok" : "fail", label, result.output, milliseconds);
+    }
+
+    auto printSummary(const size_t jobs, const size_t failures, const uint64_t payloadBytes, const double seconds,
+        const std::string& engine) -> void {
+        auto rate = [seconds](const double amount) { return seconds > 0 ? amount / seconds : 0.0; };
+
+        fmt::println("Batch: {} jobs, {} ok, {} failed in {:.3f} s on {} ({:.1f} jobs/s, {:.2f} MB/s payload)",
+            jobs, jobs - failures, failures, seconds, engine, rate(static_cast<double>(jobs)),
+            rate(static_cast<double>(payloadBytes) / (1024.0 * 1024.0)));
+    }
+}
+
+BatchRunner::BatchRunner(const size_t threadCount) : commandRunner(steganographerManager), pool(threadCount) {}
+
+auto BatchRunner::isBatchFlag(const std::string& flag) -> bool {
+    return flag == "--batch" || flag == "--batch-dir";
+}
+
+auto BatchRunner::run(std::vector<std::string> args) -> int {
+    if (auto flag = std::ranges::find(args, "--stats"); flag != args.end()) {
+        collectStats = true;
+        args.erase(flag);
+    }
+
+    PipelineOptions pipelineOptions;
+    std::string value;
+    auto usePipeline = takeOption(args, "--pipeline", value);
+    if (usePipeline) {
+        if (value == "uring") {
+            pipelineOptions.io.backend = AsyncIoBackend::IoUring;
+        } else if (value == "threads") {
+            pipelineOptions.io.backend = AsyncIoBackend::Threads;
+        } else if (!value.empty() && value != "auto") {
+            return usageError();
+        }
+    }
+    if (takeOption(args, "--queue-depth", value)) {
+        if (!usePipeline || !parseCount(value, pipelineOptions.io.queueDepth)) return usageError();
+    }
+    if (takeOption(args, "--buffers", value)) {
+        if (!usePipeline || !parseCount(value, pipelineOptions.bufferCount)) return usageError();
+    }
+    if (usePipeline) {
+        if (args.empty() || args[0] != "--batch-dir") return usageError();
+        pipelineOptions.collectStats = collectStats;
+        pipeline = pipelineOptions;
+    }
+
+    if (args.size() == 2 && args[0] == "--batch") {
+        return runManifest(args[1]);
+    }
+    if (args.size() == 3 && args[0] == "--batch-dir") {
+        return runDirectory(args[1], args[2]);
+    }
+    return usageError();
+}
+
+auto BatchRunner::runManifest(const std::string& manifestPath) -> int {
+    std::ifstream manifest(manifestPath);
+    if (!manifest.is_open()) {
+        fmt::println(stderr, "Error: Cannot open manifest: {}", manifestPath);
+        return 2;
+    }
+
+    std::vector<Job> jobs;
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(manifest, line); lineNumber++) {
+        if (isSkippable(line)) continue;
+
+        jobs.push_back({fmt::format("line {}", lineNumber), commandParser.parse(line)});
+    }
+
+    return runJobs(jobs);
+}
+
+auto BatchRunner::runDirectory(const std::string& directory, const std::string& payloadMapPath) -> int {
+    std::ifstream payloadMap(payloadMapPath);
+    if (!payloadMap.is_open()) {
+        fmt::println(stderr, "Error: Cannot open payload map: {}", payloadMapPath);
+        return 2;
+    }
+
+    // Jobs, or in pipeline mode only the entries that failed before getting that far.
+    std::vector<Job> jobs;
+    std::vector<EncodePipeline::Job> encodes;
+    std::vector<std::string> labels;
+    std::map<std::string, std::vector<std::string>> payloads;
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(payloadMap, line); lineNumber++) {
+        if (isSkippable(line)) continue;
+
+        auto tokens = CommandParser::tokenize(line);
+        if (tokens.size() < 2 || tokens.size() > 3) {
+            jobs.push_back({fmt::format("map line {}", lineNumber),
+                {CommandType::Unknown, {}, "Expected \"<image> <message> [key]\".", {}}});
+            continue;
+        }
+
+        auto image = std::filesystem::path(tokens[0]).generic_string();
+        tokens.erase(tokens.begin());
+        payloads[image] = std::move(tokens);
+    }
+
+    std::set<std::string> matched;
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        if (!it->is_regular_file()) continue;
+
+        auto path = it->path().string();
+        if (Utils::getImageFormat(path) == Utils::ImageFormat::NOT_SUPPORTED) continue;
+
+        auto relative = std::filesystem::relative(it->path(), directory).generic_string();
+        auto payload = payloads.find(relative);
+        if (payload == payloads.end()) continue;
+
+        matched.insert(relative);
+        if (pipeline) {
+            const auto& tokens = payload->second;
+            encodes.push_back({path, tokens[0], tokens.size() > 1 ? tokens[1] : ""});
+            labels.push_back(relative);
+            continue;
+        }
+
+        std::vector<std::string> tokens = {"-e", path};
+        tokens.insert(tokens.end(), payload->second.begin(), payload->second.end());
+
+        jobs.push_back({relative, commandParser.parse(tokens)});
+    }
+
+    if (error) {
+        fmt::println(stderr, "Error: Cannot scan directory {}: {}", directory, error.message());
+        return 2;
+    }
+
+    for (const auto& [image, tokens] : payloads) {
+        if (!matched.contains(image)) {
+            jobs.push_back({image, {CommandType::Unknown, {}, "Image not found in " + directory, {}}});
+        }
+    }
+
+    if (pipeline) {
+        return runPipeline(encodes, labels, jobs);
+    }
+    return runJobs(jobs);
+}
+
+auto BatchRunner::runJobs(const std::vector<Job>& jobs) -> int {
+    std::mutex outputMutex;
+    std::atomic<size_t> failed{0};
+    std::atomic<uint64_t> payloadBytes{0};
+
+    auto start = Clock::now();
+
+    for (const auto& job : jobs) {
+        pool.submit([&, job = &job] {
+            auto jobStart = Clock::now();
+
+            CommandResult result;
+            try {
+                if (collectStats) {
+                    auto command = job->command;
+                    command.options["--stats"] = "";
+                    result = commandRunner.run(command);
+                } else {
+                    result = commandRunner.run(job->command);
+                }
+            } catch (const std::exception& e) {
+                result = {.success = false, .output = std::string("Exception: ") + e.what()};
+            }
+
+            auto milliseconds = secondsSince(jobStart) * 1000.0;
+            if (!result.success) {
+                failed.fetch_add(1, std::memory_order_relaxed);
+            }
+            payloadBytes.fetch_add(result.payloadBytes, std::memory_order_relaxed);
+
+            std::lock_guard lock(outputMutex);
+            printResult(job->label, result, milliseconds);
+        });
+    }
+
+    pool.waitIdle();
+
+    auto failures = failed.load();
+    printSummary(jobs.size(), failures, payloadBytes.load(), secondsSince(start), fmt::format("{} threads", pool.size()));
+
+    return failures == 0 ? 0 : 1;
+}
+
+auto BatchRunner::runPipeline(const std::vector<EncodePipeline::Job>& encodes, const std::vector<std::string>& labels,
+    const std::vector<Job>& failed) -> int {
+    for (const auto& job : failed) {
+        printResult(job.label, {.success = false, .output = job.command.error}, 0.0);
+    }
+
+    EncodePipeline encodePipeline(steganographerManager, pool, *pipeline);
+    size_t failures = failed.size();
+    uint64_t payloadBytes = 0;
+
+    auto start = Clock::now();
+    encodePipeline.run(encodes, [&](const size_t job, const CommandResult& result, const double milliseconds) {
+        if (!result.success) failures++;
+        payloadBytes += result.payloadBytes;
+        printResult(labels[job], result, milliseconds);
+    });
+
+    printSummary(encodes.size() + failed.size(), failures, payloadBytes, secondsSince(start),
+        fmt::format("{} threads, {} I/O, {} buffers", pool.size(), encodePipeline.backendName(),
+            std::min(pipeline->bufferCount, std::max<size_t>(1, encodes.size()))));
+
+    return failures == 0 ? 0 : 1;
+}
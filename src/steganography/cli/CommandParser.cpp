@@ -4,7 +4,10 @@
 
 #include <iomanip>
 #include <map>
+#include <set>
+#include <sstream>
 #include <string>
+#include <utility>
 
 static const std::map<std::string, CommandType> commandMap = {
   {"-e", CommandType::Encrypt},
@@ -15,11 +18,39 @@ static const std::map<std::string, CommandType> commandMap = {
   {"--info", CommandType::Info},
   {"-c", CommandType::Check},
   {"--check", CommandType::Check},
+  {"-s", CommandType::Shard},
+  {"--shard", CommandType::Shard},
+  {"-u", CommandType::Unshard},
+  {"--unshard", CommandType::Unshard},
+  {"-S", CommandType::Scan},
+  {"--scan", CommandType::Scan},
+  {"-I", CommandType::Inventory},
+  {"--inventory", CommandType::Inventory},
   {"-h", CommandType::Help},
   {"--help", CommandType::Help}
 };
 
+static const std::map<std::string, std::set<CommandType>> optionMap = {
+  {"--bits", {CommandType::Encrypt, CommandType::Check, CommandType::Shard, CommandType::Inventory}},
+  {"--out", {CommandType::Encrypt, CommandType::Decrypt, CommandType::Unshard, CommandType::Inventory}},
+  {"--format", {CommandType::Encrypt, CommandType::Decrypt}},
+  {"--cipher", {CommandType::Encrypt, CommandType::Check, CommandType::Shard, CommandType::Inventory}},
+  {"--scatter", {CommandType::Encrypt, CommandType::Decrypt, CommandType::Check, CommandType::Shard, CommandType::Unshard,
+    CommandType::Inventory}},
+  {"--compress", {CommandType::Encrypt, CommandType::Check, CommandType::Shard}},
+  {"--fec", {CommandType::Encrypt, CommandType::Check, CommandType::Shard, CommandType::Inventory}},
+  {"--matrix", {CommandType::Encrypt, CommandType::Check, CommandType::Shard, CommandType::Inventory}},
+  {"--threads", {CommandType::Encrypt, CommandType::Decrypt, CommandType::Shard, CommandType::Unshard}},
+  {"--parallel-threshold", {CommandType::Encrypt, CommandType::Decrypt, CommandType::Shard, CommandType::Unshard}},
+  {"--stats", {CommandType::Encrypt, CommandType::Decrypt, CommandType::Info, CommandType::Check, CommandType::Shard,
+    CommandType::Unshard, CommandType::Scan, CommandType::Inventory}}
+};
+
 auto CommandParser::parse(const std::string &input) const -> Command {
+  return parse(tokenize(input));
+}
+
+auto CommandParser::tokenize(const std::string &input) -> std::vector<std::string> {
   std::stringstream ss(input);
 
   std::vector<std::string> tokens;
@@ -30,18 +61,40 @@ auto CommandParser::parse(const std::string &input) const -> Command {
     tokens.push_back(token);
   }
 
+  return tokens;
+}
+
+auto CommandParser::parse(std::vector<std::string> tokens) const -> Command {
   if (tokens.empty()) {
-    return {CommandType::Help, {}, ""};
+    return {CommandType::Help, {}, "", {}};
   }
 
   auto it = commandMap.find(tokens[0]);
   if (it == commandMap.end()) {
-    return {CommandType::Unknown, {}, CommandErrors::UnknownFlag(tokens[0])};
+    return {CommandType::Unknown, {}, CommandErrors::UnknownFlag(tokens[0]), {}};
   }
 
   const auto& type = it->second;
   tokens.erase(tokens.begin());
 
+  std::map<std::string, std::string> options;
+  for (auto token = tokens.begin(); token != tokens.end();) {
+    // Options are "--name=value", or a bare "--name" for switches such as --stats.
+    auto separator = token->find('=');
+    auto option = optionMap.find(token->substr(0, separator));
+
+    if (!token->starts_with("--") || option == optionMap.end()) {
+      ++token;
+      continue;
+    }
+    if (!option->second.contains(type)) {
+      return {CommandType::Unknown, tokens, CommandErrors::UnknownFlag(*token), {}};
+    }
+
+    options[option->first] = separator == std::string::npos ? "" : token->substr(separator + 1);
+    token = tokens.erase(token);
+  }
+
   bool err = false;
   switch (type) {
   case CommandType::Encrypt:
@@ -56,6 +109,16 @@ auto CommandParser::parse(const std::string &input) const -> Command {
   case CommandType::Check:
     err = (tokens.size() != 2);
     break;
+  case CommandType::Shard:
+    err = (tokens.size() < 3);
+    break;
+  case CommandType::Unshard:
+    err = (tokens.size() < 2);
+    break;
+  case CommandType::Scan:
+  case CommandType::Inventory:
+    err = tokens.empty();
+    break;
   case CommandType::Help:
     err = (!tokens.empty());
     break;
@@ -65,8 +128,8 @@ auto CommandParser::parse(const std::string &input) const -> Command {
   }
 
   if (err) {
-    return {CommandType::Unknown, tokens, CommandErrors::ArgError(type, tokens.size())};
+    return {CommandType::Unknown, tokens, CommandErrors::ArgError(type, tokens.size()), {}};
   }
 
-  return {type, tokens, ""};
+  return {type, tokens, "", options};
 }
\ No newline at end of file
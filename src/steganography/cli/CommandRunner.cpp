@@ -0,0 +1,662 @@
+#include "steganography/cli/CommandRunner.h"
+#include "steganography/cli/CommandErrors.h"
+#include "steganography/cli/CommandType.h"
+#include "steganography/cli/PayloadSource.h"
+#include "steganography/fec/ReedSolomon.h"
+#include "steganography/io/File.h"
+#include "steganography/lsb/LsbEngine.h"
+#include "steganography/scan/ImageInventory.h"
+#include "steganography/scan/PayloadScan.h"
+#include "steganography/shard/ShardSet.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <fmt/core.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+    auto failure(const std::string& message) -> CommandResult {
+        return {.success = false, .output = message};
+    }
+
+    auto success(const std::string& output, const uint64_t payloadBytes = 0) -> CommandResult {
+        return {.success = true, .output = output, .payloadBytes = payloadBytes};
+    }
+
+    auto unsupportedFormat() -> CommandResult {
+        return failure("Unsupported image format. Supported formats: .ppm, .pgm, .pnm, .bmp");
+    }
+
+    auto allSupported(std::span<const std::string> files) -> bool {
+        return std::ranges::none_of(files, [](const std::string& file) {
+            return Utils::getImageFormat(file) == Utils::ImageFormat::NOT_SUPPORTED;
+        });
+    }
+
+    template <typename Number>
+    auto parseNumber(const std::string& text, Number& value) -> bool {
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end == text.data() + text.size();
+    }
+
+    auto parseInt(const std::string& text, int& value) -> bool {
+        return parseNumber(text, value);
+    }
+
+    auto setBinaryMode(FILE* stream) -> void {
+#ifdef _WIN32
+        _setmode(_fileno(stream), _O_BINARY);
+#else
+        (void)stream;
+#endif
+    }
+
+    // The image format from --format when given (needed for stdin), else from the extension.
+    auto resolveFormat(const Command& command, const std::string& file) -> Utils::ImageFormat {
+        auto format = command.options.find("--format");
+        if (format == command.options.end()) {
+            return Utils::getImageFormat(file);
+        }
+
+        if (format->second == "bmp") return Utils::ImageFormat::BMP;
+        if (format->second == "ppm") return Utils::ImageFormat::PPM;
+        return Utils::ImageFormat::NOT_SUPPORTED;
+    }
+
+    // An input path, or "-" for stdin.
+    class InputStream {
+    public:
+        explicit InputStream(const std::string& path) : path(path) {
+            if (path == "-") {
+                setBinaryMode(stdin);
+                return;
+            }
+
+            file.open(path, std::ios::binary);
+            if (!file.is_open()) {
+                throw std::runtime_error("Cannot open file: " + path);
+            }
+        }
+
+        auto stream() -> std::istream& {
+            return path == "-" ? std::cin : file;
+        }
+
+    private:
+        std::string path;
+        std::ifstream file;
+    };
+
+    // An output path, or "-" for stdout. A regular file is written under a temporary name
+    // beside it and only replaces path in finish(), so a command that fails part way leaves
+    // whatever path held before untouched.
+    class OutputStream {
+    public:
+        explicit OutputStream(const std::string& path) : path(path) {
+            if (path == "-") {
+                setBinaryMode(stdout);
+                return;
+            }
+
+            // Devices and pipes are written directly; renaming over them would replace them.
+            std::error_code error;
+            auto status = std::filesystem::status(path, error);
+            auto target = path;
+            if (!std::filesystem::exists(status) || std::filesystem::is_regular_file(status)) {
+                temporary = fmt::format("{}.{:08x}.tmp", path, std::random_device{}());
+                target = temporary;
+            }
+
+            file.open(target, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                throw std::runtime_error("Failed to open output file: " + path);
+            }
+        }
+
+        OutputStream(const OutputStream&) = delete;
+        auto operator=(const OutputStream&) -> OutputStream& = delete;
+
+        ~OutputStream() {
+            if (!temporary.empty()) {
+                file.close();
+                std::error_code error;
+                std::filesystem::remove(temporary, error);
+            }
+        }
+
+        auto stream() -> std::ostream& {
+            return isStdout() ? std::cout : file;
+        }
+
+        [[nodiscard]] auto isStdout() const -> bool {
+            return path == "-";
+        }
+
+        auto finish() -> void {
+            if (!stream().flush()) {
+                throw std::runtime_error("Failed to write output: " + path);
+            }
+            if (temporary.empty()) return;
+
+            file.close();
+            std::error_code error;
+            std::filesystem::rename(temporary, path, error);
+            if (file.fail() || error) {
+                throw std::runtime_error("Failed to write output: " + path);
+            }
+            temporary.clear();
+        }
+
+    private:
+        std::string path;
+        // Set while the output is still under its temporary name.
+        std::string temporary;
+        std::ofstream file;
+    };
+
+    // Applies --threads and --parallel-threshold, which bound how one image is spread over
+    // the shared pool. Returns an error message, or an empty string on success.
+    auto applyParallelOptions(const Command& command, ParallelOptions& parallel) -> std::string {
+        if (auto threads = command.options.find("--threads"); threads != command.options.end()) {
+            if (!parseNumber(threads->second, parallel.threadCount)) {
+                return CommandErrors::InvalidOption(threads->first, threads->second,
+                    "a thread count, or 0 for every hardware thread");
+            }
+        }
+        if (auto threshold = command.options.find("--parallel-threshold"); threshold != command.options.end()) {
+            if (!parseNumber(threshold->second, parallel.thresholdBytes)) {
+                return CommandErrors::InvalidOption(threshold->first, threshold->second, "a number of bytes");
+            }
+        }
+
+        return "";
+    }
+
+    // Applies the command's options on top of the defaults.
+    // Returns an error message, or an empty string on success.
+    auto applyEncodeOptions(const Command& command, EncodeOptions& options) -> std::string {
+        if (auto bits = command.options.find("--bits"); bits != command.options.end()) {
+            if (!parseInt(bits->second, options.bitsPerChannel) || !Lsb::isValidBitsPerChannel(options.bitsPerChannel)) {
+                return CommandErrors::InvalidOption(bits->first, bits->second, "1 to 4");
+            }
+        }
+        if (auto cipher = command.options.find("--cipher"); cipher != command.options.end()) {
+            if (cipher->second == "chacha20") {
+                options.cipher = Crypto::Cipher::ChaCha20;
+            } else if (cipher->second == "xor") {
+                options.cipher = Crypto::Cipher::RepeatingKey;
+            } else {
+                return CommandErrors::InvalidOption(cipher->first, cipher->second, "chacha20 or xor");
+            }
+        }
+        if (command.options.contains("--scatter")) {
+            options.scatter = true;
+        }
+        if (command.options.contains("--compress")) {
+            options.compress = true;
+        }
+        if (auto fec = command.options.find("--fec"); fec != command.options.end()) {
+            if (!parseInt(fec->second, options.fecParity) || !Fec::isValidParity(options.fecParity)) {
+                return CommandErrors::InvalidOption(fec->first, fec->second, "an even number from 2 to 128");
+            }
+        }
+        if (auto matrix = command.options.find("--matrix"); matrix != command.options.end()) {
+            if (!parseInt(matrix->second, options.matrixBits) || !Lsb::isValidMatrixBits(options.matrixBits)) {
+                return CommandErrors::InvalidOption(matrix->first, matrix->second, "2 to 7");
+            }
+            if (options.bitsPerChannel != 1) {
+                return "Matrix embedding stores one bit per color channel; drop --bits or use --bits=1.";
+            }
+        }
+
+        return applyParallelOptions(command, options.parallel);
+    }
+}
+
+CommandRunner::CommandRunner(SteganographerManager& steganographerManager)
+    : steganographerManager(steganographerManager) {}
+
+auto CommandRunner::run(const Command& command) const -> CommandResult {
+    if (!command.error.empty()) {
+        return failure(command.error);
+    }
+
+    if (command.options.contains("--stats")) {
+        auto stats = std::make_shared<Stats::Collector>();
+        CommandResult result;
+        {
+            Stats::Session session(stats.get());
+            result = execute(command);
+        }
+        result.stats = std::move(stats);
+        return result;
+    }
+
+    return execute(command);
+}
+
+auto CommandRunner::execute(const Command& command) const -> CommandResult {
+    switch (command.type) {
+    case CommandType::Encrypt:
+        return executeEncrypt(command);
+    case CommandType::Decrypt:
+        return executeDecrypt(command);
+    case CommandType::Info:
+        return executeInfo(command);
+    case CommandType::Check:
+        return executeCheck(command);
+    case CommandType::Shard:
+        return executeShard(command);
+    case CommandType::Unshard:
+        return executeUnshard(command);
+    case CommandType::Scan:
+        return executeScan(command);
+    case CommandType::Inventory:
+        return executeInventory(command);
+    case CommandType::Help:
+        return success(helpText());
+    default:
+        return failure("Unknown command.");
+    }
+}
+
+auto CommandRunner::executeEncrypt(const Command& command) const -> CommandResult {
+    const auto& tokens = command.args;
+    auto file = tokens[0];
+    auto key = tokens.size() > 2 ? tokens[2] : "";
+
+    auto format = resolveFormat(command, file);
+    if (format == Utils::ImageFormat::NOT_SUPPORTED) {
+        return unsupportedFormat();
+    }
+
+    try {
+        auto steganographer = steganographerManager.getSteganographer(format);
+
+        EncodeOptions options;
+        if (auto error = applyEncodeOptions(command, options); !error.empty()) {
+            return failure(error);
+        }
+
+        if (auto out = command.options.find("--out"); out != command.options.end()) {
+            return encryptStream(*steganographer, command, out->second, options);
+        }
+        if (file == "-") {
+            return failure("Reading the image from stdin requires --out=<file|->.");
+        }
+
+        // Opening for writing doubles as the permission check; the handle is then
+        // shared by the capacity check and the encode itself.
+        auto image = steganographer->open(file, File::Mode::ReadWrite);
+        PayloadSource message(tokens[1]);
+
+        // A compressed payload is compressed once here and again by encode(), so that it
+        // fails the same way as any other payload that does not fit.
+        if (!steganographer->canEncode(image, message.bytes(), options)) {
+            return failure("Cannot encode message in this image.");
+        }
+
+        if (!steganographer->encode(image, message.bytes(), key, options)) {
+            return failure("Encoding failed unexpectedly.");
+        }
+
+        return success(fmt::format("Message encoded and saved to {}", file), message.bytes().size());
+    } catch (const std::exception& e) {
+        return failure(std::string("Exception: ") + e.what());
+    }
+}
+
+auto CommandRunner::encryptStream(ISteganographer& steganographer, const Command& command, const std::string& out,
+    const EncodeOptions& options) const -> CommandResult {
+    const auto& tokens = command.args;
+    const auto& file = tokens[0];
+    auto key = tokens.size() > 2 ? tokens[2] : "";
+
+    if (file == "-" && tokens[1] == "@-") {
+        return failure("The image and the message cannot both be read from stdin.");
+    }
+
+    std::error_code error;
+    if (out != "-" && file != "-" && (out == file || std::filesystem::equivalent(file, out, error))) {
+        return failure("--out must name a different file; omit it to encode in place.");
+    }
+
+    PayloadSource message(tokens[1]);
+    // An image file is checked up front, so a payload that cannot fit fails like an in
+    // place encode without writing anything; one on stdin is checked by encodeStream().
+    if (file != "-" && !steganographer.canEncode(steganographer.open(file), message.bytes(), options)) {
+        return failure("Cannot encode message in this image.");
+    }
+    InputStream input(file);
+    OutputStream output(out);
+
+    steganographer.encodeStream(input.stream(), output.stream(), message.bytes(), key, options);
+    output.finish();
+
+    // Nothing else may reach stdout when it carries the image.
+    auto text = output.isStdout() ? "" : fmt::format("Message encoded and saved to {}", out);
+    return success(text, message.bytes().size());
+}
+
+auto CommandRunner::executeDecrypt(const Command& command) const -> CommandResult {
+    const auto& tokens = command.args;
+    auto file = tokens[0];
+    auto key = tokens.size() > 1 ? tokens[1] : "";
+
+    auto format = resolveFormat(command, file);
+    if (format == Utils::ImageFormat::NOT_SUPPORTED) {
+        return unsupportedFormat();
+    }
+
+    try {
+        auto steganographer = steganographerManager.getSteganographer(format);
+
+        DecodeOptions options;
+        options.scatter = command.options.contains("--scatter");
+        if (auto error = applyParallelOptions(command, options.parallel); !error.empty()) {
+            return failure(error);
+        }
+        if (options.scatter && file == "-") {
+            return failure("--scatter needs an image file; it cannot be read from stdin.");
+        }
+
+        std::optional<OutputStream> output;
+        auto out = command.options.find("--out");
+        if (out != command.options.end()) {
+            output.emplace(out->second);
+        }
+
+        std::string message;
+        auto sink = [&](std::span<const std::byte> bytes) {
+            if (output) {
+                output->stream().write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            } else {
+                message.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+            }
+        };
+
+        uint64_t size = 0;
+        if (file == "-") {
+            InputStream input(file);
+            size = steganographer->decodeStream(input.stream(), key, sink);
+        } else if (output) {
+            size = steganographer->decode(steganographer->open(file), key, sink, options);
+        } else {
+            message = steganographer->decode(steganographer->open(file), key, options);
+        }
+
+        if (output) {
+            output->finish();
+            // Nothing else may reach stdout when it carries the payload.
+            return success(output->isStdout() ? "" : fmt::format("Decoded {} bytes to {}", size, out->second), size);
+        }
+
+        if (message.empty()) {
+            return failure("No message found or decryption failed.");
+        }
+
+        return success(fmt::format("Decoded message: {}", message), message.size());
+    } catch (const std::exception& e) {
+        return failure(std::string("Exception: ") + e.what());
+    }
+}
+
+auto CommandRunner::executeInfo(const Command& command) const -> CommandResult {
+    const auto& tokens = command.args;
+    const auto& file = tokens[0];
+    auto format = Utils::getImageFormat(file);
+
+    if (format == Utils::ImageFormat::NOT_SUPPORTED) {
+        return unsupportedFormat();
+    }
+
+    try {
+        auto steganographer = steganographerManager.getSteganographer(format);
+
+        std::pair<int, int> dimensions = steganographer->getImageDimensions(file);
+
+        return success(Utils::getImageInfo(file, dimensions));
+    } catch (const std::exception& e) {
+        return failure(std::string("Exception: ") + e.what());
+    }
+}
+
+auto CommandRunner::executeCheck(const Command& command) const -> CommandResult {
+    const auto& tokens = command.args;
+    auto file = tokens[0];
+    auto format = Utils::getImageFormat(file);
+
+    if (format == Utils::ImageFormat::NOT_SUPPORTED) {
+        return unsupportedFormat();
+    }
+
+    try {
+        auto steganographer = steganographerManager.getSteganographer(format);
+
+        EncodeOptions options;
+        if (auto error = applyEncodeOptions(command, options); !error.empty()) {
+            return failure(error);
+        }
+
+        PayloadSource message(tokens[1]);
+        if (steganographer->canEncode(steganographer->open(file), message.bytes(), options)) {
+            return success("This image can be used for encoding.");
+        }
+        return success("This image cannot be used for encoding.");
+    } catch (const std::exception& e) {
+        return failure(std::string("Exception: ") + e.what());
+    }
+}
+
+auto CommandRunner::executeShard(const Command& command) const -> CommandResult {
+    const auto& tokens = command.args;
+    const auto& key = tokens[1];
+    std::vector<std::string> images(tokens.begin() + 2, tokens.end());
+
+    if (!allSupported(images)) {
+        return unsupportedFormat();
+    }
+
+    try {
+        // The defaults of the first image's steganographer apply to the whole set.
+        EncodeOptions options;
+        if (auto error = applyEncodeOptions(command, options); !error.empty()) {
+            return failure(error);
+        }
+
+        PayloadSource message(tokens[0]);
+        ShardSet(steganographerManager).encode(images, message.bytes(), key, options);
+
+        return success(fmt::format("Message split across {} images", images.size()), message.bytes().size());
+    } catch (const ShardError& e) {
+        return failure(e.what());
+    } catch (const std::exception& e) {
+        return failure(std::string("Exception: ") + e.what());
+    }
+}
+
+auto CommandRunner::executeUnshard(const Command& command) const -> CommandResult {
+    const auto& tokens = command.args;
+    const auto& key = tokens[0];
+    std::vector<std::string> images(tokens.begin() + 1, tokens.end());
+
+    if (!allSupported(images)) {
+        return unsupportedFormat();
+    }
+
+    try {
+        DecodeOptions options;
+        options.scatter = command.options.contains("--scatter");
+        if (auto error = applyParallelOptions(command, options.parallel); !error.empty()) {
+            return failure(error);
+        }
+
+        std::optional<OutputStream> output;
+        auto out = command.options.find("--out");
+        if (out != command.options.end()) {
+            output.emplace(out->second);
+        }
+
+        std::string message;
+        auto sink = [&](std::span<const std::byte> bytes) {
+            if (output) {
+                output->stream().write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            } else {
+                message.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+            }
+        };
+
+        auto size = ShardSet(steganographerManager).decode(images, key, sink, options);
+
+        if (output) {
+            output->finish();
+            // Nothing else may reach stdout when it carries the payload.
+            return success(output->isStdout() ? "" : fmt::format("Decoded {} bytes to {}", size, out->second), size);
+        }
+
+        return success(fmt::format("Decoded message: {}", message), size);
+    } catch (const ShardError& e) {
+        return failure(e.what());
+    } catch (const std::exception& e) {
+        return failure(std::string("Exception: ") + e.what());
+    }
+}
+
+auto CommandRunner::executeScan(const Command& command) const -> CommandResult {
+    try {
+        auto report = PayloadScanner(steganographerManager).scan(command.args);
+        if (report.scanned == 0 && report.failures.empty()) {
+            return failure("No supported images found.");
+        }
+
+        std::string output;
+        if (!report.candidates.empty()) {
+            output += fmt::format("{:>10}  {:>12}  {}\n", "Confidence", "Bytes", "Image");
+        }
+        for (const auto& candidate : report.candidates) {
+            const auto& header = candidate.header;
+            output += fmt::format("{:>9.1f}%  {:>12}  {}  (bits={}{}{}{}{})\n", candidate.confidence * 100.0,
+                header.payloadBytes, candidate.image, header.bitsPerChannel,
+                header.matrixBits > 0 ? fmt::format(", matrix={}", header.matrixBits) : "",
+                header.cipher == Crypto::Cipher::ChaCha20 ? ", chacha20" : "", header.compressed ? ", compressed" : "",
+                header.fecParity > 0 ? fmt::format(", fec={}", header.fecParity) : "");
+        }
+        for (const auto& failed : report.failures) {
+            output += fmt::format("Skipped {}\n", failed);
+        }
+        output += fmt::format("Scanned {} images: {} may carry a payload, {} could not be read.", report.scanned,
+            report.candidates.size(), report.failures.size());
+
+        return success(output);
+    } catch (const std::exception& e) {
+        return failure(std::string("Exception: ") + e.what());
+    }
+}
+
+auto CommandRunner::executeInventory(const Command& command) const -> CommandResult {
+    try {
+        EncodeOptions options;
+        if (auto error = applyEncodeOptions(command, options); !error.empty()) {
+            return failure(error);
+        }
+
+        // Every line is written as soon as its image is done, to stdout unless --out names
+        // a file, so nothing waits for the last image of a large archive.
+        auto out = command.options.find("--out");
+        OutputStream output(out != command.options.end() ? out->second : "-");
+        auto report = ImageInventory(steganographerManager).list(command.args, options, [&](const InventoryEntry& entry) {
+            output.stream() << entry.toJson() + '\n';
+        });
+        output.finish();
+
+        if (report.listed == 0 && report.failed == 0) {
+            return failure("No supported images found.");
+        }
+        // Nothing else may reach stdout when it carries the listing.
+        return success(output.isStdout() ? "" : fmt::format("Listed {} images to {}, {} could not be read.",
+            report.listed, out->second, report.failed));
+    } catch (const std::exception& e) {
+        return failure(std::string("Exception: ") + e.what());
+    }
+}
+
+auto CommandRunner::helpText() -> std::string {
+    return "Usage:\n"
+           "-e, --encrypt <file> <message> [key] [--bits=N] [--cipher=C] [--scatter] [--compress] [--fec=P]\n"
+           "    [--matrix=M] [--out=path]\n"
+           "    Encrypt a message in an image, storing N (1-4, default 1) bits per color channel.\n"
+           "    The message is enciphered with C: chacha20 (default, key derived from the passphrase)\n"
+           "    or xor (the legacy repeating key); -d detects which one was used. --scatter spreads\n"
+           "    the message over the whole image in a key-dependent order. --compress stores it\n"
+           "    LZ4-compressed, which -d undoes on its own. --fec adds P (an even number, 2-128)\n"
+           "    Reed-Solomon parity bytes per 255-byte codeword, so -d repairs up to P/2 damaged\n"
+           "    bytes in each. --matrix hides M (2-7) bits in every 2^M-1 color channels and changes\n"
+           "    at most one of them, trading capacity for far fewer changes; it needs --bits=1.\n"
+           "    With --out the image is streamed to path instead of being modified in place.\n"
+           "-d, --decrypt <file> [key] [--scatter] [--out=path]  Decrypt a message from an image,\n"
+           "    optionally writing the raw bytes to path. Pass --scatter if it was encrypted with it.\n"
+           "    A wrong key is rejected before any of the message is read, and a damaged message\n"
+           "    fails its checksum (xor messages without --compress, --fec or --matrix have neither).\n"
+           "-i, --info <file>  Display information about the image format.\n"
+           "-c, --check <file> <message> [--bits=N] [--cipher=C] [--scatter] [--compress] [--fec=P]\n"
+           "    [--matrix=M]\n"
+           "    Check if an image can encode a message.\n"
+           "-s, --shard <message> <key> <image> [image...] [--bits=N] [--cipher=C] [--scatter] [--compress]\n"
+           "    [--fec=P] [--matrix=M]\n"
+           "    Split a message too large for one image across several, in proportion to their\n"
+           "    capacity. The images are encrypted in place and in parallel.\n"
+           "-u, --unshard <key> <image> [image...] [--scatter] [--out=path]  Join a message split\n"
+           "    with --shard. Every image of the set is needed; their order does not matter.\n"
+           "-S, --scan <image|dir> [more...]  Rank images by how likely they carry a payload,\n"
+           "    from the header and a sample of the bits behind it, without decoding anything.\n"
+           "    Directories are scanned recursively and in parallel. Bytes is the stored size.\n"
+           "    Payloads embedded with --scatter cannot be found without their key.\n"
+           "-I, --inventory <image|dir> [more...] [--bits=N] [--cipher=C] [--scatter] [--fec=P] [--matrix=M]\n"
+           "    [--out=path]  List images as JSON lines: format, dimensions, bits per pixel, file\n"
+           "    and carrier bytes, and the payload bytes that fit with the given options. Only the\n"
+           "    image headers are read, in parallel; an image that cannot be read gets an \"error\"\n"
+           "    line. Each line goes to stdout, or to path with --out, as soon as its image is done,\n"
+           "    in no order.\n"
+           "-h, --help  Display this help message.\n"
+           "Add --stats to -e, -d, -i, -c, -s, -u, -S or -I to print per-phase timings, I/O and buffer counters,\n"
+           "    plus allocation counts in builds with IMAGESTEG_COUNT_ALLOCATIONS.\n"
+           "Add --threads=N to -e, -d, -s or -u to work on each image with at most N threads (0, the\n"
+           "    default, uses every hardware thread), and --parallel-threshold=BYTES to keep images\n"
+           "    whose payload spans fewer carrier bytes (default 4194304) on one thread.\n"
+           "\n"
+           "A <message> of @path embeds the contents of a file, @- reads stdin and\n"
+           "@@text stands for the literal text @text.\n"
+           "For -e and -d, a <file> of - reads the image from stdin (set its type with\n"
+           "--format=bmp|ppm) and --out=- writes to stdout, so both work in pipelines.\n"
+           "\n"
+           "Non-interactive use:\n"
+           "ImageSteg <command> [args...]  Run a single command and exit.\n"
+           "ImageSteg --batch <manifest>  Run one command per manifest line in parallel.\n"
+           "ImageSteg --batch-dir <dir> <payload-map>  Encrypt every image in dir listed in the map\n"
+           "    (one \"<image> <message> [key]\" line per image).\n"
+           "Add --stats to either batch form for one JSON line of timings per job.\n"
+           "Add --pipeline[=auto|uring|threads] to --batch-dir to overlap reading, embedding and\n"
+           "    writing across images (io_uring on Linux where allowed, helper threads otherwise);\n"
+           "    --queue-depth=N sets the I/O operations in flight and --buffers=N the images.\n"
+           "ImageSteg --daemon <socket>  Serve commands on a Unix domain socket until stopped.\n"
+           "ImageSteg --client <socket> [command...]  Run a command on the daemon, or pipeline\n"
+           "    one command per line from stdin. The daemon resolves relative paths against its\n"
+           "    own working directory, and cannot use stdin or stdout.\n"
+           "\n"
+           "Supported image formats: .bmp, and .ppm/.pgm/.pnm (P6, P5 and plain P3; 8 or 16 bits).";
+}
@@ -0,0 +1,123 @@
+#include "steganography/cli/DaemonClient.h"
+#include "steganography/cli/CommandParser.h"
+
+#include <atomic>
+#include <fmt/core.h>
+#include <iostream>
+#include <thread>
+
+namespace {
+    auto isSkippable(const std::string& line) -> bool {
+        auto first = line.find_first_not_of(" \t\r");
+        return first == std::string::npos || line[first] == '#';
+    }
+
+    // Frames are collected up to this size before they go out in one write.
+    constexpr size_t SendBufferBytes = 64 * 1024;
+}
+
+auto DaemonClient::isClientFlag(const std::string& flag) -> bool {
+    return flag == "--client";
+}
+
+auto DaemonClient::run(const std::vector<std::string>& args) -> int {
+    if (args.size() < 2) {
+        fmt::println(stderr, "Usage: ImageSteg --client <socket> [command...]");
+        return 2;
+    }
+
+    try {
+        auto socket = UnixSocket::connect(args[1]);
+        if (args.size() > 2) {
+            return runOne(socket, {args.begin() + 2, args.end()});
+        }
+        // Lets std::cin read ahead, which is what tells runPipelined more lines are ready.
+        std::ios::sync_with_stdio(false);
+        return runPipelined(socket, std::cin);
+    } catch (const std::exception& e) {
+        fmt::println(stderr, "Error: {}", e.what());
+        return 1;
+    }
+}
+
+auto DaemonClient::runOne(const UnixSocket& socket, const std::vector<std::string>& tokens) -> int {
+    std::vector<char> buffer;
+    Daemon::appendRequest({0, tokens}, buffer);
+    socket.writeAll(buffer.data(), buffer.size());
+
+    auto response = Daemon::readResponse(socket, buffer);
+    if (!response) {
+        throw std::runtime_error("The daemon closed the connection without replying.");
+    }
+
+    if (!response->success) {
+        fmt::println(stderr, "Error: {}", response->output);
+    } else if (!response->output.empty()) {
+        fmt::println("{}", response->output);
+    }
+    if (!response->stats.empty()) {
+        fmt::println(stderr, "{}", response->stats);
+    }
+
+    return response->success ? 0 : 1;
+}
+
+auto DaemonClient::runPipelined(const UnixSocket& socket, std::istream& input) -> int {
+    std::atomic<size_t> received{0};
+    std::atomic<size_t> failed{0};
+    std::exception_ptr readError;
+
+    std::thread reader([&] {
+        try {
+            std::vector<char> buffer;
+            while (auto response = Daemon::readResponse(socket, buffer)) {
+                if (!response->success) {
+                    failed.fetch_add(1, std::memory_order_relaxed);
+                }
+                fmt::println("[{}] line {}: {}", response->success ? "ok" : "fail", response->id, response->output);
+                if (!response->stats.empty()) {
+                    fmt::println("{}", response->stats);
+                }
+                received.fetch_add(1, std::memory_order_relaxed);
+            }
+        } catch (...) {
+            readError = std::current_exception();
+        }
+    });
+
+    size_t sent = 0;
+    try {
+        std::vector<char> buffer;
+        std::string line;
+        for (uint32_t lineNumber = 1; std::getline(input, line); lineNumber++) {
+            if (isSkippable(line)) continue;
+
+            Daemon::appendRequest({lineNumber, CommandParser::tokenize(line)}, buffer);
+            sent++;
+
+            // Send when the batch is full or when input has nothing more ready, so
+            // interactive input is not held back waiting for the buffer to fill.
+            if (buffer.size() >= SendBufferBytes || input.rdbuf()->in_avail() <= 0) {
+                socket.writeAll(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+        socket.writeAll(buffer.data(), buffer.size());
+    } catch (...) {
+        socket.shutdownWrite();
+        reader.join();
+        throw;
+    }
+
+    socket.shutdownWrite();
+    reader.join();
+
+    if (readError) {
+        std::rethrow_exception(readError);
+    }
+    if (received.load() != sent) {
+        throw std::runtime_error(fmt::format("The daemon answered {} of {} requests.", received.load(), sent));
+    }
+
+    return failed.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+#include "steganography/cli/DaemonProtocol.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+  constexpr uint8_t SuccessFlag = 1;
+  constexpr size_t ResponseFixedBytes = 1 + 8 + 4;
+
+  auto appendLittleEndian(std::vector<char>& out, const uint64_t value, const size_t bytes) -> void {
+    for (size_t i = 0; i < bytes; i++) out.push_back(static_cast<char>(value >> (8 * i)));
+  }
+
+  auto loadLittleEndian(const char* p, const size_t bytes) -> uint64_t {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) value |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+    return value;
+  }
+
+  [[noreturn]] auto malformed() -> void {
+    throw std::runtime_error("Malformed daemon message.");
+  }
+
+  // Appends the frame header with a zero length, to be patched by finishFrame.
+  auto beginFrame(std::vector<char>& out, const uint32_t id) -> size_t {
+    auto start = out.size();
+    appendLittleEndian(out, 0, 4);
+    appendLittleEndian(out, id, 4);
+    return start;
+  }
+
+  auto finishFrame(std::vector<char>& out, const size_t start) -> void {
+    auto body = out.size() - start - Daemon::FrameHeaderBytes;
+    if (body > Daemon::MaxBodyBytes) {
+      out.resize(start);
+      throw std::runtime_error("Daemon message too large.");
+    }
+    for (size_t i = 0; i < 4; i++) out[start + i] = static_cast<char>(body >> (8 * i));
+  }
+
+  // Reads one frame into buffer and returns its id; buffer then holds just the body.
+  auto readFrame(const UnixSocket& socket, std::vector<char>& buffer) -> std::optional<uint32_t> {
+    char header[Daemon::FrameHeaderBytes];
+    if (!socket.readExact(header, sizeof(header))) return std::nullopt;
+
+    auto body = loadLittleEndian(header, 4);
+    if (body > Daemon::MaxBodyBytes) malformed();
+
+    buffer.resize(static_cast<size_t>(body));
+    if (body > 0 && !socket.readExact(buffer.data(), buffer.size())) malformed();
+    return static_cast<uint32_t>(loadLittleEndian(header + 4, 4));
+  }
+}
+
+namespace Daemon {
+  auto appendRequest(const Request& request, std::vector<char>& out) -> void {
+    auto start = beginFrame(out, request.id);
+    for (const auto& token : request.tokens) {
+      out.insert(out.end(), token.begin(), token.end());
+      out.push_back('\0');
+    }
+    finishFrame(out, start);
+  }
+
+  auto appendResponse(const Response& response, std::vector<char>& out) -> void {
+    auto start = beginFrame(out, response.id);
+    out.push_back(static_cast<char>(response.success ? SuccessFlag : 0));
+    appendLittleEndian(out, response.payloadBytes, 8);
+    appendLittleEndian(out, response.output.size(), 4);
+    out.insert(out.end(), response.output.begin(), response.output.end());
+    out.insert(out.end(), response.stats.begin(), response.stats.end());
+    finishFrame(out, start);
+  }
+
+  auto readRequest(const UnixSocket& socket, std::vector<char>& buffer) -> std::optional<Request> {
+    auto id = readFrame(socket, buffer);
+    if (!id) return std::nullopt;
+
+    Request request;
+    request.id = *id;
+    if (!buffer.empty() && buffer.back() != '\0') malformed();
+
+    for (size_t begin = 0; begin < buffer.size();) {
+      auto end = static_cast<size_t>(std::find(buffer.begin() + begin, buffer.end(), '\0') - buffer.begin());
+      request.tokens.emplace_back(buffer.data() + begin, end - begin);
+      begin = end + 1;
+    }
+    return request;
+  }
+
+  auto readResponse(const UnixSocket& socket, std::vector<char>& buffer) -> std::optional<Response> {
+    auto id = readFrame(socket, buffer);
+    if (!id) return std::nullopt;
+    if (buffer.size() < ResponseFixedBytes) malformed();
+
+    Response response;
+    response.id = *id;
+    response.success = (static_cast<uint8_t>(buffer[0]) & SuccessFlag) != 0;
+    response.payloadBytes = loadLittleEndian(buffer.data() + 1, 8);
+
+    auto outputBytes = loadLittleEndian(buffer.data() + 9, 4);
+    if (outputBytes > buffer.size() - ResponseFixedBytes) malformed();
+
+    const auto* output = buffer.data() + ResponseFixedBytes;
+    response.output.assign(output, static_cast<size_t>(outputBytes));
+    response.stats.assign(output + outputBytes, buffer.size() - ResponseFixedBytes - static_cast<size_t>(outputBytes));
+    return response;
+  }
+}
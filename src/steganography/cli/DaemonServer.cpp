@@ -0,0 +1,136 @@
+#include "steganography/cli/DaemonServer.h"
+#include "steganography/stats/Stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <fmt/core.h>
+#include <mutex>
+#include <thread>
+
+namespace {
+    // Requests a connection may have queued or running at once; the reader stops taking
+    // more until some finish, so a fast client cannot queue without bound.
+    constexpr size_t MaxInFlight = 256;
+
+    // The daemon's stdin and stdout belong to the daemon, not to the client asking. An
+    // inventory without --out streams to stdout.
+    auto usesConsole(const Command& command) -> bool {
+        auto out = command.options.find("--out");
+        if (command.type == CommandType::Inventory && out == command.options.end()) return true;
+        return (out != command.options.end() && out->second == "-") ||
+            std::ranges::any_of(command.args, [](const std::string& arg) { return arg == "-" || arg == "@-"; });
+    }
+}
+
+struct DaemonServer::Connection {
+    explicit Connection(UnixSocket socket) : socket(std::move(socket)) {}
+
+    UnixSocket socket;
+    // Responses from different workers must not interleave.
+    std::mutex writeMutex;
+
+    std::mutex stateMutex;
+    std::condition_variable finished;
+    size_t inFlight = 0;
+};
+
+DaemonServer::DaemonServer(const size_t threadCount) : commandRunner(steganographerManager), pool(threadCount) {}
+
+auto DaemonServer::isDaemonFlag(const std::string& flag) -> bool {
+    return flag == "--daemon";
+}
+
+auto DaemonServer::run(const std::vector<std::string>& args) -> int {
+    if (args.size() != 2) {
+        fmt::println(stderr, "Usage: ImageSteg --daemon <socket>");
+        return 2;
+    }
+
+    try {
+        serve(args[1]);
+    } catch (const std::exception& e) {
+        fmt::println(stderr, "Error: {}", e.what());
+        return 1;
+    }
+    return 0;
+}
+
+auto DaemonServer::serve(const std::string& socketPath) -> void {
+    auto listener = UnixSocket::listen(socketPath);
+    fmt::println(stderr, "Listening on {} with {} workers", socketPath, pool.size());
+
+    while (true) {
+        std::shared_ptr<Connection> connection;
+        try {
+            connection = std::make_shared<Connection>(listener.accept());
+        } catch (const std::exception& e) {
+            // Usually out of descriptors; back off instead of spinning until some close.
+            fmt::println(stderr, "Error: {}", e.what());
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+
+        // The server runs until the process ends, so reader threads never outlive it.
+        std::thread([this, connection] { handleConnection(connection); }).detach();
+    }
+}
+
+auto DaemonServer::handleConnection(const std::shared_ptr<Connection>& connection) -> void {
+    // Reused for every request on this connection.
+    std::vector<char> buffer;
+
+    try {
+        while (auto request = Daemon::readRequest(connection->socket, buffer)) {
+            {
+                std::unique_lock lock(connection->stateMutex);
+                connection->finished.wait(lock, [&] { return connection->inFlight < MaxInFlight; });
+                connection->inFlight++;
+            }
+
+            pool.submit([this, connection, request = std::move(*request)] {
+                auto response = execute(request);
+
+                // Each worker keeps its frame buffer warm across requests and connections.
+                thread_local std::vector<char> frame;
+                frame.clear();
+                try {
+                    Daemon::appendResponse(response, frame);
+                } catch (const std::exception& e) {
+                    Daemon::appendResponse({request.id, false, 0, std::string(e.what()) + " Use --out=<file>.", ""}, frame);
+                }
+
+                {
+                    std::lock_guard lock(connection->writeMutex);
+                    try {
+                        connection->socket.writeAll(frame.data(), frame.size());
+                    } catch (const std::exception&) {
+                        // The client went away; its remaining responses have nowhere to go.
+                    }
+                }
+
+                std::lock_guard lock(connection->stateMutex);
+                connection->inFlight--;
+                connection->finished.notify_one();
+            });
+        }
+    } catch (const std::exception& e) {
+        fmt::println(stderr, "Error: Dropping client: {}", e.what());
+    }
+    // The socket closes once the last queued response has been written.
+}
+
+auto DaemonServer::execute(const Daemon::Request& request) const -> Daemon::Response {
+    try {
+        auto command = commandParser.parse(request.tokens);
+        if (usesConsole(command)) {
+            return {request.id, false, 0, "The daemon cannot read stdin or write stdout; name a file instead.", ""};
+        }
+
+        auto result = commandRunner.run(command);
+        return {request.id, result.success, result.payloadBytes, result.output,
+            result.stats ? Stats::toJson(*result.stats) : ""};
+    } catch (const std::exception& e) {
+        return {request.id, false, 0, std::string("Exception: ") + e.what(), ""};
+    }
+}
@@ -0,0 +1,209 @@
+#include "steganography/cli/EncodePipeline.h"
+#include "steganography/cli/PayloadSource.h"
+#include "steganography/stats/Stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fmt/core.h>
+#include <memory>
+#include <optional>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    enum class Stage { Preparing, Reading, Embedding, Writing, Syncing };
+
+    auto nanosecondsSince(const Clock::time_point start) -> uint64_t {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+}
+
+struct EncodePipeline::Slot {
+    size_t job = 0;
+    Stage stage = Stage::Preparing;
+    Clock::time_point started;
+    Clock::time_point ioStarted;
+
+    ISteganographer* steganographer = nullptr;
+    EncodeOptions encodeOptions;
+    std::optional<ImageHandle> image;
+    std::unique_ptr<PayloadSource> payload;
+    std::vector<std::byte> frame;
+    std::span<const std::byte> stored;
+    // Kept from one image to the next, so it only grows to the largest pixel range.
+    std::vector<uint8_t> buffer;
+
+    // Set when prepare already encoded the image the regular way.
+    bool encoded = false;
+    std::string error;
+    std::shared_ptr<Stats::Collector> stats;
+};
+
+EncodePipeline::EncodePipeline(SteganographerManager& steganographerManager, ThreadPool& pool,
+    const PipelineOptions& options)
+    : steganographerManager(steganographerManager), pool(pool), options(options), io(AsyncIo::create(options.io)) {}
+
+auto EncodePipeline::backendName() const -> std::string {
+    return io->name();
+}
+
+auto EncodePipeline::run(const std::vector<Job>& jobs, const Report& report) -> void {
+    std::vector<Slot> slots(std::min(std::max<size_t>(1, options.bufferCount), jobs.size()));
+    size_t next = 0;
+    size_t finished = 0;
+
+    // Runs step on the pool under the slot's stats, then hands the slot back to this
+    // thread through a completion tagged with its index.
+    auto onPool = [&](const size_t index, std::function<void(Slot&)> step) {
+        pool.submit([this, &slots, index, step = std::move(step)] {
+            auto& slot = slots[index];
+            {
+                Stats::Session session(slot.stats.get());
+                try {
+                    step(slot);
+                } catch (const std::exception& e) {
+                    slot.error = std::string("Exception: ") + e.what();
+                }
+            }
+            io->notify(index);
+        });
+    };
+
+    auto prepare = [&jobs, this](Slot& slot) {
+        const auto& job = jobs[slot.job];
+        auto format = Utils::getImageFormat(job.image);
+        slot.steganographer = steganographerManager.getSteganographer(format);
+        if (slot.steganographer == nullptr) {
+            slot.error = "Unsupported image format. Supported formats: .ppm, .pgm, .pnm, .bmp";
+            return;
+        }
+
+        slot.image.emplace(slot.steganographer->open(job.image, File::Mode::ReadWrite));
+        slot.payload = std::make_unique<PayloadSource>(job.message);
+
+        if (slot.image->getLayout().encoding == SampleEncoding::Ascii) {
+            slot.steganographer->encode(*slot.image, slot.payload->bytes(), job.key, slot.encodeOptions);
+            slot.encoded = true;
+            return;
+        }
+
+        slot.stored = ISteganographer::storedPayload(slot.payload->bytes(), slot.encodeOptions, slot.frame);
+        auto pixelBytes = slot.steganographer->pixelBytesFor(*slot.image, slot.stored.size(), job.key, slot.encodeOptions);
+        slot.buffer.resize(static_cast<size_t>(pixelBytes));
+    };
+
+    auto embed = [&jobs](Slot& slot) {
+        slot.steganographer->embedPixels(*slot.image, slot.buffer.data(), slot.stored, jobs[slot.job].key,
+            slot.encodeOptions);
+    };
+
+    auto start = [&](const size_t index) {
+        auto& slot = slots[index];
+        slot.job = next++;
+        slot.stage = Stage::Preparing;
+        slot.started = Clock::now();
+        slot.encoded = false;
+        slot.error.clear();
+        slot.stats = options.collectStats ? std::make_shared<Stats::Collector>() : nullptr;
+        onPool(index, prepare);
+    };
+
+    auto finish = [&](const size_t index) {
+        auto& slot = slots[index];
+        CommandResult result;
+        if (slot.error.empty()) {
+            result = {.success = true, .output = fmt::format("Message encoded and saved to {}", jobs[slot.job].image),
+                .payloadBytes = slot.payload->bytes().size()};
+        } else {
+            result = {.success = false, .output = slot.error};
+        }
+        result.stats = std::move(slot.stats);
+
+        auto milliseconds = static_cast<double>(nanosecondsSince(slot.started)) / 1e6;
+        slot.image.reset();
+        slot.payload.reset();
+        slot.frame.clear();
+        slot.stored = {};
+
+        report(slot.job, result, milliseconds);
+        finished++;
+        if (next < jobs.size()) {
+            start(index);
+        }
+    };
+
+    // Records the asynchronous phase that just ended in the slot's stats.
+    auto recordIo = [](Slot& slot, const Stats::Phase phase, const Stats::Counter counter, const size_t bytes) {
+        if (!slot.stats) return;
+        slot.stats->addTime(phase, nanosecondsSince(slot.ioStarted));
+        slot.stats->add(counter, bytes);
+    };
+
+    // Moves a slot on to its next stage once the current one has completed.
+    auto advance = [&](const size_t index, const AsyncIo::Completion& completion) {
+        auto& slot = slots[index];
+        if (!completion.error.empty()) {
+            slot.error = "Exception: " + completion.error;
+        }
+
+        switch (slot.stage) {
+        case Stage::Preparing:
+            if (!slot.error.empty() || slot.encoded) break;
+            slot.stage = Stage::Reading;
+            slot.ioStarted = Clock::now();
+            io->read(slot.image->getFile(), slot.image->getLayout().pixelDataOffset, slot.buffer.data(),
+                slot.buffer.size(), index);
+            return;
+        case Stage::Reading:
+            recordIo(slot, Stats::Phase::Read, Stats::Counter::BytesRead, completion.bytes);
+            if (!slot.error.empty()) break;
+            if (completion.bytes < slot.buffer.size()) {
+                slot.error = "Exception: Unexpected end of file: " + jobs[slot.job].image;
+                break;
+            }
+            slot.stage = Stage::Embedding;
+            onPool(index, embed);
+            return;
+        case Stage::Embedding:
+            if (!slot.error.empty()) break;
+            slot.stage = Stage::Writing;
+            slot.ioStarted = Clock::now();
+            io->write(slot.image->getFile(), slot.image->getLayout().pixelDataOffset, slot.buffer.data(),
+                slot.buffer.size(), index);
+            return;
+        case Stage::Writing:
+            recordIo(slot, Stats::Phase::Write, Stats::Counter::BytesWritten, completion.bytes);
+            if (!slot.error.empty() || slot.encodeOptions.flushPolicy != FlushPolicy::Sync) break;
+            slot.stage = Stage::Syncing;
+            slot.ioStarted = Clock::now();
+            io->sync(slot.image->getFile(), index);
+            return;
+        case Stage::Syncing:
+            if (slot.stats) slot.stats->addTime(Stats::Phase::Flush, nanosecondsSince(slot.ioStarted));
+            break;
+        }
+
+        finish(index);
+    };
+
+    for (size_t index = 0; index < slots.size(); index++) {
+        start(index);
+    }
+
+    std::vector<AsyncIo::Completion> completions;
+    while (finished < jobs.size()) {
+        completions.clear();
+        io->wait(completions);
+
+        for (const auto& completion : completions) {
+            auto index = static_cast<size_t>(completion.tag);
+            try {
+                advance(index, completion);
+            } catch (const std::exception& e) {
+                // Submitting the next operation failed; the image goes no further.
+                slots[index].error = std::string("Exception: ") + e.what();
+                finish(index);
+            }
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#include "steganography/cli/PayloadSource.h"
+
+#include <cstdio>
+#include <string_view>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+PayloadSource::PayloadSource(const std::string& argument) {
+    if (!argument.starts_with('@') || argument.starts_with("@@")) {
+        auto text = std::string_view(argument).substr(argument.starts_with("@@") ? 1 : 0);
+        payload = std::as_bytes(std::span(text.data(), text.size()));
+    } else if (argument == "@-") {
+        readStdin();
+    } else {
+        file.emplace(argument.substr(1), File::Mode::Read);
+        auto size = file->size();
+        if (size > 0) {
+            mapping = std::make_unique<MappedFile>(*file, 0, static_cast<size_t>(size));
+            payload = std::as_bytes(std::span(mapping->data(), mapping->size()));
+        }
+    }
+}
+
+auto PayloadSource::bytes() const -> std::span<const std::byte> {
+    return payload;
+}
+
+auto PayloadSource::readStdin() -> void {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    constexpr size_t ReadBytes = 64 * 1024;
+    while (true) {
+        auto used = buffer.size();
+        buffer.resize(used + ReadBytes);
+        auto n = std::fread(buffer.data() + used, 1, ReadBytes, stdin);
+        buffer.resize(used + n);
+        if (n < ReadBytes) break;
+    }
+    payload = buffer;
+}
@@ -0,0 +1,151 @@
+#include "steganography/compress/Lz4.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+  constexpr size_t MinMatch = 4;
+  // The format requires the last match to start at least 12 bytes before the end of the
+  // block and the last 5 bytes to be literals.
+  constexpr size_t MatchSafeDistance = 12;
+  constexpr size_t LastLiterals = 5;
+  constexpr size_t MaxOffset = 65535;
+  constexpr int HashBits = 14;
+
+  auto load32(const uint8_t* p) -> uint32_t {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+  }
+
+  auto hash(const uint32_t sequence) -> uint32_t {
+    return (sequence * 2654435761u) >> (32 - HashBits);
+  }
+
+  // Writes the 255-continued part of a length whose nibble is saturated.
+  auto writeLength(uint8_t*& out, size_t length) -> void {
+    while (length >= 255) {
+      *out++ = 255;
+      length -= 255;
+    }
+    *out++ = static_cast<uint8_t>(length);
+  }
+
+  auto writeSequence(uint8_t*& out, const uint8_t* literals, const size_t literalCount, const size_t matchLength,
+      const size_t offset) -> void {
+    auto* token = out++;
+    auto literalNibble = literalCount < 15 ? literalCount : 15;
+    if (literalCount >= 15) writeLength(out, literalCount - 15);
+    std::memcpy(out, literals, literalCount);
+    out += literalCount;
+
+    auto matchNibble = size_t{0};
+    if (matchLength > 0) {
+      *out++ = static_cast<uint8_t>(offset);
+      *out++ = static_cast<uint8_t>(offset >> 8);
+      auto extra = matchLength - MinMatch;
+      matchNibble = extra < 15 ? extra : 15;
+      if (extra >= 15) writeLength(out, extra - 15);
+    }
+    *token = static_cast<uint8_t>((literalNibble << 4) | matchNibble);
+  }
+
+  [[noreturn]] auto malformed() -> void {
+    throw std::runtime_error("Corrupted compressed payload.");
+  }
+
+  auto readLength(const uint8_t*& in, const uint8_t* end) -> size_t {
+    size_t length = 0;
+    uint8_t b;
+    do {
+      if (in >= end) malformed();
+      b = *in++;
+      length += b;
+    } while (b == 255);
+    return length;
+  }
+}
+
+namespace Lz4 {
+  auto compressBound(const size_t count) -> size_t {
+    return count + count / 255 + 16;
+  }
+
+  auto compressBlock(const uint8_t* src, const size_t count, uint8_t* dst) -> size_t {
+    auto* out = dst;
+    size_t anchor = 0;
+
+    if (count > MatchSafeDistance) {
+      uint32_t table[1 << HashBits] = {};
+      auto matchLimit = count - LastLiterals;
+      auto searchLimit = count - MatchSafeDistance;
+
+      // Positions are stored +1 so that 0 means empty.
+      for (size_t pos = 0; pos < searchLimit;) {
+        auto sequence = load32(src + pos);
+        auto& slot = table[hash(sequence)];
+        auto candidate = static_cast<size_t>(slot);
+        slot = static_cast<uint32_t>(pos + 1);
+
+        if (candidate == 0 || pos - (candidate - 1) > MaxOffset || load32(src + candidate - 1) != sequence) {
+          // Long runs without a match take growing steps, so incompressible input is
+          // skimmed instead of probed at every byte.
+          pos += 1 + ((pos - anchor) >> 6);
+          continue;
+        }
+
+        auto match = candidate - 1;
+        auto length = MinMatch;
+        while (pos + length < matchLimit && src[match + length] == src[pos + length]) length++;
+
+        writeSequence(out, src + anchor, pos - anchor, length, pos - match);
+        pos += length;
+        anchor = pos;
+      }
+    }
+
+    writeSequence(out, src + anchor, count - anchor, 0, 0);
+    return static_cast<size_t>(out - dst);
+  }
+
+  auto decompressBlock(const uint8_t* src, const size_t count, uint8_t* dst, const size_t rawBytes) -> void {
+    const auto* in = src;
+    const auto* end = src + count;
+    size_t written = 0;
+
+    while (in < end) {
+      auto token = *in++;
+
+      size_t literals = token >> 4;
+      if (literals == 15) literals += readLength(in, end);
+      if (literals > static_cast<size_t>(end - in) || literals > rawBytes - written) malformed();
+      std::memcpy(dst + written, in, literals);
+      in += literals;
+      written += literals;
+
+      // The final sequence has literals only.
+      if (in == end) break;
+
+      if (end - in < 2) malformed();
+      auto offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+      in += 2;
+
+      size_t length = token & 0x0F;
+      if (length == 15) length += readLength(in, end);
+      length += MinMatch;
+
+      if (offset == 0 || offset > written || length > rawBytes - written) malformed();
+      // Overlapping matches repeat the bytes just written, so copy forwards byte by byte.
+      auto* copy = dst + written;
+      const auto* from = copy - offset;
+      if (offset >= length) {
+        std::memcpy(copy, from, length);
+      } else {
+        for (size_t i = 0; i < length; i++) copy[i] = from[i];
+      }
+      written += length;
+    }
+
+    if (written != rawBytes) malformed();
+  }
+}
@@ -0,0 +1,120 @@
+#include "steganography/compress/PayloadFrame.h"
+#include "steganography/compress/Lz4.h"
+#include "steganography/stats/Stats.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+  constexpr uint32_t StoredFlag = 0x80000000u;
+  constexpr size_t BlockWordBytes = 4;
+
+  auto storeLittleEndian(std::byte* p, const uint64_t value, const size_t bytes) -> void {
+    for (size_t i = 0; i < bytes; i++) p[i] = static_cast<std::byte>(value >> (8 * i));
+  }
+
+  auto loadLittleEndian(const std::byte* p, const size_t bytes) -> uint64_t {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) value |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return value;
+  }
+
+  [[noreturn]] auto malformed() -> void {
+    throw std::runtime_error("Corrupted compressed payload.");
+  }
+}
+
+namespace Compress {
+  auto compressFrame(std::span<const std::byte> payload) -> std::vector<std::byte> {
+    auto blocks = (payload.size() + FrameBlockBytes - 1) / FrameBlockBytes;
+    std::vector<std::byte> frame(FrameHeaderBytes + blocks * (BlockWordBytes + Lz4::compressBound(FrameBlockBytes)));
+    storeLittleEndian(frame.data(), payload.size(), FrameHeaderBytes);
+
+    auto size = FrameHeaderBytes;
+    for (size_t offset = 0; offset < payload.size(); offset += FrameBlockBytes) {
+      auto n = std::min(FrameBlockBytes, payload.size() - offset);
+      const auto* src = reinterpret_cast<const uint8_t*>(payload.data() + offset);
+      auto* word = frame.data() + size;
+      auto* out = word + BlockWordBytes;
+
+      auto stored = Lz4::compressBlock(src, n, reinterpret_cast<uint8_t*>(out));
+      uint32_t header = static_cast<uint32_t>(stored);
+      if (stored >= n) {
+        std::memcpy(out, src, n);
+        stored = n;
+        header = static_cast<uint32_t>(n) | StoredFlag;
+      }
+
+      storeLittleEndian(word, header, BlockWordBytes);
+      size += BlockWordBytes + stored;
+    }
+
+    frame.resize(size);
+    return frame;
+  }
+
+  auto FrameDecoder::feed(std::span<const std::byte> data, const Emit& emit) -> void {
+    // Only whole headers and blocks are decoded, so bytes wait in pending until the piece
+    // that completes them arrives.
+    while (!data.empty()) {
+      auto want = wanted();
+      auto n = std::min(data.size(), want - pending.size());
+      pending.insert(pending.end(), data.begin(), data.begin() + static_cast<std::ptrdiff_t>(n));
+      data = data.subspan(n);
+      if (pending.size() < want) continue;
+
+      if (!raw) {
+        raw = loadLittleEndian(pending.data(), FrameHeaderBytes);
+        pending.clear();
+      } else if (wanted() == pending.size()) {
+        decodeBlock(emit);
+      }
+    }
+  }
+
+  auto FrameDecoder::wanted() const -> size_t {
+    if (!raw) return FrameHeaderBytes;
+    if (pending.size() < BlockWordBytes) return BlockWordBytes;
+
+    auto stored = static_cast<size_t>(loadLittleEndian(pending.data(), BlockWordBytes) & ~StoredFlag);
+    if (stored > Lz4::compressBound(FrameBlockBytes)) malformed();
+    return BlockWordBytes + stored;
+  }
+
+  auto FrameDecoder::decodeBlock(const Emit& emit) -> void {
+    auto word = static_cast<uint32_t>(loadLittleEndian(pending.data(), BlockWordBytes));
+    auto stored = static_cast<size_t>(word & ~StoredFlag);
+    auto rawBytes = static_cast<size_t>(std::min<uint64_t>(FrameBlockBytes, *raw - emitted));
+    if (rawBytes == 0) malformed();
+
+    const auto* in = pending.data() + BlockWordBytes;
+    if (word & StoredFlag) {
+      if (stored != rawBytes) malformed();
+      emit(std::span(in, stored));
+    } else {
+      {
+        Stats::ScopedTimer timer(Stats::Phase::Decompress);
+        block.resize(rawBytes);
+        Lz4::decompressBlock(reinterpret_cast<const uint8_t*>(in), stored, reinterpret_cast<uint8_t*>(block.data()),
+            rawBytes);
+      }
+      emit(block);
+    }
+
+    emitted += rawBytes;
+    pending.clear();
+  }
+
+  auto FrameDecoder::finish() const -> void {
+    if (!raw || emitted != *raw || !pending.empty()) malformed();
+  }
+
+  auto FrameDecoder::rawSize() const -> std::optional<uint64_t> {
+    return raw;
+  }
+
+  auto FrameDecoder::readRawSize(std::span<const std::byte, FrameHeaderBytes> header) -> uint64_t {
+    return loadLittleEndian(header.data(), FrameHeaderBytes);
+  }
+}
@@ -0,0 +1,195 @@
+#include "steganography/concurrency/ThreadPool.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace {
+    // Identifies the pool and queue owned by the current worker thread, if any.
+    thread_local const ThreadPool* currentPool = nullptr;
+    thread_local size_t currentIndex = 0;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+
+    for (size_t i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+auto ThreadPool::defaultThreadCount() -> size_t {
+    auto count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+auto ThreadPool::size() const -> size_t {
+    return workers.size();
+}
+
+auto ThreadPool::submit(std::function<void()> task) -> void {
+    auto& queue = currentPool == this ? *queues[currentIndex] : injected;
+
+    unfinished.fetch_add(1, std::memory_order_relaxed);
+
+    // Counting the task under stateMutex pairs with the predicate check in workerLoop,
+    // so a worker about to sleep cannot miss it. A worker woken before the push below
+    // lands simply retries.
+    {
+        std::lock_guard lock(stateMutex);
+        queued.fetch_add(1, std::memory_order_release);
+    }
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    workAvailable.notify_one();
+}
+
+auto ThreadPool::takeTask(const size_t home, std::function<void()>& task) -> bool {
+    {
+        auto& own = *queues[home];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard lock(injected.mutex);
+        if (!injected.tasks.empty()) {
+            task = std::move(injected.tasks.front());
+            injected.tasks.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        auto& victim = *queues[(home + offset) % queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+auto ThreadPool::tryRunOne(const size_t home) -> bool {
+    std::function<void()> task;
+    if (!takeTask(home, task)) {
+        return false;
+    }
+
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    task();
+
+    if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard lock(stateMutex);
+        allDone.notify_all();
+    }
+
+    return true;
+}
+
+auto ThreadPool::workerLoop(const size_t index) -> void {
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+        if (tryRunOne(index)) {
+            continue;
+        }
+
+        std::unique_lock lock(stateMutex);
+        workAvailable.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping && queued.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+auto ThreadPool::waitIdle() -> void {
+    auto home = currentPool == this ? currentIndex : 0;
+    while (tryRunOne(home)) {}
+
+    std::unique_lock lock(stateMutex);
+    allDone.wait(lock, [this] { return unfinished.load(std::memory_order_acquire) == 0; });
+}
+
+auto ThreadPool::shared() -> ThreadPool& {
+    static ThreadPool pool;
+    return pool;
+}
+
+auto ThreadPool::parallelFor(const size_t count, size_t maxWorkers, const std::function<void(size_t)>& body) -> void {
+    if (count == 0) return;
+
+    maxWorkers = std::min({maxWorkers == 0 ? size() + 1 : maxWorkers, size() + 1, count});
+    if (maxWorkers <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            body(i);
+        }
+        return;
+    }
+
+    // Shared with the helpers so a helper that only starts after the loop has finished
+    // finds no index left and exits without touching the caller's frame.
+    struct Group {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> completed{0};
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+    auto group = std::make_shared<Group>();
+
+    auto work = [group, &body, count] {
+        size_t i;
+        while ((i = group->next.fetch_add(1, std::memory_order_relaxed)) < count) {
+            try {
+                body(i);
+            } catch (...) {
+                std::lock_guard lock(group->mutex);
+                if (!group->error) group->error = std::current_exception();
+            }
+
+            if (group->completed.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                std::lock_guard lock(group->mutex);
+                group->done.notify_all();
+            }
+        }
+    };
+
+    for (size_t i = 1; i < maxWorkers; i++) {
+        submit(work);
+    }
+    work();
+
+    std::unique_lock lock(group->mutex);
+    group->done.wait(lock, [&] { return group->completed.load(std::memory_order_acquire) == count; });
+    if (group->error) {
+        std::rethrow_exception(group->error);
+    }
+}
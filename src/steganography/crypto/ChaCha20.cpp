@@ -0,0 +1,239 @@
+#include "steganography/crypto/ChaCha20.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define STEG_HAVE_SSE2 1
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define STEG_HAVE_AVX2 1
+#endif
+
+namespace {
+  constexpr int DoubleRounds = 10;
+  constexpr size_t BlockBytes = Crypto::ChaCha20::BlockBytes;
+
+  auto load32(const uint8_t* p) -> uint32_t {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+  }
+
+  auto store32(uint8_t* p, const uint32_t value) -> void {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+  }
+
+  auto quarterRound(uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d) -> void {
+    a += b; d ^= a; d = std::rotl(d, 16);
+    c += d; b ^= c; b = std::rotl(b, 12);
+    a += b; d ^= a; d = std::rotl(d, 8);
+    c += d; b ^= c; b = std::rotl(b, 7);
+  }
+
+  auto xorBlock(uint8_t* data, const uint8_t* keystream, const size_t count) -> void {
+    for (size_t i = 0; i < count; i++) data[i] ^= keystream[i];
+  }
+
+#ifdef STEG_HAVE_SSE2
+  auto rotl(__m128i x, const int n) -> __m128i {
+    return _mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - n));
+  }
+
+  auto quarterRound(__m128i& a, __m128i& b, __m128i& c, __m128i& d) -> void {
+    a = _mm_add_epi32(a, b); d = rotl(_mm_xor_si128(d, a), 16);
+    c = _mm_add_epi32(c, d); b = rotl(_mm_xor_si128(b, c), 12);
+    a = _mm_add_epi32(a, b); d = rotl(_mm_xor_si128(d, a), 8);
+    c = _mm_add_epi32(c, d); b = rotl(_mm_xor_si128(b, c), 7);
+  }
+
+  auto xor16(uint8_t* data, const __m128i keystream) -> void {
+    auto* p = reinterpret_cast<__m128i*>(data);
+    _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), keystream));
+  }
+
+  // Four consecutive blocks, one per 32-bit lane: v[i] holds word i of every block.
+  auto xorBlocksSSE2(const std::array<uint32_t, 16>& input, const uint64_t counter, uint8_t* data) -> void {
+    __m128i v[16], x[16];
+    for (int i = 0; i < 16; i++) v[i] = _mm_set1_epi32(static_cast<int>(input[i]));
+
+    uint64_t c[4] = {counter, counter + 1, counter + 2, counter + 3};
+    v[12] = _mm_set_epi32(static_cast<int>(c[3]), static_cast<int>(c[2]), static_cast<int>(c[1]),
+        static_cast<int>(c[0]));
+    v[13] = _mm_set_epi32(static_cast<int>(c[3] >> 32), static_cast<int>(c[2] >> 32),
+        static_cast<int>(c[1] >> 32), static_cast<int>(c[0] >> 32));
+
+    std::copy(std::begin(v), std::end(v), std::begin(x));
+    for (int round = 0; round < DoubleRounds; round++) {
+      quarterRound(x[0], x[4], x[8], x[12]);
+      quarterRound(x[1], x[5], x[9], x[13]);
+      quarterRound(x[2], x[6], x[10], x[14]);
+      quarterRound(x[3], x[7], x[11], x[15]);
+      quarterRound(x[0], x[5], x[10], x[15]);
+      quarterRound(x[1], x[6], x[11], x[12]);
+      quarterRound(x[2], x[7], x[8], x[13]);
+      quarterRound(x[3], x[4], x[9], x[14]);
+    }
+    for (int i = 0; i < 16; i++) x[i] = _mm_add_epi32(x[i], v[i]);
+
+    // Transpose each group of four words back into per-block order.
+    for (int g = 0; g < 4; g++) {
+      auto t0 = _mm_unpacklo_epi32(x[4 * g], x[4 * g + 1]);
+      auto t1 = _mm_unpacklo_epi32(x[4 * g + 2], x[4 * g + 3]);
+      auto t2 = _mm_unpackhi_epi32(x[4 * g], x[4 * g + 1]);
+      auto t3 = _mm_unpackhi_epi32(x[4 * g + 2], x[4 * g + 3]);
+
+      xor16(data + 16 * g, _mm_unpacklo_epi64(t0, t1));
+      xor16(data + BlockBytes + 16 * g, _mm_unpackhi_epi64(t0, t1));
+      xor16(data + 2 * BlockBytes + 16 * g, _mm_unpacklo_epi64(t2, t3));
+      xor16(data + 3 * BlockBytes + 16 * g, _mm_unpackhi_epi64(t2, t3));
+    }
+  }
+#endif
+
+#ifdef STEG_HAVE_AVX2
+  auto rotl(__m256i x, const int n) -> __m256i {
+    return _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - n));
+  }
+
+  auto quarterRound(__m256i& a, __m256i& b, __m256i& c, __m256i& d) -> void {
+    // Byte-aligned rotations are single shuffles.
+    const auto rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const auto rot8 = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+        3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+
+    a = _mm256_add_epi32(a, b); d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot16);
+    c = _mm256_add_epi32(c, d); b = rotl(_mm256_xor_si256(b, c), 12);
+    a = _mm256_add_epi32(a, b); d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot8);
+    c = _mm256_add_epi32(c, d); b = rotl(_mm256_xor_si256(b, c), 7);
+  }
+
+  auto xor32(uint8_t* data, const __m256i keystream) -> void {
+    auto* p = reinterpret_cast<__m256i*>(data);
+    _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), keystream));
+  }
+
+  // Eight consecutive blocks, one per 32-bit lane.
+  auto xorBlocksAVX2(const std::array<uint32_t, 16>& input, const uint64_t counter, uint8_t* data) -> void {
+    __m256i v[16], x[16];
+    for (int i = 0; i < 16; i++) v[i] = _mm256_set1_epi32(static_cast<int>(input[i]));
+
+    int lo[8], hi[8];
+    for (int j = 0; j < 8; j++) {
+      lo[j] = static_cast<int>(counter + j);
+      hi[j] = static_cast<int>((counter + j) >> 32);
+    }
+    v[12] = _mm256_setr_epi32(lo[0], lo[1], lo[2], lo[3], lo[4], lo[5], lo[6], lo[7]);
+    v[13] = _mm256_setr_epi32(hi[0], hi[1], hi[2], hi[3], hi[4], hi[5], hi[6], hi[7]);
+
+    std::copy(std::begin(v), std::end(v), std::begin(x));
+    for (int round = 0; round < DoubleRounds; round++) {
+      quarterRound(x[0], x[4], x[8], x[12]);
+      quarterRound(x[1], x[5], x[9], x[13]);
+      quarterRound(x[2], x[6], x[10], x[14]);
+      quarterRound(x[3], x[7], x[11], x[15]);
+      quarterRound(x[0], x[5], x[10], x[15]);
+      quarterRound(x[1], x[6], x[11], x[12]);
+      quarterRound(x[2], x[7], x[8], x[13]);
+      quarterRound(x[3], x[4], x[9], x[14]);
+    }
+    for (int i = 0; i < 16; i++) x[i] = _mm256_add_epi32(x[i], v[i]);
+
+    // Transposing within each 128-bit lane leaves blocks 0-3 in the low lanes and
+    // blocks 4-7 in the high lanes; lane permutes then join the halves of each block.
+    __m256i rows[4][4];
+    for (int g = 0; g < 4; g++) {
+      auto t0 = _mm256_unpacklo_epi32(x[4 * g], x[4 * g + 1]);
+      auto t1 = _mm256_unpacklo_epi32(x[4 * g + 2], x[4 * g + 3]);
+      auto t2 = _mm256_unpackhi_epi32(x[4 * g], x[4 * g + 1]);
+      auto t3 = _mm256_unpackhi_epi32(x[4 * g + 2], x[4 * g + 3]);
+      rows[0][g] = _mm256_unpacklo_epi64(t0, t1);
+      rows[1][g] = _mm256_unpackhi_epi64(t0, t1);
+      rows[2][g] = _mm256_unpacklo_epi64(t2, t3);
+      rows[3][g] = _mm256_unpackhi_epi64(t2, t3);
+    }
+
+    for (int j = 0; j < 4; j++) {
+      auto* low = data + j * BlockBytes;
+      auto* high = data + (j + 4) * BlockBytes;
+      xor32(low, _mm256_permute2x128_si256(rows[j][0], rows[j][1], 0x20));
+      xor32(low + 32, _mm256_permute2x128_si256(rows[j][2], rows[j][3], 0x20));
+      xor32(high, _mm256_permute2x128_si256(rows[j][0], rows[j][1], 0x31));
+      xor32(high + 32, _mm256_permute2x128_si256(rows[j][2], rows[j][3], 0x31));
+    }
+  }
+#endif
+}
+
+namespace Crypto {
+  ChaCha20::ChaCha20(std::span<const uint8_t, KeyBytes> key, const uint64_t nonce) {
+    // "expand 32-byte k"
+    input[0] = 0x61707865;
+    input[1] = 0x3320646e;
+    input[2] = 0x79622d32;
+    input[3] = 0x6b206574;
+    for (int i = 0; i < 8; i++) {
+      input[4 + i] = load32(key.data() + 4 * i);
+    }
+    input[14] = static_cast<uint32_t>(nonce);
+    input[15] = static_cast<uint32_t>(nonce >> 32);
+  }
+
+  auto ChaCha20::block(const uint64_t counter, uint8_t* out) const -> void {
+    auto x = input;
+    x[12] = static_cast<uint32_t>(counter);
+    x[13] = static_cast<uint32_t>(counter >> 32);
+    auto state = x;
+
+    for (int round = 0; round < DoubleRounds; round++) {
+      quarterRound(x[0], x[4], x[8], x[12]);
+      quarterRound(x[1], x[5], x[9], x[13]);
+      quarterRound(x[2], x[6], x[10], x[14]);
+      quarterRound(x[3], x[7], x[11], x[15]);
+      quarterRound(x[0], x[5], x[10], x[15]);
+      quarterRound(x[1], x[6], x[11], x[12]);
+      quarterRound(x[2], x[7], x[8], x[13]);
+      quarterRound(x[3], x[4], x[9], x[14]);
+    }
+
+    for (int i = 0; i < 16; i++) {
+      store32(out + 4 * i, x[i] + state[i]);
+    }
+  }
+
+  auto ChaCha20::apply(uint8_t* data, const size_t count, const uint64_t offset) const -> void {
+    uint8_t keystream[BlockBytes];
+    auto counter = offset / BlockBytes;
+    size_t done = 0;
+
+    // A range that starts inside a block uses the rest of that block first.
+    if (auto skip = static_cast<size_t>(offset % BlockBytes); skip != 0 && count > 0) {
+      block(counter++, keystream);
+      done = std::min(count, BlockBytes - skip);
+      xorBlock(data, keystream + skip, done);
+    }
+
+#ifdef STEG_HAVE_AVX2
+    for (; count - done >= 8 * BlockBytes; done += 8 * BlockBytes, counter += 8) {
+      xorBlocksAVX2(input, counter, data + done);
+    }
+#endif
+#ifdef STEG_HAVE_SSE2
+    for (; count - done >= 4 * BlockBytes; done += 4 * BlockBytes, counter += 4) {
+      xorBlocksSSE2(input, counter, data + done);
+    }
+#endif
+
+    for (; done < count; done += BlockBytes, counter++) {
+      block(counter, keystream);
+      xorBlock(data + done, keystream, std::min(BlockBytes, count - done));
+    }
+  }
+}
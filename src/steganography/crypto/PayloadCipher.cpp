@@ -0,0 +1,73 @@
+#include "steganography/crypto/PayloadCipher.h"
+#include "steganography/crypto/Sha256.h"
+
+#include <random>
+#include <string_view>
+#include <utility>
+
+namespace {
+  auto deriveKey(const std::string& passphrase, const Crypto::Salt& salt) -> std::array<uint8_t, Crypto::ChaCha20::KeyBytes> {
+    std::array<uint8_t, Crypto::ChaCha20::KeyBytes> key;
+    Crypto::pbkdf2Sha256(std::span(reinterpret_cast<const uint8_t*>(passphrase.data()), passphrase.size()), salt,
+        Crypto::KdfIterations, key);
+    return key;
+  }
+
+  auto checkFor(std::span<const uint8_t> key) -> uint32_t {
+    constexpr std::string_view Label = "ImageSteg key check";
+    auto mac = Crypto::hmacSha256(key, std::span(reinterpret_cast<const uint8_t*>(Label.data()), Label.size()));
+    return (static_cast<uint32_t>(mac[0]) << 24) | (static_cast<uint32_t>(mac[1]) << 16) |
+           (static_cast<uint32_t>(mac[2]) << 8) | mac[3];
+  }
+}
+
+namespace Crypto {
+  auto randomSalt() -> Salt {
+    std::random_device device;
+    Salt salt;
+    for (size_t i = 0; i < salt.size(); i += 4) {
+      auto value = device();
+      for (size_t j = 0; j < 4; j++) salt[i + j] = static_cast<uint8_t>(value >> (8 * j));
+    }
+    return salt;
+  }
+
+  PayloadCipher::PayloadCipher(std::string key) : key(std::move(key)) {
+    check = checkFor(std::span(reinterpret_cast<const uint8_t*>(this->key.data()), this->key.size()));
+  }
+
+  PayloadCipher::PayloadCipher(const std::string& passphrase, const Salt& salt) {
+    auto derived = deriveKey(passphrase, salt);
+    chacha.emplace(derived);
+    check = checkFor(derived);
+  }
+
+  auto PayloadCipher::apply(uint8_t* data, const size_t count, const uint64_t offset) const -> void {
+    if (chacha) {
+      chacha->apply(data, count, offset);
+      return;
+    }
+    if (key.empty()) return;
+
+    const auto* k = reinterpret_cast<const uint8_t*>(key.data());
+    const auto keyLength = key.size();
+    auto index = static_cast<size_t>(offset % keyLength);
+
+    for (size_t i = 0; i < count; i++) {
+      data[i] ^= k[index];
+      if (++index == keyLength) index = 0;
+    }
+  }
+
+  auto PayloadCipher::isIdentity() const -> bool {
+    return !chacha && key.empty();
+  }
+
+  auto PayloadCipher::getCipher() const -> Cipher {
+    return chacha ? Cipher::ChaCha20 : Cipher::RepeatingKey;
+  }
+
+  auto PayloadCipher::keyCheck() const -> uint32_t {
+    return check;
+  }
+}
@@ -0,0 +1,188 @@
+#include "steganography/crypto/Sha256.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+  constexpr std::array<uint32_t, 64> RoundConstants = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+  };
+
+  constexpr std::array<uint32_t, 8> InitialState = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+  };
+
+  auto loadBigEndian(const uint8_t* p) -> uint32_t {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+  }
+
+  auto storeBigEndian(uint8_t* p, const uint32_t value) -> void {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+  }
+
+  // The HMAC key block XORed with ipad or opad, absorbed once so every PBKDF2 iteration
+  // costs only the two compressions of its own message.
+  auto keyedHash(std::span<const uint8_t> key, const uint8_t pad) -> Crypto::Sha256 {
+    std::array<uint8_t, Crypto::Sha256::BlockBytes> block = {};
+    if (key.size() > block.size()) {
+      auto digest = Crypto::Sha256::hash(key);
+      std::copy(digest.begin(), digest.end(), block.begin());
+    } else {
+      std::copy(key.begin(), key.end(), block.begin());
+    }
+    for (auto& b : block) b ^= pad;
+
+    Crypto::Sha256 hash;
+    hash.update(block);
+    return hash;
+  }
+
+  auto hmac(const Crypto::Sha256& inner, const Crypto::Sha256& outer, std::span<const uint8_t> message)
+      -> Crypto::Sha256::Digest {
+    auto innerHash = inner;
+    innerHash.update(message);
+    auto innerDigest = innerHash.finish();
+
+    auto outerHash = outer;
+    outerHash.update(innerDigest);
+    return outerHash.finish();
+  }
+}
+
+namespace Crypto {
+  Sha256::Sha256() : state(InitialState) {}
+
+  auto Sha256::update(std::span<const uint8_t> data) -> void {
+    totalBytes += data.size();
+
+    if (buffered > 0) {
+      auto n = std::min(data.size(), BlockBytes - buffered);
+      std::memcpy(buffer.data() + buffered, data.data(), n);
+      buffered += n;
+      data = data.subspan(n);
+      if (buffered < BlockBytes) return;
+      compress(buffer.data());
+      buffered = 0;
+    }
+
+    while (data.size() >= BlockBytes) {
+      compress(data.data());
+      data = data.subspan(BlockBytes);
+    }
+
+    std::memcpy(buffer.data(), data.data(), data.size());
+    buffered = data.size();
+  }
+
+  auto Sha256::finish() -> Digest {
+    auto bitLength = totalBytes * 8;
+
+    buffer[buffered++] = 0x80;
+    if (buffered > BlockBytes - 8) {
+      std::fill(buffer.begin() + static_cast<std::ptrdiff_t>(buffered), buffer.end(), 0);
+      compress(buffer.data());
+      buffered = 0;
+    }
+    std::fill(buffer.begin() + static_cast<std::ptrdiff_t>(buffered), buffer.end() - 8, 0);
+    storeBigEndian(buffer.data() + BlockBytes - 8, static_cast<uint32_t>(bitLength >> 32));
+    storeBigEndian(buffer.data() + BlockBytes - 4, static_cast<uint32_t>(bitLength));
+    compress(buffer.data());
+
+    Digest digest;
+    for (size_t i = 0; i < state.size(); i++) {
+      storeBigEndian(digest.data() + 4 * i, state[i]);
+    }
+    return digest;
+  }
+
+  auto Sha256::hash(std::span<const uint8_t> data) -> Digest {
+    Sha256 hash;
+    hash.update(data);
+    return hash.finish();
+  }
+
+  auto Sha256::compress(const uint8_t* block) -> void {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+      w[i] = loadBigEndian(block + 4 * i);
+    }
+    for (int i = 16; i < 64; i++) {
+      auto s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      auto s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    auto [a, b, c, d, e, f, g, h] = state;
+    for (int i = 0; i < 64; i++) {
+      auto s1 = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+      auto choice = (e & f) ^ (~e & g);
+      auto t1 = h + s1 + choice + RoundConstants[i] + w[i];
+      auto s0 = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+      auto majority = (a & b) ^ (a & c) ^ (b & c);
+      auto t2 = s0 + majority;
+
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+
+  auto hmacSha256(std::span<const uint8_t> key, std::span<const uint8_t> message) -> Sha256::Digest {
+    return hmac(keyedHash(key, 0x36), keyedHash(key, 0x5c), message);
+  }
+
+  auto pbkdf2Sha256(std::span<const uint8_t> password, std::span<const uint8_t> salt, const uint32_t iterations,
+      std::span<uint8_t> out) -> void {
+    auto inner = keyedHash(password, 0x36);
+    auto outer = keyedHash(password, 0x5c);
+
+    for (uint32_t block = 1; !out.empty(); block++) {
+      auto saltHash = inner;
+      saltHash.update(salt);
+      uint8_t index[4];
+      storeBigEndian(index, block);
+      saltHash.update(index);
+      auto innerDigest = saltHash.finish();
+
+      auto outerHash = outer;
+      outerHash.update(innerDigest);
+      auto u = outerHash.finish();
+      auto t = u;
+
+      for (uint32_t i = 1; i < iterations; i++) {
+        u = hmac(inner, outer, u);
+        for (size_t j = 0; j < t.size(); j++) t[j] ^= u[j];
+      }
+
+      auto n = std::min(out.size(), t.size());
+      std::copy_n(t.begin(), n, out.begin());
+      out = out.subspan(n);
+    }
+  }
+}
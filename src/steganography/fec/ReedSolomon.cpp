@@ -0,0 +1,505 @@
+#include "steganography/fec/ReedSolomon.h"
+#include "steganography/stats/Stats.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define STEG_HAVE_SSSE3 1
+#endif
+
+namespace {
+  constexpr size_t RowBytes = Fec::InterleaveCodewords;
+
+  // GF(2^8) with the primitive polynomial x^8 + x^4 + x^3 + x^2 + 1 and generator 2.
+  struct Field {
+    std::array<uint8_t, 512> exp{};
+    std::array<int, 256> log{};
+
+    Field() {
+      int value = 1;
+      for (int i = 0; i < 255; i++) {
+        exp[i] = exp[i + 255] = static_cast<uint8_t>(value);
+        log[value] = i;
+        value <<= 1;
+        if (value & 0x100) value ^= 0x11D;
+      }
+    }
+  };
+
+  const Field field;
+
+  auto multiply(const uint8_t a, const uint8_t b) -> uint8_t {
+    return a == 0 || b == 0 ? 0 : field.exp[field.log[a] + field.log[b]];
+  }
+
+  auto divide(const uint8_t a, const uint8_t b) -> uint8_t {
+    return a == 0 ? 0 : field.exp[field.log[a] + 255 - field.log[b]];
+  }
+
+  // alpha^power for any power, negative ones included.
+  auto power(const int exponent) -> uint8_t {
+    return field.exp[((exponent % 255) + 255) % 255];
+  }
+
+  // Products of one constant with every byte value, and with every value of the low and
+  // of the high nibble, whose products XOR to the product with the whole byte.
+  struct ProductTable {
+    alignas(16) std::array<uint8_t, 16> low{};
+    alignas(16) std::array<uint8_t, 16> high{};
+    std::array<uint8_t, 256> full{};
+
+    explicit ProductTable(const uint8_t constant) {
+      for (int i = 0; i < 16; i++) {
+        low[i] = multiply(constant, static_cast<uint8_t>(i));
+        high[i] = multiply(constant, static_cast<uint8_t>(i << 4));
+      }
+      for (int i = 0; i < 256; i++) {
+        full[i] = multiply(constant, static_cast<uint8_t>(i));
+      }
+    }
+  };
+
+  // One byte of each codeword of a group, worked on together.
+#ifdef STEG_HAVE_SSSE3
+  struct Row {
+    __m128i bytes;
+  };
+
+  auto loadRow(const uint8_t* bytes) -> Row {
+    return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes))};
+  }
+
+  auto storeRow(uint8_t* bytes, const Row& row) -> void {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), row.bytes);
+  }
+
+  auto zeroRow() -> Row {
+    return {_mm_setzero_si128()};
+  }
+
+  auto xorRows(const Row& a, const Row& b) -> Row {
+    return {_mm_xor_si128(a.bytes, b.bytes)};
+  }
+
+  // Two PSHUFB lookups, one per nibble, multiply all 16 bytes at once.
+  auto multiplyRow(const Row& row, const ProductTable& table) -> Row {
+    const auto mask = _mm_set1_epi8(0x0F);
+    auto low = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(table.low.data())),
+        _mm_and_si128(row.bytes, mask));
+    auto high = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(table.high.data())),
+        _mm_and_si128(_mm_srli_epi64(row.bytes, 4), mask));
+    return {_mm_xor_si128(low, high)};
+  }
+
+  auto isZero(const Row& row) -> bool {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(row.bytes, _mm_setzero_si128())) == 0xFFFF;
+  }
+#else
+  struct Row {
+    std::array<uint8_t, RowBytes> bytes{};
+  };
+
+  auto loadRow(const uint8_t* bytes) -> Row {
+    Row row;
+    std::memcpy(row.bytes.data(), bytes, RowBytes);
+    return row;
+  }
+
+  auto storeRow(uint8_t* bytes, const Row& row) -> void {
+    std::memcpy(bytes, row.bytes.data(), RowBytes);
+  }
+
+  auto zeroRow() -> Row {
+    return {};
+  }
+
+  auto xorRows(Row a, const Row& b) -> Row {
+    for (size_t i = 0; i < RowBytes; i++) a.bytes[i] ^= b.bytes[i];
+    return a;
+  }
+
+  auto multiplyRow(Row row, const ProductTable& table) -> Row {
+    for (auto& byte : row.bytes) byte = table.full[byte];
+    return row;
+  }
+
+  auto isZero(const Row& row) -> bool {
+    return std::ranges::all_of(row.bytes, [](const uint8_t byte) { return byte == 0; });
+  }
+#endif
+
+  auto laneOf(const Row& row, const size_t lane) -> uint8_t {
+    alignas(16) std::array<uint8_t, RowBytes> bytes;
+    storeRow(bytes.data(), row);
+    return bytes[lane];
+  }
+
+  // The generator polynomial for one parity, prod (x + alpha^i) for i < parity, and the
+  // tables for its coefficients and for the syndrome roots.
+  struct Code {
+    std::vector<uint8_t> generator;
+    std::vector<ProductTable> generatorTables;
+    std::vector<ProductTable> rootTables;
+
+    explicit Code(const int parity) : generator(static_cast<size_t>(parity) + 1, 0) {
+      generator[0] = 1;
+      for (int i = 0; i < parity; i++) {
+        auto root = power(i);
+        for (int j = i + 1; j > 0; j--) {
+          generator[j] = generator[j - 1] ^ multiply(generator[j], root);
+        }
+        generator[0] = multiply(generator[0], root);
+      }
+
+      for (int i = 0; i < parity; i++) {
+        generatorTables.emplace_back(generator[i]);
+        rootTables.emplace_back(power(i));
+      }
+    }
+  };
+
+  auto codeFor(const int parity) -> const Code& {
+    static std::array<std::once_flag, Fec::MaxParity + 1> once;
+    static std::array<std::unique_ptr<Code>, Fec::MaxParity + 1> codes;
+
+    std::call_once(once[parity], [parity] { codes[parity] = std::make_unique<Code>(parity); });
+    return *codes[parity];
+  }
+
+  auto requireParity(const int parity) -> void {
+    if (!Fec::isValidParity(parity)) {
+      throw std::invalid_argument("Unsupported error correction parity: " + std::to_string(parity));
+    }
+  }
+
+  // The shape of one group: its data bytes, codewords and data rows.
+  struct Group {
+    size_t dataBytes = 0;
+    size_t codewords = 0;
+    size_t rows = 0;
+
+    [[nodiscard]] auto codedBytes(const int parity) const -> size_t {
+      return dataBytes + codewords * static_cast<size_t>(parity);
+    }
+  };
+
+  auto groupFor(const size_t dataBytes, const int parity) -> Group {
+    auto k = Fec::CodewordBytes - static_cast<size_t>(parity);
+    auto codewords = (dataBytes + k - 1) / k;
+    return {dataBytes, codewords, (dataBytes + codewords - 1) / codewords};
+  }
+
+  auto fullGroupDataBytes(const int parity) -> size_t {
+    return Fec::InterleaveCodewords * (Fec::CodewordBytes - static_cast<size_t>(parity));
+  }
+
+  // The group whose coded size is codedBytes, if any.
+  auto groupWithCodedBytes(const size_t codedBytes, const int parity) -> std::optional<Group> {
+    for (size_t codewords = 1; codewords <= Fec::InterleaveCodewords; codewords++) {
+      auto parityBytes = codewords * static_cast<size_t>(parity);
+      if (codedBytes <= parityBytes) break;
+
+      auto group = groupFor(codedBytes - parityBytes, parity);
+      if (group.codewords == codewords) return group;
+    }
+    return std::nullopt;
+  }
+
+  // Data row r of a group, with the bytes past the data (the known zeros of short
+  // codewords, and lanes of unused codewords) as 0.
+  auto dataRow(const uint8_t* data, const Group& group, const size_t r) -> Row {
+    auto offset = r * group.codewords;
+    auto count = std::min(group.codewords, group.dataBytes - offset);
+    if (count == RowBytes) return loadRow(data + offset);
+
+    alignas(16) std::array<uint8_t, RowBytes> bytes{};
+    std::memcpy(bytes.data(), data + offset, count);
+    return loadRow(bytes.data());
+  }
+
+  auto parityRow(const uint8_t* parityRows, const Group& group, const size_t r) -> Row {
+    if (group.codewords == RowBytes) return loadRow(parityRows + r * RowBytes);
+
+    alignas(16) std::array<uint8_t, RowBytes> bytes{};
+    std::memcpy(bytes.data(), parityRows + r * group.codewords, group.codewords);
+    return loadRow(bytes.data());
+  }
+
+  // Appends the parity rows of one group: the remainder of each codeword divided by the
+  // generator, highest power first, computed by one LFSR step per data row.
+  auto encodeGroup(const uint8_t* data, const Group& group, const Code& code, const int parity, uint8_t* out)
+    -> void {
+    std::vector<Row> remainder(static_cast<size_t>(parity), zeroRow());
+    for (size_t r = 0; r < group.rows; r++) {
+      auto feedback = xorRows(dataRow(data, group, r), remainder[parity - 1]);
+      for (int i = parity - 1; i > 0; i--) {
+        remainder[i] = xorRows(remainder[i - 1], multiplyRow(feedback, code.generatorTables[i]));
+      }
+      remainder[0] = multiplyRow(feedback, code.generatorTables[0]);
+    }
+
+    alignas(16) std::array<uint8_t, RowBytes> bytes;
+    for (int r = 0; r < parity; r++) {
+      storeRow(bytes.data(), remainder[parity - 1 - r]);
+      std::memcpy(out + static_cast<size_t>(r) * group.codewords, bytes.data(), group.codewords);
+    }
+  }
+
+  // Corrects one codeword from its syndromes: Berlekamp-Massey for the error locator, a
+  // Chien search for the positions and Forney's formula for the values. Positions count
+  // from the first byte of the codeword, whose length is length. fix(position, value)
+  // applies a correction; returns false if the errors are beyond correction.
+  template <typename Fix>
+  auto correct(const std::vector<uint8_t>& syndromes, const size_t length, Fix&& fix) -> bool {
+    auto parity = syndromes.size();
+    std::vector<uint8_t> locator(parity + 1, 0);
+    std::vector<uint8_t> previous(parity + 1, 0);
+    locator[0] = previous[0] = 1;
+    size_t degree = 0;
+    size_t shift = 1;
+    uint8_t previousDiscrepancy = 1;
+
+    for (size_t n = 0; n < parity; n++) {
+      auto discrepancy = syndromes[n];
+      for (size_t i = 1; i <= degree; i++) {
+        discrepancy ^= multiply(locator[i], syndromes[n - i]);
+      }
+      if (discrepancy == 0) {
+        shift++;
+        continue;
+      }
+
+      auto scale = divide(discrepancy, previousDiscrepancy);
+      auto updated = locator;
+      for (size_t i = 0; i + shift <= parity; i++) {
+        updated[i + shift] ^= multiply(scale, previous[i]);
+      }
+      if (2 * degree <= n) {
+        previous = locator;
+        degree = n + 1 - degree;
+        previousDiscrepancy = discrepancy;
+        shift = 1;
+      } else {
+        shift++;
+      }
+      locator = std::move(updated);
+    }
+    if (2 * degree > parity) return false;
+
+    // Omega(x) = S(x) * Lambda(x) mod x^parity.
+    std::vector<uint8_t> evaluator(parity, 0);
+    for (size_t i = 0; i < parity; i++) {
+      for (size_t j = 0; j <= std::min(i, degree); j++) {
+        evaluator[i] ^= multiply(locator[j], syndromes[i - j]);
+      }
+    }
+
+    size_t found = 0;
+    for (size_t position = 0; position < length; position++) {
+      // The byte at position is the coefficient of x^(length - 1 - position).
+      auto exponent = static_cast<int>(length - 1 - position);
+      auto inverse = power(-exponent);
+
+      uint8_t value = 0;
+      uint8_t x = 1;
+      for (size_t i = 0; i <= degree; i++) {
+        value ^= multiply(locator[i], x);
+        x = multiply(x, inverse);
+      }
+      if (value != 0) continue;
+
+      uint8_t numerator = 0;
+      x = 1;
+      for (size_t i = 0; i < parity; i++) {
+        numerator ^= multiply(evaluator[i], x);
+        x = multiply(x, inverse);
+      }
+      // Lambda'(x) keeps the odd terms: sum of locator[i] x^(i - 1) for odd i.
+      uint8_t denominator = 0;
+      auto inverseSquared = multiply(inverse, inverse);
+      x = 1;
+      for (size_t i = 1; i <= degree; i += 2) {
+        denominator ^= multiply(locator[i], x);
+        x = multiply(x, inverseSquared);
+      }
+      if (denominator == 0) return false;
+
+      if (!fix(position, multiply(power(exponent), divide(numerator, denominator)))) return false;
+      found++;
+    }
+    return found == degree;
+  }
+}
+
+namespace Fec {
+  auto isValidParity(const int parity) -> bool {
+    return parity >= MinParity && parity <= MaxParity && parity % 2 == 0;
+  }
+
+  auto codedBytes(const uint64_t dataBytes, const int parity) -> uint64_t {
+    if (parity == 0) return dataBytes;
+
+    auto k = CodewordBytes - static_cast<uint64_t>(parity);
+    return dataBytes + (dataBytes + k - 1) / k * static_cast<uint64_t>(parity);
+  }
+
+  auto dataBytes(const uint64_t codedBytes, const int parity) -> std::optional<uint64_t> {
+    if (parity == 0) return codedBytes;
+
+    auto fullCoded = InterleaveCodewords * CodewordBytes;
+    auto full = codedBytes / fullCoded;
+    auto rest = static_cast<size_t>(codedBytes % fullCoded);
+    auto data = full * fullGroupDataBytes(parity);
+    if (rest == 0) return data;
+
+    auto group = groupWithCodedBytes(rest, parity);
+    if (!group) return std::nullopt;
+    return data + group->dataBytes;
+  }
+
+  auto maxDataBytes(const uint64_t codedBytes, const int parity) -> uint64_t {
+    if (parity == 0) return codedBytes;
+
+    auto k = CodewordBytes - static_cast<uint64_t>(parity);
+    // codedBytes(d) grows with d, so step down from an estimate that is never too low by
+    // more than a codeword.
+    auto data = codedBytes / CodewordBytes * k + std::min<uint64_t>(codedBytes % CodewordBytes, k);
+    while (data > 0 && Fec::codedBytes(data, parity) > codedBytes) {
+      data--;
+    }
+    return data;
+  }
+
+  auto encode(std::span<const std::byte> data, const int parity) -> std::vector<std::byte> {
+    requireParity(parity);
+    const auto& code = codeFor(parity);
+
+    std::vector<std::byte> out(static_cast<size_t>(codedBytes(data.size(), parity)));
+    const auto* in = reinterpret_cast<const uint8_t*>(data.data());
+    auto* coded = reinterpret_cast<uint8_t*>(out.data());
+
+    for (size_t done = 0; done < data.size();) {
+      auto group = groupFor(std::min(fullGroupDataBytes(parity), data.size() - done), parity);
+      std::memcpy(coded, in + done, group.dataBytes);
+      encodeGroup(in + done, group, code, parity, coded + group.dataBytes);
+
+      coded += group.codedBytes(parity);
+      done += group.dataBytes;
+    }
+    return out;
+  }
+
+  auto forEachData(std::span<const std::byte> coded, const int parity,
+      const std::function<void(std::span<const std::byte>)>& visit) -> void {
+    requireParity(parity);
+
+    auto fullCoded = InterleaveCodewords * CodewordBytes;
+    while (!coded.empty()) {
+      auto group = coded.size() >= fullCoded
+          ? groupFor(fullGroupDataBytes(parity), parity)
+          : groupWithCodedBytes(coded.size(), parity).value_or(Group{});
+      if (group.dataBytes == 0) {
+        throw std::runtime_error("Corrupted error correction layout.");
+      }
+
+      visit(coded.first(group.dataBytes));
+      coded = coded.subspan(group.codedBytes(parity));
+    }
+  }
+
+  Decoder::Decoder(const uint64_t codedBytes, const int parity) : parity(parity), remaining(codedBytes) {
+    requireParity(parity);
+    if (!dataBytes(codedBytes, parity)) {
+      throw std::runtime_error("Corrupted error correction layout.");
+    }
+    group.reserve(InterleaveCodewords * CodewordBytes);
+  }
+
+  auto Decoder::feed(std::span<const std::byte> data, const Emit& emit) -> void {
+    while (!data.empty()) {
+      if (remaining == 0) {
+        throw std::runtime_error("Corrupted error correction layout.");
+      }
+      if (groupBytes == 0) {
+        groupBytes = static_cast<size_t>(std::min<uint64_t>(remaining, InterleaveCodewords * CodewordBytes));
+      }
+
+      auto n = std::min(data.size(), groupBytes - group.size());
+      group.insert(group.end(), data.begin(), data.begin() + static_cast<std::ptrdiff_t>(n));
+      data = data.subspan(n);
+
+      if (group.size() == groupBytes) {
+        decodeGroup(emit);
+      }
+    }
+  }
+
+  auto Decoder::finish() const -> void {
+    if (remaining != 0) {
+      throw std::runtime_error("Error corrected payload is truncated.");
+    }
+  }
+
+  auto Decoder::corrected() const -> uint64_t {
+    return correctedBytes;
+  }
+
+  auto Decoder::decodeGroup(const Emit& emit) -> void {
+    const auto& code = codeFor(parity);
+    auto shape = *groupWithCodedBytes(groupBytes, parity);
+    auto* data = reinterpret_cast<uint8_t*>(group.data());
+    const auto* parityRows = data + shape.dataBytes;
+
+    {
+      Stats::ScopedTimer timer(Stats::Phase::ErrorCorrection);
+
+      // Horner's rule on every codeword at once: s_i = s_i * alpha^i + byte, over the
+      // data rows and then the parity rows.
+      std::vector<Row> syndromes(static_cast<size_t>(parity), zeroRow());
+      auto step = [&](const Row row) {
+        for (int i = 0; i < parity; i++) {
+          syndromes[i] = xorRows(multiplyRow(syndromes[i], code.rootTables[i]), row);
+        }
+      };
+      for (size_t r = 0; r < shape.rows; r++) step(dataRow(data, shape, r));
+      for (size_t r = 0; r < static_cast<size_t>(parity); r++) step(parityRow(parityRows, shape, r));
+
+      auto clean = std::ranges::all_of(syndromes, [](const Row& syndrome) { return isZero(syndrome); });
+      if (!clean) {
+        auto length = shape.rows + static_cast<size_t>(parity);
+        auto before = correctedBytes;
+        std::vector<uint8_t> laneSyndromes(static_cast<size_t>(parity));
+        for (size_t lane = 0; lane < shape.codewords; lane++) {
+          for (int i = 0; i < parity; i++) laneSyndromes[i] = laneOf(syndromes[i], lane);
+          if (std::ranges::all_of(laneSyndromes, [](const uint8_t s) { return s == 0; })) continue;
+
+          auto fixed = correct(laneSyndromes, length, [&](const size_t position, const uint8_t value) {
+            auto index = position * shape.codewords + lane;
+            if (position < shape.rows && index >= shape.dataBytes) return false;  // a known 0 cannot be wrong
+
+            // Parity bytes are not passed on, so only data bytes need the fix itself.
+            if (position < shape.rows) data[index] ^= value;
+            correctedBytes++;
+            return true;
+          });
+          if (!fixed) {
+            throw std::runtime_error("The payload has more errors than error correction can repair.");
+          }
+        }
+        Stats::add(Stats::Counter::CorrectedBytes, correctedBytes - before);
+      }
+    }
+
+    emit(std::span(group).first(shape.dataBytes));
+    remaining -= groupBytes;
+    group.clear();
+    groupBytes = 0;
+  }
+}
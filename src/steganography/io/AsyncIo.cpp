@@ -0,0 +1,130 @@
+#include "steganography/io/AsyncIo.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+auto AsyncIo::create(const AsyncIoOptions& options) -> std::unique_ptr<AsyncIo> {
+    auto depth = std::max<size_t>(1, options.queueDepth);
+
+#ifdef __linux__
+    if (options.backend != AsyncIoBackend::Threads) {
+        try {
+            return std::make_unique<UringIo>(depth);
+        } catch (const std::exception&) {
+            // Old kernels and sandboxes that forbid io_uring get the thread backend.
+            if (options.backend == AsyncIoBackend::IoUring) throw;
+        }
+    }
+#else
+    if (options.backend == AsyncIoBackend::IoUring) {
+        throw std::runtime_error("io_uring is only available on Linux.");
+    }
+#endif
+
+    return std::make_unique<ThreadIo>(std::min(depth, MaxIoThreads));
+}
+
+ThreadIo::ThreadIo(const size_t threadCount) {
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadIo::~ThreadIo() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    pending.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+auto ThreadIo::read(const File& file, const uint64_t offset, void* buffer, const size_t count, const uint64_t tag)
+    -> void {
+    submit([&file, offset, buffer, count, tag] {
+        Completion completion{tag};
+        try {
+            completion.bytes = file.readAt(offset, buffer, count);
+        } catch (const std::exception& e) {
+            completion.error = e.what();
+        }
+        return completion;
+    });
+}
+
+auto ThreadIo::write(File& file, const uint64_t offset, const void* buffer, const size_t count, const uint64_t tag)
+    -> void {
+    submit([&file, offset, buffer, count, tag] {
+        Completion completion{tag};
+        try {
+            file.writeAt(offset, buffer, count);
+            completion.bytes = count;
+        } catch (const std::exception& e) {
+            completion.error = e.what();
+        }
+        return completion;
+    });
+}
+
+auto ThreadIo::sync(const File& file, const uint64_t tag) -> void {
+    submit([&file, tag] {
+        Completion completion{tag};
+        try {
+            file.sync();
+        } catch (const std::exception& e) {
+            completion.error = e.what();
+        }
+        return completion;
+    });
+}
+
+auto ThreadIo::notify(const uint64_t tag) -> void {
+    complete({tag});
+}
+
+auto ThreadIo::wait(std::vector<Completion>& out) -> void {
+    std::unique_lock lock(mutex);
+    completed.wait(lock, [this] { return !completions.empty(); });
+
+    std::ranges::move(completions, std::back_inserter(out));
+    completions.clear();
+}
+
+auto ThreadIo::name() const -> std::string {
+    return "threads";
+}
+
+auto ThreadIo::submit(std::function<Completion()> operation) -> void {
+    {
+        std::lock_guard lock(mutex);
+        operations.push_back(std::move(operation));
+    }
+    pending.notify_one();
+}
+
+auto ThreadIo::complete(Completion completion) -> void {
+    {
+        std::lock_guard lock(mutex);
+        completions.push_back(std::move(completion));
+    }
+    completed.notify_one();
+}
+
+auto ThreadIo::workerLoop() -> void {
+    while (true) {
+        std::function<Completion()> operation;
+        {
+            std::unique_lock lock(mutex);
+            pending.wait(lock, [this] { return stopping || !operations.empty(); });
+            if (operations.empty()) return;
+
+            operation = std::move(operations.front());
+            operations.pop_front();
+        }
+        complete(operation());
+    }
+}
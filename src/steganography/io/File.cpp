@@ -0,0 +1,189 @@
+#include "steganography/io/File.h"
+#include "steganography/stats/Stats.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+File::File(const std::string& filepath, const Mode mode) : path(filepath), mode(mode) {
+#ifdef _WIN32
+    auto access = GENERIC_READ | (mode == Mode::ReadWrite ? GENERIC_WRITE : 0);
+    handle = CreateFileA(filepath.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        handle = InvalidHandle;
+        throw std::runtime_error("Cannot open file: " + filepath);
+    }
+#else
+    handle = ::open(filepath.c_str(), (mode == Mode::ReadWrite ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (handle < 0) {
+        throw std::runtime_error("Cannot open file: " + filepath + " (" + std::strerror(errno) + ")");
+    }
+#endif
+}
+
+File::~File() {
+    close();
+}
+
+File::File(File&& other) noexcept
+    : path(std::move(other.path)), mode(other.mode), handle(std::exchange(other.handle, InvalidHandle)) {}
+
+auto File::operator=(File&& other) noexcept -> File& {
+    if (this != &other) {
+        close();
+        path = std::move(other.path);
+        mode = other.mode;
+        handle = std::exchange(other.handle, InvalidHandle);
+    }
+    return *this;
+}
+
+auto File::isOpen() const -> bool {
+    return handle != InvalidHandle;
+}
+
+auto File::size() const -> uint64_t {
+#ifdef _WIN32
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize)) {
+        throw std::runtime_error("Failed to query file size: " + path);
+    }
+    return static_cast<uint64_t>(fileSize.QuadPart);
+#else
+    struct stat st {};
+    if (::fstat(handle, &st) != 0) {
+        throw std::runtime_error("Failed to query file size: " + path);
+    }
+    return static_cast<uint64_t>(st.st_size);
+#endif
+}
+
+auto File::nativeHandle() const -> NativeHandle {
+    return handle;
+}
+
+auto File::getPath() const -> const std::string& {
+    return path;
+}
+
+auto File::isWritable() const -> bool {
+    return mode == Mode::ReadWrite;
+}
+
+auto File::readAt(uint64_t offset, void* buffer, const size_t count) const -> size_t {
+    auto* out = static_cast<char*>(buffer);
+    size_t total = 0;
+
+    while (total < count) {
+#ifdef _WIN32
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+        auto chunk = static_cast<DWORD>(std::min<size_t>(count - total, 1u << 30));
+        DWORD bytesRead = 0;
+        if (!ReadFile(handle, out + total, chunk, &bytesRead, &overlapped)) {
+            if (GetLastError() == ERROR_HANDLE_EOF) break;
+            throw std::runtime_error("Failed to read file: " + path);
+        }
+#else
+        auto bytesRead = ::pread(handle, out + total, count - total, static_cast<off_t>(offset));
+        if (bytesRead < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Failed to read file: " + path + " (" + std::strerror(errno) + ")");
+        }
+#endif
+        if (bytesRead == 0) break;
+
+        total += static_cast<size_t>(bytesRead);
+        offset += static_cast<uint64_t>(bytesRead);
+    }
+
+    Stats::add(Stats::Counter::BytesRead, total);
+    return total;
+}
+
+auto File::readExactAt(const uint64_t offset, void* buffer, const size_t count) const -> void {
+    if (readAt(offset, buffer, count) != count) {
+        throw std::runtime_error("Unexpected end of file: " + path);
+    }
+}
+
+auto File::writeAt(uint64_t offset, const void* buffer, const size_t count) -> void {
+    const auto* in = static_cast<const char*>(buffer);
+    size_t total = 0;
+
+    while (total < count) {
+#ifdef _WIN32
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+        auto chunk = static_cast<DWORD>(std::min<size_t>(count - total, 1u << 30));
+        DWORD bytesWritten = 0;
+        if (!WriteFile(handle, in + total, chunk, &bytesWritten, &overlapped)) {
+            throw std::runtime_error("Failed to write file: " + path);
+        }
+#else
+        auto bytesWritten = ::pwrite(handle, in + total, count - total, static_cast<off_t>(offset));
+        if (bytesWritten < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Failed to write file: " + path + " (" + std::strerror(errno) + ")");
+        }
+#endif
+        total += static_cast<size_t>(bytesWritten);
+        offset += static_cast<uint64_t>(bytesWritten);
+    }
+
+    Stats::add(Stats::Counter::BytesWritten, total);
+}
+
+auto File::resize(const uint64_t size) -> void {
+#ifdef _WIN32
+    FILE_END_OF_FILE_INFO info{};
+    info.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFileInformationByHandle(handle, FileEndOfFileInfo, &info, sizeof(info))) {
+        throw std::runtime_error("Failed to resize file: " + path);
+    }
+#else
+    if (::ftruncate(handle, static_cast<off_t>(size)) != 0) {
+        throw std::runtime_error("Failed to resize file: " + path + " (" + std::strerror(errno) + ")");
+    }
+#endif
+}
+
+auto File::sync() const -> void {
+#ifdef _WIN32
+    if (!FlushFileBuffers(handle)) {
+        throw std::runtime_error("Failed to flush file: " + path);
+    }
+#else
+    if (::fsync(handle) != 0) {
+        throw std::runtime_error("Failed to flush file: " + path);
+    }
+#endif
+}
+
+auto File::close() -> void {
+    if (!isOpen()) return;
+#ifdef _WIN32
+    CloseHandle(handle);
+#else
+    ::close(handle);
+#endif
+    handle = InvalidHandle;
+}
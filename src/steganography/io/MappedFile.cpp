@@ -0,0 +1,114 @@
+#include "steganography/io/MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    auto mappingGranularity() -> uint64_t {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwAllocationGranularity;
+#else
+        return static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    auto pageSize() -> uintptr_t {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+#else
+        return static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+}
+
+MappedFile::MappedFile(const File& file, const uint64_t offset, const size_t length) : file(file), length(length) {
+    if (length == 0) return;
+
+    auto alignedOffset = offset - offset % mappingGranularity();
+    delta = static_cast<size_t>(offset - alignedOffset);
+    baseLength = length + delta;
+
+#ifdef _WIN32
+    mapping = CreateFileMappingA(file.nativeHandle(), nullptr, file.isWritable() ? PAGE_READWRITE : PAGE_READONLY,
+        0, 0, nullptr);
+    if (mapping == nullptr) {
+        throw std::runtime_error("Failed to create file mapping: " + file.getPath());
+    }
+
+    base = MapViewOfFile(mapping, file.isWritable() ? FILE_MAP_WRITE : FILE_MAP_READ,
+        static_cast<DWORD>(alignedOffset >> 32), static_cast<DWORD>(alignedOffset & 0xFFFFFFFF), baseLength);
+    if (base == nullptr) {
+        CloseHandle(mapping);
+        throw std::runtime_error("Failed to map file: " + file.getPath());
+    }
+#else
+    auto protection = PROT_READ | (file.isWritable() ? PROT_WRITE : 0);
+    base = mmap(nullptr, baseLength, protection, MAP_SHARED, file.nativeHandle(), static_cast<off_t>(alignedOffset));
+    if (base == MAP_FAILED) {
+        base = nullptr;
+        throw std::runtime_error("Failed to map file: " + file.getPath());
+    }
+#endif
+}
+
+MappedFile::~MappedFile() {
+    if (base == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(mapping);
+#else
+    munmap(base, baseLength);
+#endif
+}
+
+auto MappedFile::data() -> uint8_t* {
+    return static_cast<uint8_t*>(base) + delta;
+}
+
+auto MappedFile::data() const -> const uint8_t* {
+    return static_cast<const uint8_t*>(base) + delta;
+}
+
+auto MappedFile::size() const -> size_t {
+    return length;
+}
+
+auto MappedFile::flush(const FlushPolicy policy, const size_t offset, const size_t count) -> void {
+    if (policy == FlushPolicy::None || base == nullptr || count == 0) return;
+
+    // Flush calls want a page-aligned start; round the dirty range out to whole pages.
+    auto start = reinterpret_cast<uintptr_t>(data()) + offset;
+    auto alignedStart = start - start % pageSize();
+    auto flushLength = static_cast<size_t>(start + count - alignedStart);
+
+#ifdef _WIN32
+    if (!FlushViewOfFile(reinterpret_cast<void*>(alignedStart), flushLength)) {
+        throw std::runtime_error("Failed to flush mapped file: " + file.getPath());
+    }
+    if (policy == FlushPolicy::Sync) {
+        file.sync();
+    }
+#else
+    auto flags = policy == FlushPolicy::Sync ? MS_SYNC : MS_ASYNC;
+    if (msync(reinterpret_cast<void*>(alignedStart), flushLength, flags) != 0) {
+        throw std::runtime_error("Failed to flush mapped file: " + file.getPath());
+    }
+#endif
+}
+
+auto MappedFile::flush(const FlushPolicy policy) -> void {
+    flush(policy, 0, length);
+}
@@ -0,0 +1,218 @@
+#include "steganography/io/UnixSocket.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <afunix.h>
+#include <mutex>
+#else
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef _WIN32
+    auto lastError() -> std::string {
+        return "error " + std::to_string(WSAGetLastError());
+    }
+
+    auto initSockets() -> void {
+        static std::once_flag started;
+        std::call_once(started, [] {
+            WSADATA data;
+            if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+                throw std::runtime_error("Failed to initialise Winsock.");
+            }
+        });
+    }
+
+    auto closeHandle(const UnixSocket::NativeHandle handle) -> void {
+        closesocket(static_cast<SOCKET>(handle));
+    }
+#else
+    auto lastError() -> std::string {
+        return std::strerror(errno);
+    }
+
+    auto initSockets() -> void {}
+
+    auto closeHandle(const UnixSocket::NativeHandle handle) -> void {
+        ::close(handle);
+    }
+
+    auto interrupted() -> bool {
+        return errno == EINTR;
+    }
+#endif
+
+    auto addressFor(const std::string& path) -> sockaddr_un {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("Invalid socket path: " + path);
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+    auto openSocket() -> UnixSocket::NativeHandle {
+        initSockets();
+#ifdef _WIN32
+        auto handle = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (handle == INVALID_SOCKET) {
+            throw std::runtime_error("Failed to create socket: " + lastError());
+        }
+        return static_cast<UnixSocket::NativeHandle>(handle);
+#else
+        auto handle = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (handle < 0) {
+            throw std::runtime_error("Failed to create socket: " + lastError());
+        }
+        return handle;
+#endif
+    }
+}
+
+UnixSocket::UnixSocket(const NativeHandle handle) : handle(handle) {}
+
+UnixSocket::~UnixSocket() {
+    close();
+}
+
+UnixSocket::UnixSocket(UnixSocket&& other) noexcept : handle(std::exchange(other.handle, InvalidHandle)) {}
+
+auto UnixSocket::operator=(UnixSocket&& other) noexcept -> UnixSocket& {
+    if (this != &other) {
+        close();
+        handle = std::exchange(other.handle, InvalidHandle);
+    }
+    return *this;
+}
+
+auto UnixSocket::listen(const std::string& path) -> UnixSocket {
+    auto address = addressFor(path);
+
+    std::error_code error;
+    if (std::filesystem::exists(path, error)) {
+        auto answering = true;
+        try {
+            connect(path);
+        } catch (const std::runtime_error&) {
+            answering = false;
+        }
+        if (answering) {
+            throw std::runtime_error("A server is already listening on " + path);
+        }
+        std::filesystem::remove(path, error);
+    }
+
+    UnixSocket socket(openSocket());
+    if (::bind(socket.handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        throw std::runtime_error("Cannot bind " + path + ": " + lastError());
+    }
+    if (::listen(socket.handle, SOMAXCONN) != 0) {
+        throw std::runtime_error("Cannot listen on " + path + ": " + lastError());
+    }
+    return socket;
+}
+
+auto UnixSocket::connect(const std::string& path) -> UnixSocket {
+    auto address = addressFor(path);
+
+    UnixSocket socket(openSocket());
+    if (::connect(socket.handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        throw std::runtime_error("Cannot connect to " + path + ": " + lastError());
+    }
+    return socket;
+}
+
+auto UnixSocket::accept() const -> UnixSocket {
+    while (true) {
+#ifdef _WIN32
+        auto client = ::accept(static_cast<SOCKET>(handle), nullptr, nullptr);
+        if (client != INVALID_SOCKET) return UnixSocket(static_cast<NativeHandle>(client));
+#else
+        auto client = ::accept4(handle, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client >= 0) return UnixSocket(client);
+        if (interrupted()) continue;
+#endif
+        throw std::runtime_error("Failed to accept a connection: " + lastError());
+    }
+}
+
+auto UnixSocket::readSome(void* buffer, const size_t count) const -> size_t {
+    while (true) {
+#ifdef _WIN32
+        auto n = ::recv(static_cast<SOCKET>(handle), static_cast<char*>(buffer), static_cast<int>(std::min<size_t>(count, 1u << 30)), 0);
+        if (n >= 0) return static_cast<size_t>(n);
+#else
+        auto n = ::recv(handle, buffer, count, 0);
+        if (n >= 0) return static_cast<size_t>(n);
+        if (interrupted()) continue;
+#endif
+        throw std::runtime_error("Failed to read from socket: " + lastError());
+    }
+}
+
+auto UnixSocket::readExact(void* buffer, const size_t count) const -> bool {
+    auto* out = static_cast<char*>(buffer);
+    size_t total = 0;
+    while (total < count) {
+        auto n = readSome(out + total, count - total);
+        if (n == 0) {
+            if (total == 0) return false;
+            throw std::runtime_error("Connection closed in the middle of a message.");
+        }
+        total += n;
+    }
+    return true;
+}
+
+auto UnixSocket::writeAll(const void* buffer, const size_t count) const -> void {
+    const auto* in = static_cast<const char*>(buffer);
+    size_t total = 0;
+    while (total < count) {
+#ifdef _WIN32
+        auto n = ::send(static_cast<SOCKET>(handle), in + total, static_cast<int>(std::min<size_t>(count - total, 1u << 30)), 0);
+        if (n == SOCKET_ERROR) {
+            throw std::runtime_error("Failed to write to socket: " + lastError());
+        }
+#else
+        // MSG_NOSIGNAL: a peer that went away is an error here, not a SIGPIPE.
+        auto n = ::send(handle, in + total, count - total, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (interrupted()) continue;
+            throw std::runtime_error("Failed to write to socket: " + lastError());
+        }
+#endif
+        total += static_cast<size_t>(n);
+    }
+}
+
+auto UnixSocket::shutdownWrite() const -> void {
+#ifdef _WIN32
+    ::shutdown(static_cast<SOCKET>(handle), SD_SEND);
+#else
+    ::shutdown(handle, SHUT_WR);
+#endif
+}
+
+auto UnixSocket::isOpen() const -> bool {
+    return handle != InvalidHandle;
+}
+
+auto UnixSocket::close() -> void {
+    if (!isOpen()) return;
+    closeHandle(handle);
+    handle = InvalidHandle;
+}
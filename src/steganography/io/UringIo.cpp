@@ -0,0 +1,223 @@
+#include "steganography/io/AsyncIo.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    auto systemError(const std::string& what, const int error) -> std::runtime_error {
+        return std::runtime_error(what + " (" + std::strerror(error) + ")");
+    }
+
+    auto mapRing(const int ring, const size_t bytes, const uint64_t offset) -> void* {
+        auto* memory = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring,
+            static_cast<off_t>(offset));
+        if (memory == MAP_FAILED) {
+            throw systemError("Failed to map the io_uring rings", errno);
+        }
+        return memory;
+    }
+
+    template <typename T>
+    auto at(void* base, const uint32_t offset) -> T* {
+        return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+    }
+
+    // The kernel reads and writes the ring indices concurrently with us.
+    auto loadAcquire(unsigned* index) -> unsigned {
+        return std::atomic_ref(*index).load(std::memory_order_acquire);
+    }
+
+    auto storeRelease(unsigned* index, const unsigned value) -> void {
+        std::atomic_ref(*index).store(value, std::memory_order_release);
+    }
+}
+
+struct UringIo::Operation {
+    uint8_t opcode = IORING_OP_NOP;
+    int fd = -1;
+    uint64_t offset = 0;
+    uint8_t* buffer = nullptr;
+    size_t count = 0;
+    size_t done = 0;
+    uint64_t tag = 0;
+};
+
+UringIo::UringIo(const size_t queueDepth) {
+    io_uring_params params{};
+    auto depth = static_cast<unsigned>(std::min<size_t>(queueDepth, 4096));
+    ring = static_cast<int>(::syscall(__NR_io_uring_setup, depth, &params));
+    if (ring < 0) {
+        throw systemError("io_uring is not available", errno);
+    }
+
+    // From here on release() owns the ring and whatever got mapped.
+    try {
+        entries = params.sq_entries;
+        sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+        }
+
+        sqRing = mapRing(ring, sqRingBytes, IORING_OFF_SQ_RING);
+        cqRing = (params.features & IORING_FEAT_SINGLE_MMAP) ? sqRing : mapRing(ring, cqRingBytes, IORING_OFF_CQ_RING);
+        sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = mapRing(ring, sqesBytes, IORING_OFF_SQES);
+
+        sqHead = at<unsigned>(sqRing, params.sq_off.head);
+        sqTail = at<unsigned>(sqRing, params.sq_off.tail);
+        sqMask = *at<unsigned>(sqRing, params.sq_off.ring_mask);
+        sqArray = at<unsigned>(sqRing, params.sq_off.array);
+        cqHead = at<unsigned>(cqRing, params.cq_off.head);
+        cqTail = at<unsigned>(cqRing, params.cq_off.tail);
+        cqMask = *at<unsigned>(cqRing, params.cq_off.ring_mask);
+        cqes = at<io_uring_cqe>(cqRing, params.cq_off.cqes);
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+UringIo::~UringIo() {
+    for (auto* operation : backlog) delete operation;
+    release();
+}
+
+auto UringIo::release() -> void {
+    if (sqes != nullptr) ::munmap(sqes, sqesBytes);
+    if (cqRing != nullptr && cqRing != sqRing) ::munmap(cqRing, cqRingBytes);
+    if (sqRing != nullptr) ::munmap(sqRing, sqRingBytes);
+    sqes = cqRing = sqRing = nullptr;
+
+    if (ring >= 0) ::close(ring);
+    ring = -1;
+}
+
+auto UringIo::read(const File& file, const uint64_t offset, void* buffer, const size_t count, const uint64_t tag)
+    -> void {
+    submit(std::make_unique<Operation>(Operation{IORING_OP_READ, file.nativeHandle(), offset,
+        static_cast<uint8_t*>(buffer), count, 0, tag}));
+}
+
+auto UringIo::write(File& file, const uint64_t offset, const void* buffer, const size_t count, const uint64_t tag)
+    -> void {
+    // The kernel only reads from the buffer of a write.
+    submit(std::make_unique<Operation>(Operation{IORING_OP_WRITE, file.nativeHandle(), offset,
+        static_cast<uint8_t*>(const_cast<void*>(buffer)), count, 0, tag}));
+}
+
+auto UringIo::sync(const File& file, const uint64_t tag) -> void {
+    submit(std::make_unique<Operation>(Operation{IORING_OP_FSYNC, file.nativeHandle(), 0, nullptr, 0, 0, tag}));
+}
+
+auto UringIo::notify(const uint64_t tag) -> void {
+    submit(std::make_unique<Operation>(Operation{IORING_OP_NOP, -1, 0, nullptr, 0, 0, tag}));
+}
+
+auto UringIo::name() const -> std::string {
+    return "io_uring";
+}
+
+auto UringIo::submit(std::unique_ptr<Operation> operation) -> void {
+    std::lock_guard lock(submitMutex);
+    push(operation.release());
+}
+
+auto UringIo::push(Operation* operation) -> void {
+    if (inFlight >= entries) {
+        backlog.push_back(operation);
+        return;
+    }
+
+    // Only push() writes the tail, always under submitMutex, and every entry is handed
+    // to the kernel before the lock is released, so the slot at the tail is free.
+    auto tail = *sqTail;
+    auto index = tail & sqMask;
+    auto* sqe = static_cast<io_uring_sqe*>(sqes) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = operation->opcode;
+    sqe->fd = operation->fd;
+    sqe->off = operation->offset + operation->done;
+    sqe->addr = reinterpret_cast<uint64_t>(operation->buffer + operation->done);
+    // A single transfer is capped well below 4 GiB; the rest is resubmitted.
+    sqe->len = static_cast<uint32_t>(std::min<size_t>(operation->count - operation->done, 1u << 30));
+    sqe->user_data = reinterpret_cast<uint64_t>(operation);
+    sqArray[index] = index;
+    storeRelease(sqTail, tail + 1);
+
+    while (true) {
+        auto submitted = ::syscall(__NR_io_uring_enter, ring, 1, 0, 0, nullptr, 0);
+        if (submitted == 1) break;
+        if (submitted < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY)) continue;
+        throw systemError("Failed to submit to io_uring", submitted < 0 ? errno : EIO);
+    }
+    inFlight++;
+}
+
+auto UringIo::reap(std::vector<Completion>& out) -> void {
+    auto head = *cqHead;
+    auto tail = loadAcquire(cqTail);
+
+    std::lock_guard lock(submitMutex);
+    while (head != tail) {
+        const auto& cqe = static_cast<io_uring_cqe*>(cqes)[head & cqMask];
+        auto* operation = reinterpret_cast<Operation*>(cqe.user_data);
+        auto result = cqe.res;
+        inFlight--;
+        // The entry is consumed before anything is resubmitted, so a submission that
+        // throws cannot hand the same completion out again.
+        storeRelease(cqHead, ++head);
+
+        auto transfer = operation->opcode == IORING_OP_READ || operation->opcode == IORING_OP_WRITE;
+        if (result == -EINTR || result == -EAGAIN) {
+            push(operation);
+            continue;
+        }
+        if (result > 0 && transfer) {
+            operation->done += static_cast<size_t>(result);
+            if (operation->done < operation->count) {
+                push(operation);
+                continue;
+            }
+        }
+
+        Completion completion{operation->tag, operation->done};
+        if (result < 0) {
+            completion.error = std::string("Asynchronous I/O failed: ") + std::strerror(-result);
+        } else if (result == 0 && operation->opcode == IORING_OP_WRITE && operation->done < operation->count) {
+            completion.error = "Asynchronous write made no progress.";
+        }
+        out.push_back(std::move(completion));
+        delete operation;
+    }
+
+    while (!backlog.empty() && inFlight < entries) {
+        auto* operation = backlog.front();
+        backlog.pop_front();
+        push(operation);
+    }
+}
+
+auto UringIo::wait(std::vector<Completion>& out) -> void {
+    auto before = out.size();
+    while (true) {
+        reap(out);
+        if (out.size() > before) return;
+
+        auto result = ::syscall(__NR_io_uring_enter, ring, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (result < 0 && errno != EINTR) {
+            throw systemError("Failed to wait for io_uring", errno);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,149 @@
+#include "steganography/lsb/CarrierGeometry.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+  // Moves the carrier bytes of count whole pixels between pixel data and the carrier:
+  // from pixel to carrier when loading, the other way when storing.
+  template <bool Store>
+  using PixelCopy = void (*)(uint8_t* pixel, uint8_t* carrier, size_t count);
+
+  // Pixels whose bytes are all carrier bytes, as in 24-bit BMP rows and 8-bit PPM.
+  template <bool Store>
+  auto copyPacked(uint8_t* pixel, uint8_t* carrier, const size_t count, const int pixelBytes) -> void {
+    if constexpr (Store) {
+      std::memcpy(pixel, carrier, count * pixelBytes);
+    } else {
+      std::memcpy(carrier, pixel, count * pixelBytes);
+    }
+  }
+
+  // The pixel shape is fixed at compile time, so the channel loop unrolls and every pixel
+  // runs the same straight-line copies.
+  template <bool Store, int PixelBytes, int Channels, int Stride>
+  auto copyPixels(uint8_t* pixel, uint8_t* carrier, const size_t count) -> void {
+    for (size_t p = 0; p < count; p++, pixel += PixelBytes, carrier += Channels) {
+      for (int c = 0; c < Channels; c++) {
+        if constexpr (Store) {
+          pixel[c * Stride] = carrier[c];
+        } else {
+          carrier[c] = pixel[c * Stride];
+        }
+      }
+    }
+  }
+
+  template <bool Store>
+  auto pixelCopyFor(const Lsb::CarrierGeometry& geometry) -> PixelCopy<Store> {
+    auto shape = [&](const int pixelBytes, const int channels, const int stride) {
+      return geometry.pixelBytes == pixelBytes && geometry.channels == channels &&
+          (channels == 1 || geometry.channelStride == stride);
+    };
+
+    if (shape(2, 1, 1)) return copyPixels<Store, 2, 1, 1>;  // 16-bit BMP, 16-bit grayscale PPM
+    if (shape(4, 3, 1)) return copyPixels<Store, 4, 3, 1>;  // 32-bit BMP without alpha
+    if (shape(6, 3, 2)) return copyPixels<Store, 6, 3, 2>;  // 16-bit RGB PPM
+    return nullptr;
+  }
+
+  template <bool Store>
+  auto walkCarrier(uint8_t* pixels, const Lsb::CarrierGeometry& geometry, const uint64_t first, uint8_t* carrier,
+      size_t count) -> void {
+    auto rowCarrier = geometry.rowCarrierBytes();
+    auto channels = static_cast<uint64_t>(geometry.channels);
+    auto packed = geometry.pixelBytes == geometry.channels && (channels == 1 || geometry.channelStride == 1);
+    auto kernel = pixelCopyFor<Store>(geometry);
+
+    auto pixelAt = [&](uint8_t* row, const uint64_t column) {
+      return row + column / channels * geometry.pixelBytes + geometry.firstChannel;
+    };
+    // Only the pixels split at either end of a row's range go byte by byte.
+    auto copyByte = [&](uint8_t* row, const uint64_t column, uint8_t* c) {
+      auto* p = pixelAt(row, column) + column % channels * geometry.channelStride;
+      if constexpr (Store) {
+        *p = *c;
+      } else {
+        *c = *p;
+      }
+    };
+
+    auto* row = pixels;
+    auto column = first % rowCarrier;
+    while (count > 0) {
+      auto n = static_cast<size_t>(std::min<uint64_t>(count, rowCarrier - column));
+
+      size_t done = 0;
+      for (; done < n && (column + done) % channels != 0; done++) copyByte(row, column + done, carrier + done);
+
+      auto whole = (n - done) / channels;
+      auto* pixel = pixelAt(row, column + done);
+      if (packed) {
+        copyPacked<Store>(pixel, carrier + done, whole, geometry.pixelBytes);
+      } else if (kernel != nullptr) {
+        kernel(pixel, carrier + done, whole);
+      } else {
+        for (size_t i = 0; i < whole * channels; i++) copyByte(row, column + done + i, carrier + done + i);
+      }
+      done += whole * channels;
+
+      for (; done < n; done++) copyByte(row, column + done, carrier + done);
+
+      carrier += n;
+      count -= n;
+      row += geometry.rowStride;
+      column = 0;
+    }
+  }
+}
+
+namespace Lsb {
+  auto CarrierGeometry::rowCarrierBytes() const -> uint64_t {
+    return width * static_cast<uint64_t>(channels);
+  }
+
+  auto CarrierGeometry::isContiguous() const -> bool {
+    return pixelBytes == channels && (channels == 1 || channelStride == 1) && firstChannel == 0 &&
+        rowStride == width * static_cast<uint64_t>(pixelBytes);
+  }
+
+  auto CarrierGeometry::spanBytes(const uint64_t count) const -> uint64_t {
+    if (count == 0) return 0;
+
+    auto last = count - 1;
+    auto column = last % rowCarrierBytes();
+    return rowOffset(last) + column / channels * pixelBytes + firstChannel + column % channels * channelStride + 1;
+  }
+
+  auto CarrierGeometry::rowOffset(const uint64_t index) const -> uint64_t {
+    return index / rowCarrierBytes() * rowStride;
+  }
+
+  auto CarrierGeometry::carrierBytesWithin(const uint64_t dataBytes) const -> uint64_t {
+    if (rowStride == 0 || width == 0) return 0;
+
+    auto rows = dataBytes / rowStride;
+    auto rest = dataBytes % rowStride;
+    auto pixels = rest / pixelBytes;
+    if (pixels >= width) {
+      return (rows + 1) * rowCarrierBytes();
+    }
+
+    // Channels of a pixel cut off by the end of the data that still made it in.
+    auto partial = rest % pixelBytes;
+    auto channelsIn = partial > static_cast<uint64_t>(firstChannel)
+        ? std::min<uint64_t>(channels, (partial - firstChannel - 1) / channelStride + 1)
+        : 0;
+    return rows * rowCarrierBytes() + pixels * channels + channelsIn;
+  }
+
+  auto loadCarrier(const uint8_t* pixels, const CarrierGeometry& geometry, const uint64_t first, uint8_t* out,
+      const size_t count) -> void {
+    walkCarrier<false>(const_cast<uint8_t*>(pixels), geometry, first, out, count);
+  }
+
+  auto storeCarrier(uint8_t* pixels, const CarrierGeometry& geometry, const uint64_t first, const uint8_t* in,
+      const size_t count) -> void {
+    walkCarrier<true>(pixels, geometry, first, const_cast<uint8_t*>(in), count);
+  }
+}
@@ -0,0 +1,393 @@
+#include "steganography/lsb/LsbEngine.h"
+#include "steganography/concurrency/ThreadPool.h"
+#include "steganography/lsb/DepthKernels.h"
+#include "steganography/lsb/MatrixKernels.h"
+
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define STEG_HAVE_SSE2 1
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define STEG_HAVE_AVX2 1
+#endif
+
+namespace {
+  constexpr uint64_t LsbMask = 0x0101010101010101ULL;
+  constexpr bool LittleEndian = std::endian::native == std::endian::little;
+
+  // spreadTable[b] holds the 8 bits of b as 0x00/0x01 bytes, MSB in the lowest address.
+  constexpr auto makeSpreadTable() -> std::array<uint64_t, 256> {
+    std::array<uint64_t, 256> table{};
+    for (int b = 0; b < 256; b++) {
+      uint64_t value = 0;
+      for (int j = 0; j < 8; j++) {
+        value |= static_cast<uint64_t>((b >> (7 - j)) & 1) << (8 * j);
+      }
+      table[b] = value;
+    }
+    return table;
+  }
+
+  constexpr auto makeReverseTable() -> std::array<uint8_t, 256> {
+    std::array<uint8_t, 256> table{};
+    for (int b = 0; b < 256; b++) {
+      int reversed = 0;
+      for (int j = 0; j < 8; j++) {
+        reversed |= ((b >> j) & 1) << (7 - j);
+      }
+      table[b] = static_cast<uint8_t>(reversed);
+    }
+    return table;
+  }
+
+  constexpr auto spreadTable = makeSpreadTable();
+  constexpr auto reverseTable = makeReverseTable();
+
+  std::atomic<Lsb::Kernel> selectedKernel{Lsb::bestKernel()};
+
+  auto load64(const uint8_t* p) -> uint64_t {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+  }
+
+  auto store64(uint8_t* p, uint64_t value) -> void {
+    std::memcpy(p, &value, sizeof(value));
+  }
+
+  // Gathers the LSBs of 8 little-endian carrier bytes, first byte into bit 7.
+  auto gather64(uint64_t carrier) -> uint8_t {
+    return static_cast<uint8_t>(((carrier & LsbMask) * 0x8040201008040201ULL) >> 56);
+  }
+
+  auto embedScalar(uint8_t* carrier, const uint8_t* payload, size_t count) -> void {
+    for (size_t i = 0; i < count; i++) {
+      for (int j = 0; j < 8; j++) {
+        auto& c = carrier[i * 8 + j];
+        c = static_cast<uint8_t>((c & 0xFE) | ((payload[i] >> (7 - j)) & 1));
+      }
+    }
+  }
+
+  auto extractScalar(const uint8_t* carrier, uint8_t* payload, size_t count) -> void {
+    for (size_t i = 0; i < count; i++) {
+      uint8_t byte = 0;
+      for (int j = 0; j < 8; j++) {
+        byte = static_cast<uint8_t>((byte << 1) | (carrier[i * 8 + j] & 1));
+      }
+      payload[i] = byte;
+    }
+  }
+
+  auto embedTable(uint8_t* carrier, const uint8_t* payload, size_t count) -> void {
+    if constexpr (!LittleEndian) {
+      embedScalar(carrier, payload, count);
+      return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      auto* c = carrier + i * 8;
+      store64(c, (load64(c) & ~LsbMask) | spreadTable[payload[i]]);
+    }
+  }
+
+  auto extractTable(const uint8_t* carrier, uint8_t* payload, size_t count) -> void {
+    if constexpr (!LittleEndian) {
+      extractScalar(carrier, payload, count);
+      return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      payload[i] = gather64(load64(carrier + i * 8));
+    }
+  }
+
+#ifdef STEG_HAVE_SSE2
+  // Replicates payload bytes b0 and b1 into lanes 0-7 and 8-15 and tests each
+  // lane against its bit, so no per-byte table lookups are needed.
+  auto embedSSE2(uint8_t* carrier, const uint8_t* payload, size_t count) -> void {
+    const auto bitSelect = _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const auto one = _mm_set1_epi8(1);
+    const auto keep = _mm_set1_epi8(static_cast<char>(0xFE));
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+      auto bytes = _mm_cvtsi32_si128(payload[i] | (payload[i + 1] << 8));
+      bytes = _mm_unpacklo_epi8(bytes, bytes);
+      bytes = _mm_unpacklo_epi16(bytes, bytes);
+      bytes = _mm_unpacklo_epi32(bytes, bytes);
+
+      auto bits = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(bytes, bitSelect), bitSelect), one);
+
+      auto* c = reinterpret_cast<__m128i*>(carrier + i * 8);
+      _mm_storeu_si128(c, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(c), keep), bits));
+    }
+
+    embedTable(carrier + i * 8, payload + i, count - i);
+  }
+
+  auto extractSSE2(const uint8_t* carrier, uint8_t* payload, size_t count) -> void {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+      auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(carrier + i * 8));
+      auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_slli_epi64(v, 7)));
+
+      // movemask puts the first carrier byte in bit 0; the payload wants it in bit 7.
+      payload[i] = reverseTable[mask & 0xFF];
+      payload[i + 1] = reverseTable[mask >> 8];
+    }
+
+    extractTable(carrier + i * 8, payload + i, count - i);
+  }
+#endif
+
+#ifdef STEG_HAVE_AVX2
+  auto embedAVX2(uint8_t* carrier, const uint8_t* payload, size_t count) -> void {
+    const auto spread = _mm256_setr_epi8(
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+        2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const auto bitSelect = _mm256_set1_epi64x(static_cast<long long>(0x0102040810204080ULL));
+    const auto one = _mm256_set1_epi8(1);
+    const auto keep = _mm256_set1_epi8(static_cast<char>(0xFE));
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      uint32_t packed;
+      std::memcpy(&packed, payload + i, sizeof(packed));
+
+      // Both 128-bit lanes see all four bytes, so the in-lane shuffle can reach
+      // bytes 2 and 3 from the upper lane.
+      auto bytes = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(packed)), spread);
+      auto bits = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(bytes, bitSelect), bitSelect), one);
+
+      auto* c = reinterpret_cast<__m256i*>(carrier + i * 8);
+      _mm256_storeu_si256(c, _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(c), keep), bits));
+    }
+
+    embedSSE2(carrier + i * 8, payload + i, count - i);
+  }
+
+  auto extractAVX2(const uint8_t* carrier, uint8_t* payload, size_t count) -> void {
+    // Reverses every group of 8 bytes so movemask yields the MSB-first payload bytes directly.
+    const auto reverse = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(carrier + i * 8));
+      v = _mm256_shuffle_epi8(_mm256_slli_epi64(v, 7), reverse);
+      auto packed = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+      std::memcpy(payload + i, &packed, sizeof(packed));
+    }
+
+    extractSSE2(carrier + i * 8, payload + i, count - i);
+  }
+#endif
+}
+
+namespace Lsb {
+  auto getKernelName(const Kernel kernel) -> std::string {
+    switch (kernel) {
+      case Kernel::Scalar: return "scalar";
+      case Kernel::Table: return "table";
+      case Kernel::SSE2: return "sse2";
+      case Kernel::AVX2: return "avx2";
+      default: return "unknown";
+    }
+  }
+
+  auto bestKernel() -> Kernel {
+#if defined(STEG_HAVE_AVX2)
+    return Kernel::AVX2;
+#elif defined(STEG_HAVE_SSE2)
+    return Kernel::SSE2;
+#else
+    return Kernel::Table;
+#endif
+  }
+
+  auto activeKernel() -> Kernel {
+    return selectedKernel.load(std::memory_order_relaxed);
+  }
+
+  auto setKernel(Kernel kernel) -> void {
+#ifndef STEG_HAVE_AVX2
+    if (kernel == Kernel::AVX2) kernel = bestKernel();
+#endif
+#ifndef STEG_HAVE_SSE2
+    if (kernel == Kernel::SSE2) kernel = bestKernel();
+#endif
+    selectedKernel.store(kernel, std::memory_order_relaxed);
+  }
+
+  auto embedBytes(const Kernel kernel, uint8_t* carrier, const uint8_t* payload, const size_t count) -> void {
+    switch (kernel) {
+#ifdef STEG_HAVE_AVX2
+      case Kernel::AVX2: return embedAVX2(carrier, payload, count);
+#endif
+#ifdef STEG_HAVE_SSE2
+      case Kernel::SSE2: return embedSSE2(carrier, payload, count);
+#endif
+      case Kernel::Table: return embedTable(carrier, payload, count);
+      default: return embedScalar(carrier, payload, count);
+    }
+  }
+
+  auto extractBytes(const Kernel kernel, const uint8_t* carrier, uint8_t* payload, const size_t count) -> void {
+    switch (kernel) {
+#ifdef STEG_HAVE_AVX2
+      case Kernel::AVX2: return extractAVX2(carrier, payload, count);
+#endif
+#ifdef STEG_HAVE_SSE2
+      case Kernel::SSE2: return extractSSE2(carrier, payload, count);
+#endif
+      case Kernel::Table: return extractTable(carrier, payload, count);
+      default: return extractScalar(carrier, payload, count);
+    }
+  }
+
+  auto isValidBitsPerChannel(const int bitsPerChannel) -> bool {
+    return bitsPerChannel >= 1 && bitsPerChannel <= MaxBitsPerChannel;
+  }
+
+  auto isValidMatrixBits(const int matrixBits) -> bool {
+    return matrixBits >= MinMatrixBits && matrixBits <= MaxMatrixBits;
+  }
+
+  auto carrierBytesFor(const uint64_t count, const Density density) -> uint64_t {
+    if (density.matrixBits > 0) {
+      auto blocks = (count * 8 + density.matrixBits - 1) / density.matrixBits;
+      return blocks * ((uint64_t{1} << density.matrixBits) - 1);
+    }
+    return (count * 8 + density.bitsPerChannel - 1) / density.bitsPerChannel;
+  }
+
+  auto payloadBytesWithin(const uint64_t carrierBytes, const Density density) -> uint64_t {
+    if (density.matrixBits > 0) {
+      return carrierBytes / ((uint64_t{1} << density.matrixBits) - 1) * density.matrixBits / 8;
+    }
+    return carrierBytes * density.bitsPerChannel / 8;
+  }
+
+  auto alignedChunkBytes(const size_t preferred, const Density density) -> size_t {
+    return preferred - preferred % density.groupPayloadBytes();
+  }
+
+  auto embedBytes(uint8_t* carrier, const uint8_t* payload, const size_t count, const Density density) -> void {
+    switch (density.matrixBits) {
+      case 0: break;
+      case 2: return MatrixKernel<2>::embed(carrier, payload, count);
+      case 3: return MatrixKernel<3>::embed(carrier, payload, count);
+      case 4: return MatrixKernel<4>::embed(carrier, payload, count);
+      case 5: return MatrixKernel<5>::embed(carrier, payload, count);
+      case 6: return MatrixKernel<6>::embed(carrier, payload, count);
+      case 7: return MatrixKernel<7>::embed(carrier, payload, count);
+      default: throw std::invalid_argument("Unsupported matrix code: " + std::to_string(density.matrixBits));
+    }
+
+    switch (density.bitsPerChannel) {
+      case 1: return embedBytes(activeKernel(), carrier, payload, count);
+      case 2: return DepthKernel<2>::embed(carrier, payload, count);
+      case 3: return DepthKernel<3>::embed(carrier, payload, count);
+      case 4: return DepthKernel<4>::embed(carrier, payload, count);
+      default: throw std::invalid_argument("Unsupported bits per channel: " + std::to_string(density.bitsPerChannel));
+    }
+  }
+
+  auto extractBytes(const uint8_t* carrier, uint8_t* payload, const size_t count, const Density density) -> void {
+    switch (density.matrixBits) {
+      case 0: break;
+      case 2: return MatrixKernel<2>::extract(carrier, payload, count);
+      case 3: return MatrixKernel<3>::extract(carrier, payload, count);
+      case 4: return MatrixKernel<4>::extract(carrier, payload, count);
+      case 5: return MatrixKernel<5>::extract(carrier, payload, count);
+      case 6: return MatrixKernel<6>::extract(carrier, payload, count);
+      case 7: return MatrixKernel<7>::extract(carrier, payload, count);
+      default: throw std::invalid_argument("Unsupported matrix code: " + std::to_string(density.matrixBits));
+    }
+
+    switch (density.bitsPerChannel) {
+      case 1: return extractBytes(activeKernel(), carrier, payload, count);
+      case 2: return DepthKernel<2>::extract(carrier, payload, count);
+      case 3: return DepthKernel<3>::extract(carrier, payload, count);
+      case 4: return DepthKernel<4>::extract(carrier, payload, count);
+      default: throw std::invalid_argument("Unsupported bits per channel: " + std::to_string(density.bitsPerChannel));
+    }
+  }
+
+  auto embedWithKey(uint8_t* carrier, const uint8_t* payload, const size_t count, const Crypto::PayloadCipher& cipher,
+      const uint64_t offset, const Density density) -> void {
+    if (cipher.isIdentity()) {
+      embedBytes(carrier, payload, count, density);
+      return;
+    }
+
+    uint8_t chunk[4096];
+    const auto chunkSize = alignedChunkBytes(sizeof(chunk), density);
+
+    for (size_t done = 0; done < count; done += chunkSize) {
+      auto n = std::min(chunkSize, count - done);
+      std::memcpy(chunk, payload + done, n);
+      cipher.apply(chunk, n, offset + done);
+      embedBytes(carrier + carrierBytesFor(done, density), chunk, n, density);
+    }
+  }
+
+  auto parallelChunkBytes(const Density density) -> size_t {
+    return alignedChunkBytes(ParallelChunkBytes, density);
+  }
+
+  auto parallelChunkCount(const size_t count, const ParallelOptions& parallel, const Density density) -> size_t {
+    if (parallel.threadCount == 1 || carrierBytesFor(count, density) < parallel.thresholdBytes) {
+      return 1;
+    }
+    auto chunkBytes = parallelChunkBytes(density);
+    return (count + chunkBytes - 1) / chunkBytes;
+  }
+
+  auto embedWithKey(uint8_t* carrier, const uint8_t* payload, const size_t count, const Crypto::PayloadCipher& cipher,
+      const ParallelOptions& parallel, const Density density) -> void {
+    auto chunks = parallelChunkCount(count, parallel, density);
+    if (chunks <= 1) {
+      embedWithKey(carrier, payload, count, cipher, 0, density);
+      return;
+    }
+
+    auto chunkBytes = parallelChunkBytes(density);
+    ThreadPool::shared().parallelFor(chunks, parallel.threadCount, [&](const size_t chunk) {
+      auto begin = chunk * chunkBytes;
+      auto n = std::min(chunkBytes, count - begin);
+      embedWithKey(carrier + carrierBytesFor(begin, density), payload + begin, n, cipher, begin, density);
+    });
+  }
+
+  auto extractWithKey(const uint8_t* carrier, uint8_t* payload, const size_t count, const Crypto::PayloadCipher& cipher,
+      const ParallelOptions& parallel, const Density density) -> void {
+    auto chunks = parallelChunkCount(count, parallel, density);
+    auto chunkBytes = chunks == 1 ? count : parallelChunkBytes(density);
+
+    auto extractChunk = [&](const size_t chunk) {
+      auto begin = chunk * chunkBytes;
+      auto n = std::min(chunkBytes, count - begin);
+      extractBytes(carrier + carrierBytesFor(begin, density), payload + begin, n, density);
+      cipher.apply(payload + begin, n, begin);
+    };
+
+    if (chunks <= 1) {
+      extractChunk(0);
+      return;
+    }
+
+    ThreadPool::shared().parallelFor(chunks, parallel.threadCount, extractChunk);
+  }
+}
@@ -0,0 +1,307 @@
+#include "steganography/lsb/PayloadHeader.h"
+#include "steganography/checksum/Crc32c.h"
+#include "steganography/fec/ReedSolomon.h"
+#include "steganography/lsb/LsbEngine.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace {
+  constexpr uint32_t DepthMask = 0x3;
+  constexpr uint32_t ExtendedFlag = 0x4;
+  constexpr int PrefixLengthShift = 3;
+  constexpr uint64_t PrefixLengthMask = (uint64_t{1} << 29) - 1;
+  constexpr int ExtendedLengthShift = 8;
+  constexpr uint32_t ExtendedFlagsMask = 0xFF;
+  constexpr uint32_t ChaCha20Flag = 0x01;
+  constexpr uint32_t CompressedFlag = 0x02;
+  constexpr uint32_t FecFlag = 0x04;
+  constexpr uint32_t VersionedFlag = 0x08;
+  constexpr int MatrixShift = 4;
+  constexpr uint32_t MatrixMask = 0x70;
+  constexpr int FecParityShift = 24;
+  constexpr uint32_t FecReservedMask = 0x00FF0000;
+  constexpr uint32_t ChecksumMask = 0xFFFF;
+  constexpr size_t FecCopyCarrierBytes = 3 * Lsb::HeaderWordBits;
+  // "STG" above the version byte.
+  constexpr uint32_t Magic = 0x53544700;
+  constexpr uint32_t VersionMask = 0xFF;
+
+  auto writeWord(uint8_t* carrier, const uint32_t word) -> void {
+    const uint8_t bytes[4] = {
+      static_cast<uint8_t>(word >> 24), static_cast<uint8_t>(word >> 16),
+      static_cast<uint8_t>(word >> 8), static_cast<uint8_t>(word)
+    };
+
+    Lsb::embedBytes(carrier, bytes, sizeof(bytes));
+  }
+
+  auto readWord(const uint8_t* carrier) -> uint32_t {
+    uint8_t bytes[4];
+    Lsb::extractBytes(carrier, bytes, sizeof(bytes));
+
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+           (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+  }
+
+  // The header bytes, in order, as they are written or read, for the checksums over them.
+  class HeaderBytes {
+  public:
+    auto addWord(const uint32_t word) -> void {
+      for (int shift = 24; shift >= 0; shift -= 8) bytes[count++] = static_cast<uint8_t>(word >> shift);
+    }
+
+    auto addHalfWord(const uint32_t word) -> void {
+      bytes[count++] = static_cast<uint8_t>(word >> 24);
+      bytes[count++] = static_cast<uint8_t>(word >> 16);
+    }
+
+    auto add(const Crypto::Salt& salt) -> void {
+      std::copy(salt.begin(), salt.end(), bytes.begin() + static_cast<std::ptrdiff_t>(count));
+      count += salt.size();
+    }
+
+    // CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF), bit by bit: it only ever
+    // covers a few dozen header bytes.
+    [[nodiscard]] auto crc16() const -> uint16_t {
+      uint16_t crc = 0xFFFF;
+      for (size_t i = 0; i < count; i++) {
+        crc ^= static_cast<uint16_t>(bytes[i] << 8);
+        for (int bit = 0; bit < 8; bit++) {
+          crc = static_cast<uint16_t>(crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1);
+        }
+      }
+      return crc;
+    }
+
+    [[nodiscard]] auto crc32c() const -> uint32_t {
+      return Checksum::crc32c(bytes.data(), count);
+    }
+
+  private:
+    std::array<uint8_t, 6 * 4 + Crypto::SaltBytes> bytes{};
+    size_t count = 0;
+  };
+
+  // The checksum of an error corrected header: both words, the top half of the third
+  // and, for ChaCha20, the salt.
+  auto fecChecksum(const uint32_t prefix, const uint32_t extended, const uint32_t fecWord,
+      const Lsb::PayloadHeader& header) -> uint16_t {
+    HeaderBytes bytes;
+    bytes.addWord(prefix);
+    bytes.addWord(extended);
+    bytes.addHalfWord(fecWord);
+    if (header.cipher == Crypto::Cipher::ChaCha20) {
+      bytes.add(header.salt);
+    }
+    return bytes.crc16();
+  }
+
+  // Carrier bytes of one copy of the header.
+  auto copyCarrierBytes(const Lsb::PayloadHeader& header) -> size_t {
+    size_t bytes = header.fecParity > 0 ? FecCopyCarrierBytes
+        : Lsb::isExtended(header) ? 2 * Lsb::HeaderWordBits : Lsb::HeaderWordBits;
+    if (header.cipher == Crypto::Cipher::ChaCha20) {
+      bytes += Lsb::SaltCarrierBytes;
+    }
+    if (header.version > 0) {
+      bytes += Lsb::VersionedCarrierBytes;
+    }
+    return bytes;
+  }
+
+  auto writeCopy(uint8_t* carrier, const Lsb::PayloadHeader& header) -> void {
+    auto extended = Lsb::isExtended(header);
+    auto prefix = static_cast<uint32_t>((header.payloadBytes & PrefixLengthMask) << PrefixLengthShift) |
+        (extended ? ExtendedFlag : 0) | static_cast<uint32_t>(header.bitsPerChannel - 1);
+
+    writeWord(carrier, prefix);
+    if (!extended) return;
+
+    auto flags = (header.cipher == Crypto::Cipher::ChaCha20 ? ChaCha20Flag : 0) |
+        (header.compressed ? CompressedFlag : 0) | (header.fecParity > 0 ? FecFlag : 0) |
+        (header.version > 0 ? VersionedFlag : 0) | static_cast<uint32_t>(header.matrixBits) << MatrixShift;
+    auto word = (static_cast<uint32_t>(header.payloadBytes >> 29) << ExtendedLengthShift) | flags;
+    writeWord(carrier + Lsb::HeaderWordBits, word);
+
+    HeaderBytes bytes;
+    bytes.addWord(prefix);
+    bytes.addWord(word);
+    auto offset = 2 * Lsb::HeaderWordBits;
+    if (header.fecParity > 0) {
+      auto fecWord = static_cast<uint32_t>(header.fecParity) << FecParityShift;
+      fecWord |= fecChecksum(prefix, word, fecWord, header);
+      writeWord(carrier + offset, fecWord);
+      bytes.addWord(fecWord);
+      offset += Lsb::HeaderWordBits;
+    }
+    if (header.cipher == Crypto::Cipher::ChaCha20) {
+      Lsb::embedBytes(carrier + offset, header.salt.data(), header.salt.size());
+      bytes.add(header.salt);
+      offset += Lsb::SaltCarrierBytes;
+    }
+    if (header.version > 0) {
+      for (auto closing : {Magic | static_cast<uint32_t>(header.version), header.keyCheck, header.payloadCrc}) {
+        writeWord(carrier + offset, closing);
+        bytes.addWord(closing);
+        offset += Lsb::HeaderWordBits;
+      }
+      writeWord(carrier + offset, bytes.crc32c());
+    }
+  }
+
+  // Parses one copy of the header. An error corrected header only parses if its checksum
+  // holds and its layout is one Fec::encode() can produce, a versioned one if its magic,
+  // version and checksum do.
+  auto readCopy(const uint8_t* carrier, const size_t available) -> std::optional<Lsb::PayloadHeader> {
+    if (available < Lsb::HeaderWordBits) {
+      return std::nullopt;
+    }
+
+    auto prefix = readWord(carrier);
+    Lsb::PayloadHeader header{prefix >> PrefixLengthShift, static_cast<int>(prefix & DepthMask) + 1};
+    if (!(prefix & ExtendedFlag)) {
+      return header;
+    }
+
+    if (available < 2 * Lsb::HeaderWordBits) {
+      return std::nullopt;
+    }
+
+    auto word = readWord(carrier + Lsb::HeaderWordBits);
+    auto flags = word & ExtendedFlagsMask;
+    if (flags & ~(ChaCha20Flag | CompressedFlag | FecFlag | VersionedFlag | MatrixMask)) {
+      return std::nullopt;
+    }
+    header.matrixBits = static_cast<int>((flags & MatrixMask) >> MatrixShift);
+    if (header.matrixBits != 0 &&
+        (!Lsb::isValidMatrixBits(header.matrixBits) || header.bitsPerChannel != 1 || !(flags & VersionedFlag))) {
+      return std::nullopt;
+    }
+
+    header.payloadBytes |= static_cast<uint64_t>(word >> ExtendedLengthShift) << 29;
+    header.compressed = (flags & CompressedFlag) != 0;
+
+    HeaderBytes bytes;
+    bytes.addWord(prefix);
+    bytes.addWord(word);
+    auto offset = 2 * Lsb::HeaderWordBits;
+    uint32_t fecWord = 0;
+    if (flags & FecFlag) {
+      if (available < offset + Lsb::HeaderWordBits) {
+        return std::nullopt;
+      }
+      fecWord = readWord(carrier + offset);
+      header.fecParity = static_cast<int>(fecWord >> FecParityShift);
+      if ((fecWord & FecReservedMask) || !Fec::isValidParity(header.fecParity) ||
+          !Fec::dataBytes(header.payloadBytes, header.fecParity)) {
+        return std::nullopt;
+      }
+      bytes.addWord(fecWord);
+      offset += Lsb::HeaderWordBits;
+    }
+    if (flags & ChaCha20Flag) {
+      if (available < offset + Lsb::SaltCarrierBytes) {
+        return std::nullopt;
+      }
+      header.cipher = Crypto::Cipher::ChaCha20;
+      Lsb::extractBytes(carrier + offset, header.salt.data(), header.salt.size());
+      bytes.add(header.salt);
+      offset += Lsb::SaltCarrierBytes;
+    }
+    if (header.fecParity > 0 && (fecWord & ChecksumMask) != fecChecksum(prefix, word, fecWord, header)) {
+      return std::nullopt;
+    }
+
+    if (flags & VersionedFlag) {
+      if (available < offset + Lsb::VersionedCarrierBytes) {
+        return std::nullopt;
+      }
+      auto magic = readWord(carrier + offset);
+      header.version = static_cast<int>(magic & VersionMask);
+      header.keyCheck = readWord(carrier + offset + Lsb::HeaderWordBits);
+      header.payloadCrc = readWord(carrier + offset + 2 * Lsb::HeaderWordBits);
+      if ((magic & ~VersionMask) != Magic || header.version != Lsb::CurrentHeaderVersion) {
+        return std::nullopt;
+      }
+
+      bytes.addWord(magic);
+      bytes.addWord(header.keyCheck);
+      bytes.addWord(header.payloadCrc);
+      if (readWord(carrier + offset + 3 * Lsb::HeaderWordBits) != bytes.crc32c()) {
+        return std::nullopt;
+      }
+    }
+    return header;
+  }
+}
+
+namespace Lsb {
+  auto isExtended(const PayloadHeader& header) -> bool {
+    return header.payloadBytes > PrefixLengthMask || header.cipher != Crypto::Cipher::RepeatingKey ||
+        header.compressed || header.fecParity > 0 || header.version > 0 || header.matrixBits > 0;
+  }
+
+  auto headerCarrierBytes(const PayloadHeader& header) -> size_t {
+    return copyCarrierBytes(header) * (header.fecParity > 0 ? HeaderCopies : 1);
+  }
+
+  auto payloadCarrierOffset(const PayloadHeader& header) -> uint64_t {
+    auto groupBytes = header.density().groupCarrierBytes();
+    return (headerCarrierBytes(header) + groupBytes - 1) / groupBytes * groupBytes;
+  }
+
+  auto writeHeader(uint8_t* carrier, const PayloadHeader& header) -> void {
+    if (header.payloadBytes > MaxPayloadBytes) {
+      throw std::runtime_error("Message too long to encode in this image.");
+    }
+    if (!isValidBitsPerChannel(header.bitsPerChannel)) {
+      throw std::invalid_argument("Unsupported bits per channel: " + std::to_string(header.bitsPerChannel));
+    }
+    if (header.fecParity != 0 && !Fec::isValidParity(header.fecParity)) {
+      throw std::invalid_argument("Unsupported error correction parity: " + std::to_string(header.fecParity));
+    }
+    if (header.version != 0 && header.version != CurrentHeaderVersion) {
+      throw std::invalid_argument("Unsupported header version: " + std::to_string(header.version));
+    }
+    if (header.matrixBits != 0 &&
+        (!isValidMatrixBits(header.matrixBits) || header.bitsPerChannel != 1 || header.version == 0)) {
+      throw std::invalid_argument("Unsupported matrix code: " + std::to_string(header.matrixBits));
+    }
+
+    auto copyBytes = copyCarrierBytes(header);
+    for (size_t copy = 0; copy < (header.fecParity > 0 ? HeaderCopies : 1); copy++) {
+      writeCopy(carrier + copy * copyBytes, header);
+    }
+  }
+
+  auto readHeader(const uint8_t* carrier, const size_t available) -> std::optional<PayloadHeader> {
+    auto header = readCopy(carrier, available);
+    if (header && header->fecParity > 0) {
+      return available >= headerCarrierBytes(*header) ? header : std::nullopt;
+    }
+
+    // A damaged first copy of an error corrected header can read as anything, so the
+    // majority of three copies of every size one can have gets a say before a plain
+    // header is taken.
+    constexpr size_t CopySizes[] = {FecCopyCarrierBytes, FecCopyCarrierBytes + SaltCarrierBytes,
+        FecCopyCarrierBytes + SaltCarrierBytes + VersionedCarrierBytes};
+    for (auto copyBytes : CopySizes) {
+      if (available < HeaderCopies * copyBytes) continue;
+
+      std::array<uint8_t, MaxHeaderCarrierBytes / HeaderCopies> voted;
+      for (size_t i = 0; i < copyBytes; i++) {
+        auto a = carrier[i], b = carrier[copyBytes + i], c = carrier[2 * copyBytes + i];
+        voted[i] = static_cast<uint8_t>((a & b) | (a & c) | (b & c));
+      }
+
+      auto majority = readCopy(voted.data(), copyBytes);
+      if (majority && majority->fecParity > 0 && copyCarrierBytes(*majority) == copyBytes) {
+        return majority;
+      }
+    }
+    return header;
+  }
+}
@@ -0,0 +1,148 @@
+#include "steganography/lsb/Samples.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+  // Netpbm recommends plain raster lines of at most 70 characters.
+  constexpr size_t MaxLineChars = 70;
+  constexpr size_t MaxSampleDigits = 5;
+  constexpr uint32_t MaxSampleValue = 65535;
+
+  constexpr uint64_t LowNibbles = 0x0F0F0F0F0F0F0F0Full;
+
+  // "00" to "99", so the emitter converts two digits per lookup.
+  constexpr auto DigitPairs = [] {
+    std::array<char, 200> pairs{};
+    for (int i = 0; i < 100; i++) {
+      pairs[2 * i] = static_cast<char>('0' + i / 10);
+      pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+    }
+    return pairs;
+  }();
+
+  [[noreturn]] auto invalidSample() -> void {
+    throw std::runtime_error("Invalid or truncated plain PPM raster.");
+  }
+
+  auto isSpace(const char c) -> bool {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+  }
+
+  // Bit 7 of every byte of word that is not an ASCII digit. No step carries across bytes.
+  auto nonDigitBytes(const uint64_t word) -> uint64_t {
+    auto highNibble = (word & ~LowNibbles) ^ 0x3030303030303030ull;
+    auto lowNibble = ((word & LowNibbles) + 0x0606060606060606ull) & 0x1010101010101010ull;
+    auto bad = highNibble | lowNibble;
+    return (((bad & 0x7F7F7F7F7F7F7F7Full) + 0x7F7F7F7F7F7F7F7Full) | bad) & 0x8080808080808080ull;
+  }
+
+  // The value of the first length (1 to 7) digits of word, loaded little-endian so that
+  // the first character is the lowest byte. Shifting pads the front with zero digits;
+  // three multiply steps then combine digit pairs, quads and octets.
+  auto parseDigits(uint64_t word, const int length) -> uint32_t {
+    word = (word & LowNibbles) << (8 * (8 - length));
+    word = (word * 10 + (word >> 8)) & 0x00FF00FF00FF00FFull;
+    word = (word * 100 + (word >> 16)) & 0x0000FFFF0000FFFFull;
+    return static_cast<uint32_t>(word * 10000 + (word >> 32));
+  }
+
+  auto parseDigitsScalar(const char*& p, const char* end) -> uint32_t {
+    uint32_t value = 0;
+    size_t digits = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+      // Leading zeros are allowed; anything past 65535 is rejected by the caller.
+      value = std::min<uint32_t>(value * 10 + static_cast<uint32_t>(*p - '0'), 1u << 20);
+      digits++;
+    }
+    if (digits == 0) invalidSample();
+    return value;
+  }
+
+  // Writes value right-aligned ending at end and returns its first character.
+  auto formatSample(uint32_t value, char* end) -> char* {
+    while (value >= 100) {
+      end -= 2;
+      std::memcpy(end, &DigitPairs[2 * (value % 100)], 2);
+      value /= 100;
+    }
+    if (value >= 10) {
+      end -= 2;
+      std::memcpy(end, &DigitPairs[2 * value], 2);
+    } else {
+      *--end = static_cast<char>('0' + value);
+    }
+    return end;
+  }
+}
+
+namespace Lsb {
+  auto parseDecimalSamples(std::string_view text, std::span<uint16_t> out) -> void {
+    const auto* p = text.data();
+    const auto* end = p + text.size();
+
+    for (auto& sample : out) {
+      while (p < end && (isSpace(*p) || *p == '#')) {
+        if (*p == '#') {
+          p = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+          if (p == nullptr) invalidSample();
+        }
+        p++;
+      }
+
+      uint32_t value = 0;
+      auto length = 0;
+      if constexpr (std::endian::native == std::endian::little) {
+        if (end - p >= 8) {
+          uint64_t word;
+          std::memcpy(&word, p, sizeof(word));
+          auto mask = nonDigitBytes(word);
+          length = mask == 0 ? 8 : std::countr_zero(mask) / 8;
+        }
+      }
+      // Short tails, over-long runs of digits and big-endian hosts take the plain loop.
+      if (length > 0 && length < 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        value = parseDigits(word, length);
+        p += length;
+      } else {
+        value = parseDigitsScalar(p, end);
+      }
+
+      if (value > MaxSampleValue) invalidSample();
+      sample = static_cast<uint16_t>(value);
+    }
+  }
+
+  auto appendDecimalSamples(std::span<const uint16_t> samples, std::string& out) -> void {
+    // Written through a pointer into room reserved for the longest possible text.
+    auto start = out.size();
+    out.resize(start + samples.size() * (MaxSampleDigits + 1) + 1);
+    auto* p = out.data() + start;
+
+    size_t column = 0;
+    char digits[MaxSampleDigits];
+    for (auto sample : samples) {
+      auto* first = formatSample(sample, digits + MaxSampleDigits);
+      auto length = static_cast<size_t>(digits + MaxSampleDigits - first);
+
+      if (column > 0 && column + 1 + length > MaxLineChars) {
+        *p++ = '\n';
+        column = 0;
+      } else if (column > 0) {
+        *p++ = ' ';
+        column++;
+      }
+      std::memcpy(p, first, length);
+      p += length;
+      column += length;
+    }
+    *p++ = '\n';
+
+    out.resize(static_cast<size_t>(p - out.data()));
+  }
+}
@@ -0,0 +1,100 @@
+#include "steganography/lsb/Scatter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+  // splitmix64 finaliser: a cheap full-avalanche mix used as the Feistel round function.
+  auto mix(uint64_t value) -> uint64_t {
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ull;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+  }
+
+  // FNV-1a over the key, so every key byte affects every round key.
+  auto hashKey(const std::string& key) -> uint64_t {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (auto c : key) {
+      hash ^= static_cast<uint8_t>(c);
+      hash *= 0x100000001B3ull;
+    }
+    return hash;
+  }
+}
+
+namespace Lsb {
+  auto scatterCapacity(const uint64_t carrierBytes) -> uint64_t {
+    return carrierBytes / ScatterGroupBytes * ScatterGroupBytes;
+  }
+
+  auto scatterGroupsFor(const uint64_t count) -> uint64_t {
+    return (count + ScatterGroupBytes - 1) / ScatterGroupBytes;
+  }
+
+  ScatterPermutation::ScatterPermutation(const uint64_t size, const std::string& key) : domainSize(size) {
+    int bits = 2;
+    while (bits < 64 && (uint64_t{1} << bits) < size) bits++;
+    highBits = bits / 2;
+    lowBits = bits - highBits;
+    lowMask = (uint64_t{1} << lowBits) - 1;
+
+    // The domain size takes part in the round keys, so the same key scatters differently
+    // over differently sized carriers.
+    auto state = hashKey(key) ^ mix(size);
+    for (auto& roundKey : roundKeys) {
+      state += 0x9E3779B97F4A7C15ull;
+      roundKey = mix(state);
+    }
+  }
+
+  auto ScatterPermutation::operator()(const uint64_t index) const -> uint64_t {
+    if (domainSize <= 1) return index;
+
+    // Cycle walking: the Feistel network permutes the power-of-two domain, and following
+    // its cycle from an in-range index until it lands in range again restricts it to a
+    // permutation of [0, size).
+    auto value = permute(index);
+    while (value >= domainSize) {
+      value = permute(value);
+    }
+    return value;
+  }
+
+  auto ScatterPermutation::size() const -> uint64_t {
+    return domainSize;
+  }
+
+  auto ScatterPermutation::map(const uint64_t first, uint64_t* groups, const size_t count) const -> void {
+    for (size_t j = 0; j < count; j++) {
+      groups[j] = (*this)(first + j);
+    }
+  }
+
+  auto ScatterPermutation::permute(const uint64_t value) const -> uint64_t {
+    auto high = value >> lowBits;
+    auto low = value & lowMask;
+
+    // Each round updates one half from the top bits of a keyed mix of the other. The
+    // halves differ by at most one bit, which lets the domain be any power of two.
+    for (int round = 0; round < Rounds; round += 2) {
+      high ^= mix(low ^ roundKeys[round]) >> (64 - highBits);
+      low ^= mix(high ^ roundKeys[round + 1]) >> (64 - lowBits);
+    }
+
+    return (high << lowBits) | low;
+  }
+
+  auto gather(const uint8_t* carrier, const uint64_t* groups, uint8_t* out, const size_t count) -> void {
+    for (size_t done = 0, j = 0; done < count; done += ScatterGroupBytes, j++) {
+      std::memcpy(out + done, carrier + groups[j] * ScatterGroupBytes, std::min(ScatterGroupBytes, count - done));
+    }
+  }
+
+  auto scatter(uint8_t* carrier, const uint64_t* groups, const uint8_t* in, const size_t count) -> void {
+    for (size_t done = 0, j = 0; done < count; done += ScatterGroupBytes, j++) {
+      std::memcpy(carrier + groups[j] * ScatterGroupBytes, in + done, std::min(ScatterGroupBytes, count - done));
+    }
+  }
+}
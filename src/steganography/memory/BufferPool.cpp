@@ -0,0 +1,105 @@
+#include "steganography/memory/BufferPool.h"
+#include "steganography/stats/Stats.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+  // Set once the thread's pool is destroyed; leases released while the thread tears
+  // down its other thread_locals are then just freed.
+  thread_local bool poolDestroyed = false;
+
+  struct LocalPool {
+    LocalPool() {
+      free.reserve(Memory::MaxPooledBuffers);
+    }
+    ~LocalPool() {
+      poolDestroyed = true;
+    }
+
+    std::vector<Memory::Storage> free;
+    size_t bytes = 0;
+  };
+
+  auto localPool() -> LocalPool* {
+    thread_local LocalPool pool;
+    return poolDestroyed ? nullptr : &pool;
+  }
+
+  // The smallest idle buffer that holds size bytes, or failing that the largest one, for
+  // the caller to grow; empty when the pool has none.
+  auto take(const size_t size) -> Memory::Storage {
+    auto* pool = localPool();
+    if (pool == nullptr || pool->free.empty() || size == 0) return {};
+
+    auto& free = pool->free;
+    auto fitting = free.end();
+    auto largest = free.begin();
+    for (auto it = free.begin(); it != free.end(); ++it) {
+      if (it->size >= size && (fitting == free.end() || it->size < fitting->size)) fitting = it;
+      if (it->size > largest->size) largest = it;
+    }
+    auto chosen = fitting != free.end() ? fitting : largest;
+
+    auto storage = std::move(*chosen);
+    *chosen = std::move(free.back());
+    free.pop_back();
+    pool->bytes -= storage.size;
+    if (storage.size >= size) {
+      Stats::add(Stats::Counter::BufferReuses, 1);
+    }
+    return storage;
+  }
+
+  auto give(Memory::Storage storage) -> void {
+    auto* pool = localPool();
+    if (pool == nullptr || storage.size == 0 || storage.size > Memory::MaxPooledBytes) return;
+
+    // Makes room by dropping the smallest idle buffers, which are the cheapest to remake,
+    // unless storage is smaller still.
+    auto& free = pool->free;
+    std::ranges::sort(free, [](const auto& a, const auto& b) { return a.size > b.size; });
+    while (!free.empty() &&
+        (free.size() >= Memory::MaxPooledBuffers || pool->bytes + storage.size > Memory::MaxPooledBytes)) {
+      if (free.back().size > storage.size) return;
+      pool->bytes -= free.back().size;
+      free.pop_back();
+    }
+
+    pool->bytes += storage.size;
+    free.push_back(std::move(storage));
+  }
+}
+
+namespace Memory {
+  Buffer::Buffer(const size_t size) : storage(take(size)), count(size) {
+    if (storage.size < size) {
+      // Replaced rather than grown: the old contents are not copied and the new bytes
+      // are not zeroed.
+      storage = {std::unique_ptr<uint8_t[]>(new uint8_t[size]), size};
+    }
+  }
+
+  Buffer::~Buffer() {
+    release();
+  }
+
+  Buffer::Buffer(Buffer&& other) noexcept
+    : storage(std::exchange(other.storage, {})), count(std::exchange(other.count, 0)) {}
+
+  auto Buffer::operator=(Buffer&& other) noexcept -> Buffer& {
+    if (this != &other) {
+      release();
+      storage = std::exchange(other.storage, {});
+      count = std::exchange(other.count, 0);
+    }
+    return *this;
+  }
+
+  auto Buffer::release() -> void {
+    give(std::move(storage));
+    storage = {};
+    count = 0;
+  }
+}
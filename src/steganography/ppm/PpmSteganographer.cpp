@@ -1,108 +1,135 @@
 #include "steganography/ppm/PpmSteganographer.h"
 #include "steganography/Utils.h"
 
-#include <bitset>
-#include <fstream>
-#include <vector>
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <optional>
 #include <stdexcept>
+#include <string_view>
 
 namespace {
-    auto calculateOffset(const std::vector<char>& buffer) -> int {
-        int lineCount = 0;
+    constexpr int MaxSampleValue = 65535;
 
-        for (int i = 0; i < buffer.size(); i++) {
-            if (buffer[i] == '\n') {
-                lineCount++;
-            }
-            if (lineCount == 4) {
-                return i + 1;
-            }
-        }
-
-        return -1;
+    [[noreturn]] auto unsupported() -> void {
+        throw std::runtime_error("Invalid or unsupported PPM format.");
     }
 
-    auto readDimensions(std::ifstream& file) -> std::pair<int, int> {
-        std::string token;
-        std::vector<std::string> header;
+    auto isSpace(const char c) -> bool {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+    }
 
-        while (header.size() < 3 && file >> token) {
-            if (token.starts_with('#')) {
-                std::getline(file, token);
-                continue;
+    // Walks the header in place: the magic number, then width, height and maxval, each
+    // preceded by whitespace and '#' comments that run to the end of their line.
+    class HeaderTokenizer {
+    public:
+        explicit HeaderTokenizer(std::string_view text) : text(text) {}
+
+        // The next token, or nullopt if text ends before the token is known to be complete.
+        auto next() -> std::optional<std::string_view> {
+            while (position < text.size() && (isSpace(text[position]) || text[position] == '#')) {
+                if (text[position] == '#') {
+                    position = text.find('\n', position);
+                    if (position == std::string_view::npos) return std::nullopt;
+                }
+                position++;
             }
 
-            header.push_back(token);
-        }
+            auto start = position;
+            while (position < text.size() && !isSpace(text[position]) && text[position] != '#') position++;
+            if (position == text.size()) return std::nullopt;
 
-        if (header.size() < 3 || header[0] != "P6") {
-            throw std::runtime_error("Invalid or unsupported PPM format.");
+            return text.substr(start, position - start);
         }
 
-        int width = std::stoi(header[1]);
-        int height = std::stoi(header[2]);
+        // Offset of the character that ended the last token.
+        [[nodiscard]] auto offset() const -> size_t {
+            return position;
+        }
 
-        return {width, height};
+    private:
+        std::string_view text;
+        size_t position = 0;
+    };
+
+    // Where the first releases thought the raster began: after the fourth line break. That
+    // is right with one comment line, and otherwise points into the raster. 0 when the
+    // fourth line break is not in head.
+    auto legacyDataOffset(std::span<const uint8_t> head) -> uint64_t {
+        int lines = 0;
+        for (size_t i = 0; i < head.size(); i++) {
+            if (head[i] == '\n' && ++lines == 4) return i + 1;
+        }
+        return 0;
     }
-}
 
-auto PpmSteganographer::getImageDimensions(const std::string& filepath) -> std::pair<int, int> {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file: " + filepath);
-    }
+    auto parseNumber(std::string_view token, const int min, const int max) -> int {
+        int value = 0;
+        auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (error != std::errc() || end != token.data() + token.size() || value < min || value > max) {
+            unsupported();
+        }
 
-    return readDimensions(file);
+        return value;
+    }
 }
 
-
-auto PpmSteganographer::encode(const std::string &filepath, const std::string &message, const std::string &key) -> bool {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file for encoding: " + filepath);
+auto PpmSteganographer::parseLayout(std::span<const uint8_t> head, const uint64_t fileSize) const
+    -> std::optional<ImageLayout> {
+    HeaderTokenizer tokens(std::string_view(reinterpret_cast<const char*>(head.data()), head.size()));
+
+    auto magic = tokens.next();
+    if (!magic) return std::nullopt;
+
+    // P6 is binary RGB, P5 binary grayscale and P3 plain (ASCII) RGB.
+    ImageLayout layout;
+    layout.format = Utils::ImageFormat::PPM;
+    int channels = 3;
+    if (*magic == "P5") {
+        channels = 1;
+    } else if (*magic == "P3") {
+        layout.encoding = SampleEncoding::Ascii;
+    } else if (*magic != "P6") {
+        unsupported();
     }
 
-    if (!canEncode(filepath, message)) {
-        throw std::runtime_error("Image is not suitable for encoding. Not enough space or unsupported format.");
-    }
+    auto width = tokens.next();
+    auto height = width ? tokens.next() : std::nullopt;
+    auto maxValue = height ? tokens.next() : std::nullopt;
+    if (!maxValue) return std::nullopt;
 
-    std::vector<char> buffer((std::istreambuf_iterator<char>(file)),
-                              std::istreambuf_iterator<char>());
-    file.close();
+    layout.width = parseNumber(*width, 0, std::numeric_limits<int>::max());
+    layout.height = parseNumber(*height, 0, std::numeric_limits<int>::max());
+    layout.maxValue = parseNumber(*maxValue, 1, MaxSampleValue);
+    layout.bitsPerPixel = channels * (layout.maxValue > 255 ? 16 : 8);
 
-    int pixelDataOffset = calculateOffset(buffer);
-    if (pixelDataOffset < 0) {
-        throw std::runtime_error("Failed to calculate pixel data offset.");
+    // Exactly one whitespace character separates maxval from the raster.
+    if (!isSpace(static_cast<char>(head[tokens.offset()]))) {
+        unsupported();
     }
-
-    return encodeLSB(buffer, pixelDataOffset, message, key, filepath);
-}
-
-auto PpmSteganographer::decode(const std::string &filepath, const std::string &key) -> std::string {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file for decoding: " + filepath);
+    layout.pixelDataOffset = tokens.offset() + 1;
+    layout.legacyDataOffset = legacyDataOffset(head);
+    auto samples = static_cast<uint64_t>(layout.width) * static_cast<uint64_t>(layout.height) * channels;
+
+    if (layout.encoding == SampleEncoding::Ascii) {
+        // The text length of the raster is only known once it is parsed.
+        layout.carrierBytes = samples;
+        return layout;
     }
 
-    std::vector<char> buffer((std::istreambuf_iterator<char>(file)),
-                              std::istreambuf_iterator<char>());
-    file.close();
+    // 16-bit samples are big-endian; only their second, low byte is a carrier byte.
+    auto sampleBytes = layout.maxValue > 255 ? 2 : 1;
+    auto& geometry = layout.geometry;
+    geometry.width = static_cast<uint64_t>(layout.width);
+    geometry.pixelBytes = channels * sampleBytes;
+    geometry.channels = channels;
+    geometry.channelStride = sampleBytes;
+    geometry.firstChannel = sampleBytes - 1;
+    geometry.rowStride = geometry.width * geometry.pixelBytes;
 
-    int pixelDataOffset = calculateOffset(buffer);
-    if (pixelDataOffset == -1) {
-        throw std::runtime_error("Could not find start of pixel data.");
-    }
+    auto fileBytes = fileSize > layout.pixelDataOffset ? fileSize - layout.pixelDataOffset : 0;
+    layout.carrierBytes = std::min(samples, geometry.carrierBytesWithin(fileBytes));
 
-    return decodeLSB(buffer, pixelDataOffset, key);
+    return layout;
 }
-
-auto PpmSteganographer::canEncode(const std::string &filepath, const std::string &message) -> bool {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file for capability check: " + filepath);
-    }
-
-    auto [width, height] = readDimensions(file);
-    
-    return canEncodeWithDimensions(width, height, message);
-}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "steganography/scan/ImageInventory.h"
+#include "steganography/concurrency/ThreadPool.h"
+#include "steganography/stats/Stats.h"
+
+#include <fmt/core.h>
+#include <mutex>
+#include <stdexcept>
+
+auto InventoryEntry::toJson() const -> std::string {
+    if (!error.empty()) {
+        return fmt::format("{{\"image\":\"{}\",\"error\":\"{}\"}}", Utils::jsonEscape(image), Utils::jsonEscape(error));
+    }
+
+    return fmt::format("{{\"image\":\"{}\",\"format\":\"{}\",\"width\":{},\"height\":{},\"bits_per_pixel\":{},"
+        "\"file_bytes\":{},\"carrier_bytes\":{},\"capacity_bytes\":{}}}", Utils::jsonEscape(image),
+        Utils::getImageFormatName(format), width, height, bitsPerPixel, fileBytes, carrierBytes, capacityBytes);
+}
+
+ImageInventory::ImageInventory(SteganographerManager& steganographerManager)
+    : steganographerManager(steganographerManager) {}
+
+auto ImageInventory::describe(const std::string& image, const EncodeOptions& options) const -> InventoryEntry {
+    auto* steganographer = steganographerManager.getSteganographer(Utils::getImageFormat(image));
+    if (steganographer == nullptr) {
+        throw std::runtime_error("Unsupported image format.");
+    }
+
+    auto handle = steganographer->open(image);
+    const auto& layout = handle.getLayout();
+
+    InventoryEntry entry;
+    entry.image = image;
+    entry.format = layout.format;
+    entry.width = layout.width;
+    entry.height = layout.height;
+    entry.bitsPerPixel = layout.bitsPerPixel;
+    entry.fileBytes = handle.getFileSize();
+    entry.carrierBytes = layout.carrierBytes;
+    entry.capacityBytes = steganographer->capacity(handle, options);
+    return entry;
+}
+
+auto ImageInventory::list(const std::vector<std::string>& paths, const EncodeOptions& options,
+    const EntrySink& sink) const -> InventoryReport {
+    InventoryReport report;
+    std::vector<Utils::PathFailure> unreadable;
+    auto images = Utils::collectImages(paths, unreadable);
+
+    std::mutex sinkMutex;
+    auto emit = [&](const InventoryEntry& entry) {
+        std::lock_guard lock(sinkMutex);
+        (entry.error.empty() ? report.listed : report.failed)++;
+        sink(entry);
+    };
+
+    for (const auto& failure : unreadable) {
+        InventoryEntry entry;
+        entry.image = failure.path;
+        entry.error = failure.reason;
+        emit(entry);
+    }
+
+    // Each image is one task, so a slow file only holds up its own entry.
+    auto* stats = Stats::active();
+    ThreadPool::shared().parallelFor(images.size(), 0, [&](const size_t i) {
+        Stats::Session session(stats);
+        InventoryEntry entry;
+        try {
+            entry = describe(images[i], options);
+        } catch (const std::exception& e) {
+            entry.image = images[i];
+            entry.error = e.what();
+        }
+        emit(entry);
+    });
+
+    return report;
+}
@@ -0,0 +1,181 @@
+#include "steganography/scan/PayloadScan.h"
+#include "steganography/CarrierSource.h"
+#include "steganography/compress/PayloadFrame.h"
+#include "steganography/concurrency/ThreadPool.h"
+#include "steganography/lsb/LsbEngine.h"
+#include "steganography/stats/Stats.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    // Samples per value class, at least, for the class to take part in the chi-square test.
+    constexpr uint64_t MinExpectedPerValue = 5;
+    // Fewer degrees of freedom than this say too little either way.
+    constexpr uint64_t MinDegrees = 8;
+    // Samples whose p-value reaches this are taken to be as even as embedded data.
+    constexpr double EvenPValue = 0.05;
+    constexpr double UnjudgedSignature = 0.75;
+    constexpr uint64_t PrefixLengthRange = uint64_t{1} << 29;
+    constexpr uint64_t ExtendedLengthRange = uint64_t{1} << 53;
+    // Flag combinations readHeader() accepts out of the 256 the extended word can hold;
+    // error corrected and versioned headers also need their checksum to hold, so they
+    // hardly count.
+    constexpr double ValidFlagsShare = 4.0 / 256.0;
+
+    // Share of the lengths in [0, range) that are not 0 and fit in carrierBytes behind a
+    // header of headerBytes, at bitsPerChannel.
+    auto fittingShare(const uint64_t carrierBytes, const size_t headerBytes, const int bitsPerChannel,
+        const uint64_t range) -> double {
+        if (carrierBytes <= headerBytes) return 0;
+
+        auto fits = std::min(range - 1, (carrierBytes - headerBytes) * bitsPerChannel / Lsb::CarrierBytesPerByte);
+        return static_cast<double>(fits) / static_cast<double>(range);
+    }
+
+    // The odds that random low bits read as a header whose payload fits in carrierBytes.
+    // Every depth is valid; half the prefixes are plain and half extended, and an extended
+    // word has to have valid flags and, with ChaCha20, room for the salt.
+    auto falseHeaderOdds(const uint64_t carrierBytes) -> double {
+        double odds = 0;
+        for (int bitsPerChannel = 1; bitsPerChannel <= 4; bitsPerChannel++) {
+            auto plain = fittingShare(carrierBytes, Lsb::HeaderWordBits, bitsPerChannel, PrefixLengthRange);
+            auto extended = (fittingShare(carrierBytes, 2 * Lsb::HeaderWordBits, bitsPerChannel, ExtendedLengthRange) +
+                fittingShare(carrierBytes, Lsb::MaxHeaderCarrierBytes, bitsPerChannel, ExtendedLengthRange)) / 2;
+            odds += (plain + ValidFlagsShare * extended) / 2 / 4;
+        }
+        return odds;
+    }
+
+    // Upper tail of the chi-square distribution, through the Wilson-Hilferty approximation,
+    // which is close enough at the degrees of freedom the test is run with.
+    auto chiSquareTail(const double statistic, const double degrees) -> double {
+        auto scale = 2.0 / (9.0 * degrees);
+        auto z = (std::cbrt(statistic / degrees) - (1.0 - scale)) / std::sqrt(scale);
+        return 0.5 * std::erfc(z / std::sqrt(2.0));
+    }
+
+    // How evenly the values of samples that differ only in their low bitsPerChannel bits are
+    // spread, as the signature term described in PayloadScan.h.
+    auto signatureTerm(const uint8_t* samples, const size_t count, const int bitsPerChannel) -> double {
+        std::array<uint64_t, 256> histogram{};
+        for (size_t i = 0; i < count; i++) {
+            histogram[samples[i]]++;
+        }
+
+        auto values = size_t{1} << bitsPerChannel;
+        double statistic = 0;
+        uint64_t degrees = 0;
+        for (size_t first = 0; first < histogram.size(); first += values) {
+            uint64_t total = 0;
+            for (size_t value = first; value < first + values; value++) {
+                total += histogram[value];
+            }
+            if (total < MinExpectedPerValue * values) continue;
+
+            auto expected = static_cast<double>(total) / static_cast<double>(values);
+            for (size_t value = first; value < first + values; value++) {
+                auto difference = static_cast<double>(histogram[value]) - expected;
+                statistic += difference * difference / expected;
+            }
+            degrees += values - 1;
+        }
+
+        if (degrees < MinDegrees) return UnjudgedSignature;
+
+        auto p = chiSquareTail(statistic, static_cast<double>(degrees));
+        return p >= EvenPValue ? 1.0 : 0.5 + 0.5 * p / EvenPValue;
+    }
+}
+
+PayloadScanner::PayloadScanner(SteganographerManager& steganographerManager)
+    : steganographerManager(steganographerManager) {}
+
+auto PayloadScanner::probe(const std::string& image) const -> std::optional<ScanResult> {
+    auto* steganographer = steganographerManager.getSteganographer(Utils::getImageFormat(image));
+    if (steganographer == nullptr) {
+        throw std::runtime_error("Unsupported image format.");
+    }
+
+    // A versioned header read through the image's layout settles it; legacy ones may also
+    // sit in the flat layout the first releases wrote, as decode finds them.
+    auto handle = steganographer->open(image);
+    const auto& layout = handle.getLayout();
+    auto result = probe(handle, layout);
+    if (result && (result->header.version > 0 || layout.geometry.isContiguous())) {
+        return result;
+    }
+    for (const auto& legacy : legacyLayouts(layout, handle.getFileSize())) {
+        auto legacyResult = probe(handle, legacy);
+        if (legacyResult && legacyResult->header.version == 0) return legacyResult;
+    }
+    return result;
+}
+
+auto PayloadScanner::probe(const ImageHandle& handle, const ImageLayout& layout) const -> std::optional<ScanResult> {
+    auto carrierBytes = layout.carrierBytes;
+    CarrierSource carrier(handle, layout, "", false);
+
+    std::vector<uint8_t> head(static_cast<size_t>(std::min<uint64_t>(
+        {carrierBytes, carrier.size(), Lsb::MaxHeaderCarrierBytes + SignatureCarrierBytes})));
+    carrier.read(0, head.data(), head.size());
+
+    auto header = Lsb::readHeader(head.data(), head.size());
+    if (!header || header->payloadBytes == 0) {
+        return std::nullopt;
+    }
+    if (header->compressed && header->payloadBytes < Compress::FrameHeaderBytes) {
+        return std::nullopt;
+    }
+
+    auto payloadOffset = Lsb::payloadCarrierOffset(*header);
+    auto payloadCarrierBytes = Lsb::carrierBytesFor(header->payloadBytes, header->density());
+    if (payloadOffset > carrierBytes || payloadCarrierBytes > carrierBytes - payloadOffset) {
+        return std::nullopt;
+    }
+
+    ScanResult result{handle.getPath(), *header};
+    result.headerTerm = header->version > 0 ? 1.0 : 1.0 - falseHeaderOdds(carrierBytes);
+    auto sampled = payloadOffset < head.size() ? head.size() - payloadOffset : 0;
+    result.signatureTerm = signatureTerm(head.data() + std::min<uint64_t>(payloadOffset, head.size()),
+        static_cast<size_t>(std::min<uint64_t>(payloadCarrierBytes, sampled)), header->bitsPerChannel);
+    result.confidence = result.headerTerm * result.signatureTerm;
+    return result;
+}
+
+auto PayloadScanner::scan(const std::vector<std::string>& paths) const -> ScanReport {
+    ScanReport report;
+    std::vector<Utils::PathFailure> unreadable;
+    auto images = Utils::collectImages(paths, unreadable);
+    for (auto& failure : unreadable) {
+        report.failures.push_back(failure.path + ": " + failure.reason);
+    }
+    report.scanned = images.size();
+
+    std::vector<std::optional<ScanResult>> results(images.size());
+    std::vector<std::string> errors(images.size());
+    auto* stats = Stats::active();
+    ThreadPool::shared().parallelFor(images.size(), 0, [&](const size_t i) {
+        Stats::Session session(stats);
+        try {
+            results[i] = probe(images[i]);
+        } catch (const std::exception& e) {
+            errors[i] = e.what();
+        }
+    });
+
+    for (size_t i = 0; i < images.size(); i++) {
+        if (results[i]) {
+            report.candidates.push_back(std::move(*results[i]));
+        } else if (!errors[i].empty()) {
+            report.failures.push_back(images[i] + ": " + errors[i]);
+        }
+    }
+
+    std::ranges::stable_sort(report.candidates, [](const ScanResult& a, const ScanResult& b) {
+        return a.confidence > b.confidence;
+    });
+    return report;
+}
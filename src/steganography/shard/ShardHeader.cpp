@@ -0,0 +1,84 @@
+#include "steganography/shard/ShardHeader.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace {
+  constexpr uint32_t Magic = 0x48535349u;  // "ISSH"
+  constexpr uint32_t CompressedFlag = 1;
+
+  auto storeLittleEndian(std::byte* p, const uint64_t value, const size_t bytes) -> void {
+    for (size_t i = 0; i < bytes; i++) p[i] = static_cast<std::byte>(value >> (8 * i));
+  }
+
+  auto loadLittleEndian(const std::byte* p, const size_t bytes) -> uint64_t {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) value |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return value;
+  }
+}
+
+namespace Shard {
+  auto writeHeader(const Header& header, std::span<std::byte, HeaderBytes> out) -> void {
+    auto* p = out.data();
+    storeLittleEndian(p, Magic, 4);
+    storeLittleEndian(p + 4, header.compressed ? CompressedFlag : 0, 4);
+    storeLittleEndian(p + 8, header.setId, 8);
+    storeLittleEndian(p + 16, header.index, 4);
+    storeLittleEndian(p + 20, header.count, 4);
+    storeLittleEndian(p + 24, header.offset, 8);
+    storeLittleEndian(p + 32, header.totalBytes, 8);
+  }
+
+  auto readHeader(std::span<const std::byte> bytes) -> std::optional<Header> {
+    if (bytes.size() < HeaderBytes) return std::nullopt;
+
+    const auto* p = bytes.data();
+    auto flags = loadLittleEndian(p + 4, 4);
+    if (loadLittleEndian(p, 4) != Magic || (flags & ~uint64_t{CompressedFlag}) != 0) {
+      return std::nullopt;
+    }
+
+    Header header;
+    header.compressed = (flags & CompressedFlag) != 0;
+    header.setId = loadLittleEndian(p + 8, 8);
+    header.index = static_cast<uint32_t>(loadLittleEndian(p + 16, 4));
+    header.count = static_cast<uint32_t>(loadLittleEndian(p + 20, 4));
+    header.offset = loadLittleEndian(p + 24, 8);
+    header.totalBytes = loadLittleEndian(p + 32, 8);
+
+    if (header.index >= header.count || header.offset > header.totalBytes ||
+        bytes.size() - HeaderBytes > header.totalBytes - header.offset) {
+      return std::nullopt;
+    }
+    return header;
+  }
+
+  auto planShards(std::span<const uint64_t> capacities, const uint64_t payloadBytes) -> std::vector<uint64_t> {
+    auto total = std::accumulate(capacities.begin(), capacities.end(), uint64_t{0});
+    if (total < payloadBytes) {
+      throw std::runtime_error("The images hold " + std::to_string(total) + " bytes together, too few for a " +
+          std::to_string(payloadBytes) + " byte payload.");
+    }
+
+    // Proportional shares, rounded down, then whatever rounding left over goes to the
+    // first carriers with room to spare. Doubles keep capacity * payload from overflowing.
+    std::vector<uint64_t> shards(capacities.size());
+    auto remaining = payloadBytes;
+    auto fraction = total == 0 ? 0.0 : static_cast<double>(payloadBytes) / static_cast<double>(total);
+    for (size_t i = 0; i < capacities.size(); i++) {
+      auto share = static_cast<uint64_t>(static_cast<double>(capacities[i]) * fraction);
+      shards[i] = std::min({share, capacities[i], remaining});
+      remaining -= shards[i];
+    }
+    for (size_t i = 0; i < capacities.size() && remaining > 0; i++) {
+      auto extra = std::min(capacities[i] - shards[i], remaining);
+      shards[i] += extra;
+      remaining -= extra;
+    }
+
+    return shards;
+  }
+}
@@ -0,0 +1,185 @@
+#include "steganography/shard/ShardSet.h"
+#include "steganography/compress/PayloadFrame.h"
+#include "steganography/concurrency/ThreadPool.h"
+#include "steganography/shard/ShardHeader.h"
+#include "steganography/stats/Stats.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <optional>
+#include <random>
+#include <set>
+#include <stdexcept>
+
+namespace {
+    auto randomSetId() -> uint64_t {
+        std::random_device device;
+        return (static_cast<uint64_t>(device()) << 32) | device();
+    }
+
+    // Runs body(i) for every image on the shared pool, one image per task, and reports a
+    // failure as a ShardError naming the image it happened on.
+    auto forEachImage(const std::vector<std::string>& images, const std::function<void(size_t)>& body) -> void {
+        auto* stats = Stats::active();
+        ThreadPool::shared().parallelFor(images.size(), 0, [&](const size_t i) {
+            Stats::Session session(stats);
+            try {
+                body(i);
+            } catch (const std::exception& e) {
+                throw ShardError(images[i] + ": " + e.what());
+            }
+        });
+    }
+
+    // Writing two shards into the same file would destroy the first.
+    auto requireDistinct(const std::vector<std::string>& images) -> void {
+        std::set<std::filesystem::path> seen;
+        for (const auto& image : images) {
+            std::error_code error;
+            auto path = std::filesystem::weakly_canonical(image, error);
+            if (!seen.insert(error ? std::filesystem::path(image) : path).second) {
+                throw ShardError("Image listed twice: " + image);
+            }
+        }
+    }
+}
+
+ShardSet::ShardSet(SteganographerManager& steganographerManager) : steganographerManager(steganographerManager) {}
+
+auto ShardSet::steganographerFor(const std::string& image) const -> ISteganographer& {
+    auto* steganographer = steganographerManager.getSteganographer(Utils::getImageFormat(image));
+    if (steganographer == nullptr) {
+        throw ShardError("Unsupported image format: " + image);
+    }
+    return *steganographer;
+}
+
+auto ShardSet::encode(const std::vector<std::string>& images, std::span<const std::byte> payload,
+    const std::string& key, const EncodeOptions& options) const -> uint64_t {
+    if (images.empty()) {
+        throw ShardError("No images to shard the payload across.");
+    }
+    requireDistinct(images);
+
+    std::vector<std::byte> frame;
+    if (options.compress) {
+        Stats::ScopedTimer timer(Stats::Phase::Compress);
+        frame = Compress::compressFrame(payload);
+        payload = frame;
+    }
+
+    // The shards are stored as plain payloads; compression, if any, already happened above.
+    auto shardOptions = options;
+    shardOptions.compress = false;
+
+    std::vector<std::optional<ImageHandle>> handles(images.size());
+    std::vector<uint64_t> capacities(images.size());
+    forEachImage(images, [&](const size_t i) {
+        auto& steganographer = steganographerFor(images[i]);
+        handles[i].emplace(steganographer.open(images[i], File::Mode::ReadWrite));
+
+        auto bytes = steganographer.capacity(*handles[i], shardOptions);
+        if (bytes < Shard::HeaderBytes) {
+            throw ShardError("Image is too small to hold a shard.");
+        }
+        capacities[i] = bytes - Shard::HeaderBytes;
+    });
+
+    auto sizes = Shard::planShards(capacities, payload.size());
+
+    Shard::Header header;
+    header.setId = randomSetId();
+    header.count = static_cast<uint32_t>(images.size());
+    header.totalBytes = payload.size();
+    header.compressed = options.compress;
+
+    std::vector<uint64_t> offsets(images.size());
+    for (size_t i = 1; i < images.size(); i++) {
+        offsets[i] = offsets[i - 1] + sizes[i - 1];
+    }
+
+    forEachImage(images, [&](const size_t i) {
+        auto shard = header;
+        shard.index = static_cast<uint32_t>(i);
+        shard.offset = offsets[i];
+
+        std::vector<std::byte> stored(Shard::HeaderBytes + sizes[i]);
+        Shard::writeHeader(shard, std::span(stored).first<Shard::HeaderBytes>());
+        std::copy_n(payload.begin() + static_cast<ptrdiff_t>(offsets[i]), sizes[i], stored.begin() + Shard::HeaderBytes);
+
+        if (!steganographerFor(images[i]).encode(*handles[i], stored, key, shardOptions)) {
+            throw std::runtime_error("Encoding failed unexpectedly.");
+        }
+    });
+
+    return payload.size();
+}
+
+auto ShardSet::decode(const std::vector<std::string>& images, const std::string& key, const PayloadSink& sink,
+    const DecodeOptions& options) const -> uint64_t {
+    if (images.empty()) {
+        throw ShardError("No images to join the payload from.");
+    }
+
+    std::vector<std::vector<std::byte>> shards(images.size());
+    std::vector<Shard::Header> headers(images.size());
+    forEachImage(images, [&](const size_t i) {
+        auto& steganographer = steganographerFor(images[i]);
+        auto image = steganographer.open(images[i]);
+
+        shards[i].resize(steganographer.decodedSize(image, key, options));
+        steganographer.decode(image, key, shards[i], options);
+
+        auto header = Shard::readHeader(shards[i]);
+        if (!header) {
+            throw ShardError("No shard found; wrong key or not part of a shard set.");
+        }
+        headers[i] = *header;
+    });
+
+    // Order the images by shard index and check they tile the payload exactly once.
+    const auto& first = headers.front();
+    std::vector<size_t> order(images.size(), images.size());
+    for (size_t i = 0; i < images.size(); i++) {
+        const auto& header = headers[i];
+        if (header.setId != first.setId || header.count != first.count || header.totalBytes != first.totalBytes ||
+            header.compressed != first.compressed) {
+            throw ShardError(images[i] + " belongs to a different shard set than " + images.front() + ".");
+        }
+        if (header.count != images.size()) {
+            throw ShardError("The shard set has " + std::to_string(header.count) + " images, " +
+                std::to_string(images.size()) + " given.");
+        }
+        if (order[header.index] != images.size()) {
+            throw ShardError(images[i] + " holds the same shard as " + images[order[header.index]] + ".");
+        }
+        order[header.index] = i;
+    }
+
+    uint64_t joined = 0;
+    for (auto i : order) {
+        if (headers[i].offset != joined) {
+            throw ShardError("Shard offsets do not line up; the shard set is corrupted.");
+        }
+        joined += shards[i].size() - Shard::HeaderBytes;
+    }
+    if (joined != first.totalBytes) {
+        throw ShardError("Shard sizes do not add up; the shard set is corrupted.");
+    }
+
+    auto piece = [&](const size_t i) { return std::span<const std::byte>(shards[i]).subspan(Shard::HeaderBytes); };
+    if (!first.compressed) {
+        for (auto i : order) sink(piece(i));
+        return joined;
+    }
+
+    Compress::FrameDecoder decoder;
+    uint64_t size = 0;
+    auto emit = [&](std::span<const std::byte> bytes) {
+        size += bytes.size();
+        sink(bytes);
+    };
+    for (auto i : order) decoder.feed(piece(i), emit);
+    decoder.finish();
+    return size;
+}
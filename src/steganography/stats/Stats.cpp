@@ -0,0 +1,203 @@
+#include "steganography/stats/Stats.h"
+
+#include <cstdlib>
+#include <fmt/core.h>
+#include <new>
+
+namespace {
+  auto milliseconds(const uint64_t nanoseconds) -> double {
+    return static_cast<double>(nanoseconds) / 1e6;
+  }
+
+  // Allocations are only counted in builds with IMAGESTEG_COUNT_ALLOCATIONS, so elsewhere
+  // the counter is left out rather than reported as zero.
+  auto isReported(const Stats::Counter counter) -> bool {
+#ifdef IMAGESTEG_COUNT_ALLOCATIONS
+    return true;
+#else
+    return counter != Stats::Counter::Allocations;
+#endif
+  }
+}
+
+namespace Stats {
+  auto getPhaseName(const Phase phase) -> std::string {
+    switch (phase) {
+    case Phase::Open: return "open";
+    case Phase::ParseHeader: return "parse_header";
+    case Phase::Read: return "read";
+    case Phase::Map: return "map";
+    case Phase::Embed: return "embed";
+    case Phase::Extract: return "extract";
+    case Phase::Xor: return "xor";
+    case Phase::Compress: return "compress";
+    case Phase::ErrorCorrection: return "error_correction";
+    case Phase::Checksum: return "checksum";
+    case Phase::Decompress: return "decompress";
+    case Phase::Write: return "write";
+    case Phase::Flush: return "flush";
+    }
+    return "unknown";
+  }
+
+  auto getCounterName(const Counter counter) -> std::string {
+    switch (counter) {
+    case Counter::BytesRead: return "bytes_read";
+    case Counter::BytesWritten: return "bytes_written";
+    case Counter::CarrierBytes: return "carrier_bytes";
+    case Counter::Allocations: return "allocations";
+    case Counter::BufferReuses: return "buffer_reuses";
+    case Counter::CorrectedBytes: return "corrected_bytes";
+    }
+    return "unknown";
+  }
+
+  auto Collector::addTime(const Phase phase, const uint64_t elapsed) -> void {
+    nanoseconds[static_cast<size_t>(phase)].fetch_add(elapsed, std::memory_order_relaxed);
+    calls[static_cast<size_t>(phase)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  auto Collector::add(const Counter counter, const uint64_t amount) -> void {
+    counters[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  auto Collector::getNanoseconds(const Phase phase) const -> uint64_t {
+    return nanoseconds[static_cast<size_t>(phase)].load(std::memory_order_relaxed);
+  }
+
+  auto Collector::getCalls(const Phase phase) const -> uint64_t {
+    return calls[static_cast<size_t>(phase)].load(std::memory_order_relaxed);
+  }
+
+  auto Collector::getCount(const Counter counter) const -> uint64_t {
+    return counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+  }
+
+  auto formatSummary(const Collector& collector) -> std::string {
+    std::string summary = "Stats:";
+
+    for (size_t i = 0; i < PhaseCount; i++) {
+      auto phase = static_cast<Phase>(i);
+      if (collector.getCalls(phase) == 0) continue;
+
+      summary += fmt::format("\n  {:<16} {:>10.3f} ms  {:>6} calls", getPhaseName(phase),
+          milliseconds(collector.getNanoseconds(phase)), collector.getCalls(phase));
+    }
+    for (size_t i = 0; i < CounterCount; i++) {
+      auto counter = static_cast<Counter>(i);
+      if (!isReported(counter)) continue;
+
+      summary += fmt::format("\n  {:<16} {:>10}", getCounterName(counter), collector.getCount(counter));
+    }
+
+    return summary;
+  }
+
+  auto toJson(const Collector& collector) -> std::string {
+    std::string phases;
+    for (size_t i = 0; i < PhaseCount; i++) {
+      auto phase = static_cast<Phase>(i);
+      if (collector.getCalls(phase) == 0) continue;
+
+      phases += fmt::format("{}\"{}\":{{\"ms\":{:.3f},\"calls\":{}}}", phases.empty() ? "" : ",",
+          getPhaseName(phase), milliseconds(collector.getNanoseconds(phase)), collector.getCalls(phase));
+    }
+
+    std::string counters;
+    for (size_t i = 0; i < CounterCount; i++) {
+      auto counter = static_cast<Counter>(i);
+      if (!isReported(counter)) continue;
+
+      counters += fmt::format("{}\"{}\":{}", counters.empty() ? "" : ",", getCounterName(counter), collector.getCount(counter));
+    }
+
+    return fmt::format("{{\"phases\":{{{}}},\"counters\":{{{}}}}}", phases, counters);
+  }
+}
+
+#ifdef IMAGESTEG_COUNT_ALLOCATIONS
+// Counts heap allocations made while a session is active, in every form of operator new
+// other than the nothrow ones, which the standard library forwards to these. Replacing
+// them is program-wide, which is why it is a build option.
+namespace {
+  template <typename Allocate>
+  auto allocateOrThrow(const Allocate& allocate) -> void* {
+    Stats::add(Stats::Counter::Allocations, 1);
+
+    while (true) {
+      if (auto* memory = allocate()) return memory;
+
+      auto handler = std::get_new_handler();
+      if (handler == nullptr) throw std::bad_alloc();
+      handler();
+    }
+  }
+
+  auto allocateAligned(const std::size_t size, const std::align_val_t alignment) -> void* {
+    const auto align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    return allocateOrThrow([&] { return _aligned_malloc(size == 0 ? 1 : size, align); });
+#else
+    // aligned_alloc wants a size that is a multiple of the alignment.
+    const auto rounded = size == 0 ? align : (size + align - 1) / align * align;
+    return allocateOrThrow([&] { return std::aligned_alloc(align, rounded); });
+#endif
+  }
+
+  auto freeAligned(void* memory) noexcept -> void {
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+  }
+}
+
+auto operator new(const std::size_t size) -> void* {
+  return allocateOrThrow([&] { return std::malloc(size == 0 ? 1 : size); });
+}
+
+auto operator new[](const std::size_t size) -> void* {
+  return allocateOrThrow([&] { return std::malloc(size == 0 ? 1 : size); });
+}
+
+auto operator new(const std::size_t size, const std::align_val_t alignment) -> void* {
+  return allocateAligned(size, alignment);
+}
+
+auto operator new[](const std::size_t size, const std::align_val_t alignment) -> void* {
+  return allocateAligned(size, alignment);
+}
+
+auto operator delete(void* memory) noexcept -> void {
+  std::free(memory);
+}
+
+auto operator delete(void* memory, std::size_t) noexcept -> void {
+  std::free(memory);
+}
+
+auto operator delete[](void* memory) noexcept -> void {
+  std::free(memory);
+}
+
+auto operator delete[](void* memory, std::size_t) noexcept -> void {
+  std::free(memory);
+}
+
+auto operator delete(void* memory, std::align_val_t) noexcept -> void {
+  freeAligned(memory);
+}
+
+auto operator delete(void* memory, std::size_t, std::align_val_t) noexcept -> void {
+  freeAligned(memory);
+}
+
+auto operator delete[](void* memory, std::align_val_t) noexcept -> void {
+  freeAligned(memory);
+}
+
+auto operator delete[](void* memory, std::size_t, std::align_val_t) noexcept -> void {
+  freeAligned(memory);
+}
+#endif